@@ -1,9 +1,29 @@
 #include "AddOnManager.hpp"
 #include <iostream>
 #include <algorithm>
+#include <new>
 
 namespace fs = std::filesystem;
 
+namespace {
+    // Times one lifecycle call when profiling is enabled
+    class ProfileScope {
+        public:
+            ProfileScope(AddOnProfiler *p, std::size_t addon, AddOnProfiler::Phase phase)
+                : p_(p), addon_(addon), phase_(phase), t0_(p ? p->Begin(addon, phase) : 0) {}
+            ~ProfileScope() {
+                if (p_)
+                    p_->End(addon_, phase_, t0_);
+            }
+
+        private:
+            AddOnProfiler       *p_;
+            std::size_t          addon_;
+            AddOnProfiler::Phase phase_;
+            std::uint64_t        t0_;
+    };
+} // namespace
+
 AddOnManager::~AddOnManager() {
     unloadAll();
 }
@@ -76,6 +96,12 @@ bool AddOnManager::scanAndLoad() {
 bool AddOnManager::loadOne(const fs::path &libPath) {
     AddOn a;
     a.path = libPath;
+    a.name = libPath.stem().string();
+#ifndef _WIN32
+    // libMyAddon.so -> MyAddon, so port keys match on every platform
+    if (a.name.rfind("lib", 0) == 0 && a.name.size() > 3)
+        a.name.erase(0, 3);
+#endif
 
     if (!a.lib.open(libPath)) {
         std::cerr << "[AddOnManager] Failed to load " << libPath
@@ -102,55 +128,383 @@ bool AddOnManager::loadOne(const fs::path &libPath) {
     return true;
 }
 
+bool AddOnManager::loadInstance(const fs::path &libPath, const std::string &name,
+    const char *factory, const void *config) {
+    AddOn a;
+    a.path = libPath;
+    a.name = name;
+
+    if (!a.lib.open(libPath)) {
+        std::cerr << "[AddOnManager] Failed to load " << libPath
+                  << " : " << a.lib.lastError() << "\n";
+        return false;
+    }
+
+    auto create = a.lib.getSymbol<AddOn::CreateWithConfigFn>(factory);
+    a.destroyFn = a.lib.getSymbol<AddOn::DestroyFn>("DestroyPlugin");
+
+    if (!create || !a.destroyFn) {
+        std::cerr << "[AddOnManager] Missing " << factory << "/DestroyPlugin in " << libPath << "\n";
+        return false;
+    }
+
+    a.plugin = create(config);
+    if (!a.plugin) {
+        std::cerr << "[AddOnManager] " << factory << " failed for " << name << "\n";
+        return false;
+    }
+
+    addons_.push_back(std::move(a));
+    return true;
+}
+
 void AddOnManager::discoverPortsForAll(IHostPortServices &svc) {
     for (auto &a : addons_) {
-        const auto addonName = a.path.stem().string(); // "MyAddon2"
+        const auto &addonName = a.name; // "MyAddon2"
         std::cout << "[AddOnManager] Ports for " << addonName << "\n";
 
-        svc.BeginAddon(addonName);
+        discoverPorts(a, svc);
+    }
+}
+
+void AddOnManager::discoverPorts(const AddOn &a, IHostPortServices &svc) {
+    svc.BeginAddon(a.name);
 
-        auto ports = a.plugin->getPortDescriptors();
-        for (const auto &pd : ports) {
+    const PluginAPI::PortTable table = a.plugin->getPortTable();
+    if (table.size) {
+        for (const auto &pd : table)
             svc.CreatePort(pd);
-        }
+        return;
+    }
+
+    auto ports = a.plugin->getPortDescriptors();
+    for (const auto &pd : ports) {
+        svc.CreatePort(pd);
     }
 }
 
 void AddOnManager::runAll(PluginAPI::IHostServices &services) {
+    initializeAll(services);
+
+    std::cout << "[AddOnManager] Run all\n";
+
+    // Simple demo loop: run 10 cycles
+    for (int i = 0; i < 10; ++i) {
+        runCycle();
+    }
+
+    shutdownAll();
+}
+
+void AddOnManager::initializeAll(PluginAPI::IHostServices &services) {
     // Try to get the PortManager interface that has BeginAddon()
-    auto *pm = dynamic_cast<IHostPortServices *>(&services);
+    portSvc_ = dynamic_cast<IHostPortServices *>(&services);
+
+    // Initialize all addons and bind ports; isolated ones do that in their
+    // runner, forked from a zygote that keeps an untouched copy
+    for (std::size_t i = 0; i < addons_.size(); ++i) {
+        if (addons_[i].runner < 0)
+            initializeAddon(i, services);
+    }
+
+    if (runners_ && !runners_->started())
+        startRunners(services);
+}
+
+bool AddOnManager::startRunners(PluginAPI::IHostServices &services) {
+    if (!runners_)
+        return true;
+    portSvc_ = dynamic_cast<IHostPortServices *>(&services);
+    if (runners_->Start(services, portSvc_))
+        return true;
 
-    // Initialize all addons and bind ports
+    std::cerr << "[AddOnManager] Isolated runners failed to start; their addons are disabled\n";
     for (auto &a : addons_) {
-        const std::string addonName = a.path.stem().string(); // "MyAddonProducer", etc.
+        if (a.runner >= 0)
+            a.enabled = false;
+    }
+    return false;
+}
+
+void AddOnManager::initializeAddon(std::size_t i, PluginAPI::IHostServices &services) {
+    auto &a = addons_[i];
+    std::cout << "[AddOnManager] Initialize " << a.name << "\n";
+
+    // Budgets may have changed since a previous initialize
+    const auto        budget = addonBudgets_.find(a.name);
+    const std::size_t cap    = budget != addonBudgets_.end() ? budget->second : memoryBudget_;
+    if (!a.memory)
+        a.memory = std::make_unique<AddonMemory>(cap);
+    else
+        a.memory->setBudget(cap);
+
+    if (portSvc_) {
+        portSvc_->BeginAddon(a.name); // important: sets currentAddon_ for OpenPort()
+        portSvc_->UseAddonMemory(a.memory.get());
+    }
+
+    try {
+        ProfileScope scope(profiler_.get(), i, AddOnProfiler::Phase::Initialize);
+        a.plugin->initialize(&services); // InPort.Bind/OutPort.Bind happens here
+    } catch (const std::bad_alloc &) {
+        OverBudget(a);
+        return;
+    }
+
+    // Host-side join: runAddon() calls runJoined() instead of run()
+    a.join.reset();
+    const PluginAPI::JoinSpec spec = a.plugin->getJoinSpec();
+    if (spec.count && portSvc_) {
+        auto join = std::make_unique<JoinStage>();
+        if (join->Resolve(a.name, spec, *portSvc_))
+            a.join = std::move(join);
+    }
+}
 
-        std::cout << "[AddOnManager] Initialize " << addonName << "\n";
+void AddOnManager::runCycle() {
+    for (std::size_t i = 0; i < addons_.size(); ++i) {
+        if (!addons_[i].enabled)
+            continue;
+        if (addons_[i].runner >= 0)
+            RunIsolated(i);
+        else
+            runAddon(i);
+    }
+    if (portSvc_)
+        portSvc_->EndCycle();
+}
 
-        if (pm) {
-            pm->BeginAddon(addonName); // important: sets currentAddon_ for OpenPort()
+void AddOnManager::warmUp(std::size_t cycles) {
+    if (!cycles)
+        return;
+    auto prof = std::move(profiler_);
+    if (portSvc_)
+        portSvc_->BeginWarmUp();
+    for (std::size_t c = 0; c < cycles; ++c)
+        runCycle();
+    if (portSvc_)
+        portSvc_->EndWarmUp();
+    profiler_ = std::move(prof);
+}
+
+// One dispatch for the run of consecutive addons that share a runner;
+// advances `i` to the last of them. A runner the pool gave up on takes its
+// addons with it: they are disabled like an addon over its budget.
+void AddOnManager::RunIsolated(std::size_t &i) {
+    const int         runner = addons_[i].runner;
+    const std::size_t first  = i;
+    std::size_t       last   = i + 1;
+    while (last < addons_.size() && addons_[last].runner == runner)
+        ++last;
+    i = last - 1;
+
+    if (runners_->Run(static_cast<std::size_t>(runner), first, last) ||
+        runners_->alive(static_cast<std::size_t>(runner)))
+        return;
+    std::cerr << "[AddOnManager] Runner " << runner << " is gone; disabled";
+    for (auto &a : addons_) {
+        if (a.runner == runner && a.enabled) {
+            a.enabled = false;
+            std::cerr << " " << a.name;
         }
+    }
+    std::cerr << "\n";
+}
 
-        a.plugin->initialize(&services); // InPort.Bind/OutPort.Bind happens here
+void AddOnManager::runAddon(std::size_t i) {
+    auto &a = addons_[i];
+    if (a.join && !a.join->Match(*portSvc_))
+        return; // inputs not aligned yet
+    if (auto *prof = profiler_.get()) {
+        const auto t0 = prof->Begin(i, AddOnProfiler::Phase::Run);
+        Run(a);
+        prof->End(i, AddOnProfiler::Phase::Run, t0);
+    } else {
+        Run(a);
     }
+}
 
-    std::cout << "[AddOnManager] Run all\n";
+bool AddOnManager::runAddonBatch(std::size_t i, std::size_t frames) {
+    auto &a = addons_[i];
+    if (a.noBatch || a.join)
+        return false;
+    bool ok = true;
+    try {
+        if (auto *prof = profiler_.get()) {
+            const auto t0 = prof->Begin(i, AddOnProfiler::Phase::Run);
+            ok            = a.plugin->runBatch(frames);
+            prof->End(i, AddOnProfiler::Phase::Run, t0);
+        } else {
+            ok = a.plugin->runBatch(frames);
+        }
+    } catch (const std::bad_alloc &) {
+        OverBudget(a);
+    }
+    a.noBatch = !ok; // asked once
+    return ok;
+}
 
-    // Simple demo loop: run 10 cycles
-    for (int i = 0; i < 10; ++i) {
-        for (auto &a : addons_) {
+void AddOnManager::Run(AddOn &a) {
+    try {
+        if (a.join)
+            a.plugin->runJoined(a.join->views(), a.join->size());
+        else
             a.plugin->run();
+    } catch (const std::bad_alloc &) {
+        OverBudget(a);
+    }
+}
+
+// An addon that let std::bad_alloc escape (normally its memory budget) is
+// not run again; its shutdown() still happens
+void AddOnManager::OverBudget(AddOn &a) {
+    a.enabled = false;
+    std::cerr << "[AddOnManager] " << a.name << " ran out of memory";
+    if (a.memory) {
+        const auto m = a.memory->stats();
+        if (m.budget)
+            std::cerr << " (budget " << m.budget << " B, " << m.live << " B live)";
+    }
+    std::cerr << "; disabled\n";
+}
+
+void AddOnManager::shutdownAll() {
+    if (runners_) {
+        runners_->Stop(); // the runners shut their own addons down
+        runners_->PrintSummary(std::cout);
+    }
+    for (std::size_t i = 0; i < addons_.size(); ++i) {
+        if (addons_[i].runner < 0)
+            shutdownAddon(i);
+    }
+    portSvc_ = nullptr;
+}
+
+void AddOnManager::shutdownAddon(std::size_t i) {
+    auto &a = addons_[i];
+    std::cout << "[AddOnManager] Shutdown " << a.name << "\n";
+    if (a.join) {
+        std::cout << "[AddOnManager]   join " << PluginAPI::to_string(a.join->policy())
+                  << ": " << a.join->matched() << " matched, "
+                  << a.join->waited() << " cycles waiting\n";
+        a.join.reset();
+    }
+
+    {
+        ProfileScope scope(profiler_.get(), i, AddOnProfiler::Phase::Shutdown);
+        a.plugin->shutdown();
+    }
+
+    if (a.memory) {
+        const auto m = a.memory->stats();
+        if (m.allocations || m.rejected) {
+            std::cout << "[AddOnManager]   memory: " << m.live << " B live, " << m.peak << " B peak, "
+                      << m.allocations << " allocations";
+            if (m.budget)
+                std::cout << ", budget " << m.budget << " B, " << m.rejected << " rejected";
+            std::cout << "\n";
+        }
+    }
+}
+
+bool AddOnManager::isolate(const std::vector<std::vector<std::string>> &groups,
+    std::chrono::milliseconds timeout) {
+    std::vector<RunnerPool::Group> resolved;
+    auto                           add = [&](std::vector<std::size_t> members) {
+        const int runner = static_cast<int>(resolved.size());
+        for (std::size_t i : members)
+            addons_[i].runner = runner;
+        resolved.push_back(RunnerPool::Group{std::move(members), {}});
+    };
+
+    for (auto &a : addons_)
+        a.runner = -1;
+
+    for (const auto &names : groups) {
+        if (names.size() == 1 && (names[0] == "each" || names[0] == "all")) {
+            if (groups.size() != 1) {
+                std::cerr << "[AddOnManager] '" << names[0] << "' cannot be combined with other isolation groups\n";
+                return false;
+            }
+            if (names[0] == "each") {
+                // A fused unit stays together: one dispatch for the chain
+                for (std::size_t i = 0; i < addons_.size();) {
+                    std::vector<std::size_t> unit{i++};
+                    while (i < addons_.size() && addons_[i].unit >= 0 && addons_[i].unit == addons_[unit[0]].unit)
+                        unit.push_back(i++);
+                    add(std::move(unit));
+                }
+            } else {
+                std::vector<std::size_t> all(addons_.size());
+                for (std::size_t i = 0; i < all.size(); ++i)
+                    all[i] = i;
+                add(std::move(all));
+            }
+            continue;
+        }
+
+        std::vector<std::size_t> members;
+        for (const auto &name : names) {
+            AddOn *a = find(name);
+            if (!a) {
+                std::cerr << "[AddOnManager] Cannot isolate unknown addon '" << name << "'\n";
+                return false;
+            }
+            if (a->runner >= 0) {
+                std::cerr << "[AddOnManager] Addon '" << name << "' is in two isolation groups\n";
+                return false;
+            }
+            members.push_back(static_cast<std::size_t>(a - addons_.data()));
         }
+        std::sort(members.begin(), members.end());
+        add(std::move(members));
     }
 
-    // Shutdown
+    runners_ = std::make_unique<RunnerPool>(*this, std::move(resolved), timeout);
+    return true;
+}
+
+AddOnManager::AddOn *AddOnManager::find(const std::string &name) {
     for (auto &a : addons_) {
-        const std::string addonName = a.path.stem().string();
-        std::cout << "[AddOnManager] Shutdown " << addonName << "\n";
-        a.plugin->shutdown();
+        if (a.name == name)
+            return &a;
+    }
+    return nullptr;
+}
+
+void AddOnManager::reorder(const std::vector<std::size_t> &order) {
+    if (order.size() != addons_.size()) {
+        std::cerr << "[AddOnManager] reorder: expected " << addons_.size() << " indices\n";
+        return;
     }
+    std::vector<AddOn> sorted;
+    sorted.reserve(addons_.size());
+    for (std::size_t i : order)
+        sorted.push_back(std::move(addons_[i]));
+    addons_ = std::move(sorted);
+}
+
+void AddOnManager::setMemoryBudget(const std::string &name, std::size_t bytes) {
+    if (name.empty())
+        memoryBudget_ = bytes;
+    else
+        addonBudgets_[name] = bytes;
+}
+
+void AddOnManager::enableProfiling(bool trace) {
+    std::vector<std::string> names;
+    names.reserve(addons_.size());
+    for (const auto &a : addons_)
+        names.push_back(a.name);
+    profiler_ = std::make_unique<AddOnProfiler>(std::move(names), trace);
+}
+
+void AddOnManager::disableProfiling() {
+    profiler_.reset();
 }
 
 void AddOnManager::unloadAll() {
+    runners_.reset();
     for (auto &a : addons_) {
         if (a.plugin && a.destroyFn) {
             a.destroyFn(a.plugin);
@@ -1,20 +1,34 @@
 #pragma once
+#include <chrono>
 #include <filesystem>
+#include <map>
 #include <vector>
 #include <string>
 #include <memory>
 #include "../include/PluginAPI.hpp"
 #include "SharedLibrary.hpp"
+#include "AddOnProfiler.hpp"
+#include "AddonMemory.hpp"
+#include "JoinStage.hpp"
+#include "RunnerPool.hpp"
 
 class AddOnManager {
     public:
         struct AddOn {
-                std::filesystem::path path;
-                SharedLibrary         lib;
-                PluginAPI::IPlugin   *plugin = nullptr;
-
-                using CreateFn  = PluginAPI::IPlugin *(*)();
-                using DestroyFn = void (*)(PluginAPI::IPlugin *);
+                std::filesystem::path        path;
+                std::string                  name; // port-key name ("MyAddon2")
+                SharedLibrary                lib;
+                PluginAPI::IPlugin          *plugin  = nullptr;
+                bool                         enabled = true;  // disabled addons are skipped by runCycle()
+                std::unique_ptr<JoinStage>   join;            // set by initializeAll() for joined addons
+                int                          runner = -1;     // RunnerPool index, -1 = runs in the host
+                std::unique_ptr<AddonMemory> memory;          // IHostServices::Memory(), from initializeAddon()
+                int                          unit = -1;       // fused chain (GraphOptimizer), -1 = none
+                bool                         noBatch = false; // runBatch() returned false once
+
+                using CreateFn           = PluginAPI::IPlugin *(*)();
+                using CreateWithConfigFn = PluginAPI::IPlugin *(*)(const void *);
+                using DestroyFn          = void (*)(PluginAPI::IPlugin *);
 
                 CreateFn  createFn  = nullptr;
                 DestroyFn destroyFn = nullptr;
@@ -30,6 +44,12 @@ class AddOnManager {
         // Discovery + load
         bool scanAndLoad();
 
+        // Load one more instance of `libPath` under `name`, created through
+        // the exported `factory(config)` instead of CreatePlugin(); used to
+        // instantiate configurable addons many times (LoadGenerator).
+        bool loadInstance(const std::filesystem::path &libPath, const std::string &name,
+            const char *factory, const void *config);
+
         // Access loaded addons
         const std::vector<AddOn> &addons() const {
             return addons_;
@@ -40,8 +60,69 @@ class AddOnManager {
 
         // Lifecycle helpers
         void discoverPortsForAll(class IHostPortServices &svc);
+        // Ports of one addon: its static PortTable if it has one, else getPortDescriptors()
+        static void discoverPorts(const AddOn &a, class IHostPortServices &svc);
         void runAll(PluginAPI::IHostServices &services);
 
+        // Split lifecycle, for hosts that drive the cycles themselves
+        void initializeAll(PluginAPI::IHostServices &services);
+        void runCycle();
+        void shutdownAll();
+
+        // `cycles` dry runCycle()s after initializeAll(), so first-use costs
+        // (lazy allocations, cold caches, first-touch page faults) are paid
+        // before the pipeline goes live. Not profiled; the port services
+        // set their recorder and metrics aside meanwhile.
+        void warmUp(std::size_t cycles);
+
+        // One addon at a time (used by the cycle helpers above and by the
+        // isolated runners); runAddon() honours the addon's join
+        void initializeAddon(std::size_t i, PluginAPI::IHostServices &services);
+        void runAddon(std::size_t i);
+        // Offline batch mode (PortReplayer): one runBatch() for `frames`
+        // cycles. False if the addon has no batch mode (or a join); the
+        // caller then steps it through run() frame by frame.
+        bool runAddonBatch(std::size_t i, std::size_t frames);
+        void shutdownAddon(std::size_t i);
+
+        // Process isolation (Linux): every group of addon names runs in its
+        // own forked runner (see RunnerPool). Call after loading, before
+        // initializeAll(); the PortManager must use shared transports.
+        // "each" / "all" as the only name: one runner per addon / for all.
+        bool isolate(const std::vector<std::vector<std::string>> &groups,
+            std::chrono::milliseconds timeout = std::chrono::milliseconds(1000));
+        // Fork the runners (RunnerPool::Start) while the host is still
+        // single-threaded, i.e. before a logger or metrics thread starts;
+        // initializeAll() does it otherwise. False: their addons are disabled.
+        bool startRunners(PluginAPI::IHostServices &services);
+
+        const RunnerPool *runners() const {
+            return runners_.get();
+        }
+        RunnerPool *runners() {
+            return runners_.get();
+        }
+
+        AddOn *find(const std::string &name);
+
+        // New execution order (GraphOptimizer): `order` lists every addon
+        // index once. Call before initializeAll(), isolate() and
+        // enableProfiling(), which all work on indices.
+        void reorder(const std::vector<std::size_t> &order);
+
+        // Hard cap on the live bytes an addon allocates through
+        // IHostServices::Memory(); empty name = default for every addon.
+        // 0 = unlimited. Takes effect for addons initialized afterwards.
+        void setMemoryBudget(const std::string &name, std::size_t bytes);
+
+        // Time every initialize/run/shutdown of the addons loaded now;
+        // `trace` additionally records begin/end events for ExportChromeTrace().
+        void                 enableProfiling(bool trace = false);
+        void                 disableProfiling();
+        const AddOnProfiler *profiler() const {
+            return profiler_.get();
+        }
+
         void unloadAll();
 
     private:
@@ -49,9 +130,17 @@ class AddOnManager {
         static std::vector<std::filesystem::path> collectCandidates(const std::filesystem::path &dir);
 
         bool loadOne(const std::filesystem::path &libPath);
+        void Run(AddOn &a); // run() or runJoined()
+        void RunIsolated(std::size_t &i);
+        void OverBudget(AddOn &a);
 
         std::vector<std::filesystem::path> searchDirs_;
         std::vector<AddOn>                 addons_;
+        class IHostPortServices           *portSvc_ = nullptr; // set by initializeAll()
+        std::unique_ptr<AddOnProfiler>     profiler_;
+        std::unique_ptr<RunnerPool>        runners_;
+        std::size_t                        memoryBudget_ = 0; // setMemoryBudget("")
+        std::map<std::string, std::size_t> addonBudgets_;
 };
 
 // Small interface so AddOnManager doesn’t depend on your concrete services type
@@ -65,4 +154,30 @@ class IHostPortServices {
         virtual void BeginAddon(const std::string & /*addonName*/) {}
 
         virtual void CreatePort(const PluginAPI::PortDescriptor &desc) = 0;
+
+        // optional: resource IHostServices::Memory() returns until the next
+        // BeginAddon() (AddOnManager passes the addon's AddonMemory)
+        virtual void UseAddonMemory(std::pmr::memory_resource * /*mr*/) {}
+
+        // optional: called after every addon ran once
+        virtual void EndCycle() {}
+
+        // optional: host-side joins (see JoinStage). ResolveInput() returns an
+        // opaque handle for one input port of `addon` (null if unknown),
+        // PeekInput() views its current value without copying and
+        // ConsumeInput() counts it as read.
+        virtual void *ResolveInput(const std::string & /*addon*/, const std::string & /*port*/) {
+            return nullptr;
+        }
+        virtual bool PeekInput(void * /*input*/, PluginAPI::JoinView & /*out*/) {
+            return false;
+        }
+        virtual void ConsumeInput(void * /*input*/) {}
+
+        // optional: called in a freshly forked runner process (RunnerPool)
+        virtual void DetachForRunner() {}
+
+        // optional: bracket AddOnManager::warmUp()
+        virtual void BeginWarmUp() {}
+        virtual void EndWarmUp() {}
 };
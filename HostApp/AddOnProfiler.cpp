@@ -0,0 +1,142 @@
+#include "AddOnProfiler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+std::uint64_t LatencyHistogram::Percentile(double p) const {
+    if (count_ == 0)
+        return 0;
+    // nearest-rank: smallest value with at least p of the samples at or below it
+    auto rank = static_cast<std::uint64_t>(std::ceil(p * static_cast<double>(count_)));
+    rank      = rank ? rank - 1 : 0;
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < counts_.size(); ++i) {
+        seen += counts_[i];
+        if (seen > rank)
+            return std::min(UpperBound(i), max_);
+    }
+    return max_;
+}
+
+namespace {
+    std::atomic<std::uint64_t> g_profilerGeneration{0};
+
+    const char *PhaseName(AddOnProfiler::Phase p) {
+        switch (p) {
+        case AddOnProfiler::Phase::Initialize: return "initialize";
+        case AddOnProfiler::Phase::Run: return "run";
+        case AddOnProfiler::Phase::Shutdown: return "shutdown";
+        default: return "unknown";
+        }
+    }
+} // namespace
+
+AddOnProfiler::AddOnProfiler(std::vector<std::string> addonNames, bool trace,
+    std::size_t traceEventsPerThread)
+    : names_(std::move(addonNames)),
+      stats_(names_.size()),
+      trace_(trace),
+      perThread_(traceEventsPerThread),
+      generation_(++g_profilerGeneration) {}
+
+AddOnProfiler::~AddOnProfiler() = default;
+
+// Each thread lazily registers its own buffer; after that, emitting is a
+// plain store plus a release increment, with no shared writes.
+AddOnProfiler::ThreadBuffer *AddOnProfiler::LocalBuffer() {
+    struct Cache {
+            std::uint64_t generation = 0;
+            ThreadBuffer *buffer     = nullptr;
+    };
+    thread_local Cache cache;
+    if (cache.generation == generation_)
+        return cache.buffer;
+
+    auto buf      = std::make_unique<ThreadBuffer>();
+    buf->events   = std::make_unique<TraceEvent[]>(perThread_);
+    buf->capacity = perThread_;
+
+    std::lock_guard lock(buffersMutex_);
+    buf->tid = static_cast<std::uint32_t>(buffers_.size() + 1);
+    buffers_.push_back(std::move(buf));
+    cache = Cache{generation_, buffers_.back().get()};
+    return cache.buffer;
+}
+
+void AddOnProfiler::Emit(std::size_t addon, Phase phase, bool begin, std::uint64_t ts) {
+    ThreadBuffer     *b = LocalBuffer();
+    const std::size_t n = b->count.load(std::memory_order_relaxed);
+    if (n >= b->capacity) {
+        b->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    b->events[n] = TraceEvent{ts, static_cast<std::uint32_t>(addon), phase, begin};
+    b->count.store(n + 1, std::memory_order_release);
+}
+
+void AddOnProfiler::PrintSummary(std::ostream &os) const {
+    os << "\n[AddOnProfiler] Per-addon timings (ns):\n";
+    for (std::size_t a = 0; a < names_.size(); ++a) {
+        for (std::size_t p = 0; p < kPhases; ++p) {
+            const auto &h = stats_[a][p];
+            if (h.Count() == 0)
+                continue;
+            os << "  " << std::left << std::setw(20) << names_[a]
+               << std::setw(11) << PhaseName(static_cast<Phase>(p)) << std::right
+               << " n=" << h.Count()
+               << " min=" << h.Min()
+               << " mean=" << static_cast<std::uint64_t>(h.Mean())
+               << " p50=" << h.Percentile(0.50)
+               << " p99=" << h.Percentile(0.99)
+               << " p99.9=" << h.Percentile(0.999)
+               << " max=" << h.Max() << "\n";
+        }
+    }
+}
+
+bool AddOnProfiler::ExportChromeTrace(const std::string &filename) const {
+    std::ofstream out(filename, std::ios::out | std::ios::trunc);
+    if (!out) {
+        std::cerr << "[AddOnProfiler] Failed to open trace file: " << filename << "\n";
+        return false;
+    }
+
+    std::lock_guard lock(buffersMutex_);
+
+    std::uint64_t t0 = UINT64_MAX;
+    for (const auto &b : buffers_) {
+        if (b->count.load(std::memory_order_acquire) > 0)
+            t0 = std::min(t0, b->events[0].ts);
+    }
+
+    // Trace Event Format: "ts" in microseconds, B/E duration events per tid
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    bool          first   = true;
+    std::uint64_t dropped = 0;
+    for (const auto &b : buffers_) {
+        out << (first ? "" : ",\n")
+            << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << b->tid
+            << ",\"args\":{\"name\":\"host-" << b->tid << "\"}}";
+        first = false;
+
+        const std::size_t n = b->count.load(std::memory_order_acquire);
+        for (std::size_t i = 0; i < n; ++i) {
+            const auto &e = b->events[i];
+            out << ",\n{\"name\":\"" << names_[e.addon] << "." << PhaseName(e.phase)
+                << "\",\"cat\":\"addon\",\"ph\":\"" << (e.begin ? 'B' : 'E')
+                << "\",\"pid\":1,\"tid\":" << b->tid
+                << ",\"ts\":" << std::fixed << std::setprecision(3)
+                << static_cast<double>(e.ts - t0) / 1000.0 << "}";
+        }
+        dropped += b->dropped.load(std::memory_order_relaxed);
+    }
+    out << "\n]}\n";
+
+    std::cout << "[AddOnProfiler] Wrote trace to " << filename;
+    if (dropped)
+        std::cout << " (" << dropped << " events dropped)";
+    std::cout << "\n";
+    return true;
+}
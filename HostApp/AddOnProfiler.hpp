@@ -0,0 +1,151 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// HDR-style latency histogram: log2 major buckets, each split into
+// kSubBuckets linear sub-buckets (~6% relative precision), fixed memory.
+class LatencyHistogram {
+    public:
+        static constexpr std::size_t kSubBits    = 4;
+        static constexpr std::size_t kSubBuckets = std::size_t(1) << kSubBits;
+        static constexpr std::size_t kMajor      = 64 - kSubBits + 1;
+
+        void Record(std::uint64_t ns) {
+            ++counts_[Index(ns)];
+            ++count_;
+            sum_ += ns;
+            if (ns < min_)
+                min_ = ns;
+            if (ns > max_)
+                max_ = ns;
+        }
+
+        std::uint64_t Count() const {
+            return count_;
+        }
+        std::uint64_t Sum() const {
+            return sum_;
+        }
+        std::uint64_t Min() const {
+            return count_ ? min_ : 0;
+        }
+        std::uint64_t Max() const {
+            return max_;
+        }
+        double Mean() const {
+            return count_ ? static_cast<double>(sum_) / static_cast<double>(count_) : 0.0;
+        }
+        // Upper bound of the bucket holding the p-th percentile (0..1)
+        std::uint64_t Percentile(double p) const;
+
+    private:
+        static std::size_t Index(std::uint64_t v) {
+            if (v < kSubBuckets)
+                return static_cast<std::size_t>(v);
+            const std::size_t shift = std::bit_width(v) - 1 - kSubBits;
+            return (shift + 1) * kSubBuckets + static_cast<std::size_t>((v >> shift) - kSubBuckets);
+        }
+        static std::uint64_t UpperBound(std::size_t idx) {
+            if (idx < kSubBuckets)
+                return idx;
+            const std::size_t shift = idx / kSubBuckets - 1;
+            const std::uint64_t sub = idx % kSubBuckets + kSubBuckets;
+            return ((sub + 1) << shift) - 1;
+        }
+
+        std::array<std::uint64_t, kMajor * kSubBuckets> counts_{};
+        std::uint64_t                                   count_ = 0;
+        std::uint64_t                                   sum_   = 0;
+        std::uint64_t                                   min_   = UINT64_MAX;
+        std::uint64_t                                   max_   = 0;
+};
+
+// Times initialize/run/shutdown of every addon (driven by AddOnManager) and,
+// in trace mode, records begin/end events into per-thread lock-free buffers
+// that can be exported as Chrome trace JSON (chrome://tracing, Perfetto).
+class AddOnProfiler {
+    public:
+        enum class Phase : std::uint8_t {
+            Initialize = 0,
+            Run        = 1,
+            Shutdown   = 2
+        };
+        static constexpr std::size_t kPhases = 3;
+
+        AddOnProfiler(std::vector<std::string> addonNames, bool trace,
+            std::size_t traceEventsPerThread = 1u << 20);
+        ~AddOnProfiler();
+
+        AddOnProfiler(const AddOnProfiler &)            = delete;
+        AddOnProfiler &operator=(const AddOnProfiler &) = delete;
+
+        // -------- Hot path --------
+        std::uint64_t Begin(std::size_t addon, Phase phase) {
+            const std::uint64_t t = NowNs();
+            if (trace_)
+                Emit(addon, phase, true, t);
+            return t;
+        }
+        void End(std::size_t addon, Phase phase, std::uint64_t begin) {
+            const std::uint64_t t = NowNs();
+            if (trace_)
+                Emit(addon, phase, false, t);
+            if (addon < stats_.size())
+                stats_[addon][static_cast<std::size_t>(phase)].Record(t - begin);
+        }
+
+        // -------- Query / export --------
+        const LatencyHistogram &Stats(std::size_t addon, Phase phase) const {
+            return stats_[addon][static_cast<std::size_t>(phase)];
+        }
+        const std::vector<std::string> &AddonNames() const {
+            return names_;
+        }
+
+        void PrintSummary(std::ostream &os) const;
+        bool ExportChromeTrace(const std::string &filename) const;
+
+        static std::uint64_t NowNs() {
+            return static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch())
+                    .count());
+        }
+
+    private:
+        struct TraceEvent {
+                std::uint64_t ts;
+                std::uint32_t addon;
+                Phase         phase;
+                bool          begin;
+        };
+
+        // Single-writer buffer owned by one thread; `count` publishes events
+        struct ThreadBuffer {
+                std::uint32_t              tid = 0;
+                std::unique_ptr<TraceEvent[]> events;
+                std::size_t                capacity = 0;
+                std::atomic<std::size_t>   count{0};
+                std::atomic<std::uint64_t> dropped{0};
+        };
+
+        void          Emit(std::size_t addon, Phase phase, bool begin, std::uint64_t ts);
+        ThreadBuffer *LocalBuffer();
+
+        std::vector<std::string>                                names_;
+        std::vector<std::array<LatencyHistogram, kPhases>>     stats_;
+        bool                                                    trace_      = false;
+        std::size_t                                             perThread_  = 0;
+        std::uint64_t                                           generation_ = 0;
+
+        mutable std::mutex                         buffersMutex_; // registration + export only
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+};
@@ -0,0 +1,159 @@
+#include "AddonMemory.hpp"
+#include <algorithm>
+#include <bit>
+#include <new>
+
+namespace {
+    // A distinct address per thread; cheaper to compare than std::thread::id
+    thread_local const char tThreadTag = 0;
+
+    constexpr std::size_t kMinBlock = 16;
+
+    // Size class of a pooled request: 16 B -> 0, 32 B -> 1, ... 4 KiB -> 8.
+    // Blocks are carved at multiples of their size, so they are aligned to it.
+    std::size_t ClassOf(std::size_t bytes, std::size_t align) {
+        const std::size_t need = std::max({bytes, align, kMinBlock});
+        return static_cast<std::size_t>(std::bit_width(need - 1)) - 4;
+    }
+    constexpr std::size_t ClassBytes(std::size_t cls) {
+        return kMinBlock << cls;
+    }
+} // namespace
+
+AddonMemory::AddonMemory(std::size_t budget)
+    : owner_(&tThreadTag), budget_(budget) {}
+
+AddonMemory::~AddonMemory() {
+    for (void *c : chunks_)
+        ::operator delete(c, std::align_val_t{kMaxPooled});
+}
+
+bool AddonMemory::OnOwnerThread() const {
+    return &tThreadTag == owner_;
+}
+
+void AddonMemory::Admit(std::size_t bytes) {
+    const std::uint64_t budget = budget_.load(std::memory_order_relaxed);
+    if (!budget)
+        return;
+    const std::uint64_t live = own_.live.load(std::memory_order_relaxed) + shared_.live.load(std::memory_order_relaxed);
+    if (live + bytes > budget) {
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        throw std::bad_alloc();
+    }
+}
+
+void AddonMemory::Counted(bool owner, std::size_t bytes, bool alloc) {
+    // Unsigned wrap-around makes a free on the other side a plain subtraction
+    const std::uint64_t delta = alloc ? bytes : 0 - static_cast<std::uint64_t>(bytes);
+    Counters           &mine  = owner ? own_ : shared_;
+    Counters           &other = owner ? shared_ : own_;
+    auto               &calls = alloc ? mine.allocations : mine.deallocations;
+
+    std::uint64_t live;
+    if (owner) {
+        live = mine.live.load(std::memory_order_relaxed) + delta;
+        mine.live.store(live, std::memory_order_relaxed);
+        calls.store(calls.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    } else {
+        live = mine.live.fetch_add(delta, std::memory_order_relaxed) + delta;
+        calls.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (alloc) {
+        live += other.live.load(std::memory_order_relaxed);
+        std::uint64_t peak = peak_.load(std::memory_order_relaxed);
+        while (live > peak && !peak_.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+    }
+}
+
+// Links up to `count` fresh blocks of class `cls` from the current chunk,
+// starting a new chunk when not even one fits
+AddonMemory::FreeBlock *AddonMemory::Carve(std::size_t cls, std::size_t count) {
+    const std::size_t size = ClassBytes(cls);
+    auto              at   = reinterpret_cast<std::uintptr_t>(cursor_);
+    at                     = (at + size - 1) & ~(size - 1);
+    if (!cursor_ || at + size > reinterpret_cast<std::uintptr_t>(end_)) {
+        void *chunk = ::operator new(kChunkBytes, std::align_val_t{kMaxPooled});
+        chunks_.push_back(chunk);
+        reserved_.fetch_add(kChunkBytes, std::memory_order_relaxed);
+        cursor_ = static_cast<std::uint8_t *>(chunk);
+        end_    = cursor_ + kChunkBytes;
+        at      = reinterpret_cast<std::uintptr_t>(cursor_);
+    }
+
+    auto *first = reinterpret_cast<std::uint8_t *>(at);
+    count       = std::min<std::size_t>(count, static_cast<std::size_t>(end_ - first) / size);
+    for (std::size_t i = 0; i + 1 < count; ++i)
+        reinterpret_cast<FreeBlock *>(first + i * size)->next = reinterpret_cast<FreeBlock *>(first + (i + 1) * size);
+    reinterpret_cast<FreeBlock *>(first + (count - 1) * size)->next = nullptr;
+    cursor_ = first + count * size;
+    return reinterpret_cast<FreeBlock *>(first);
+}
+
+void *AddonMemory::do_allocate(std::size_t bytes, std::size_t align) {
+    Admit(bytes);
+    const bool owner = OnOwnerThread();
+
+    void *p;
+    if (bytes > kMaxPooled || align > kMaxPooled) {
+        p = ::operator new(bytes, std::align_val_t{align});
+    } else {
+        const std::size_t cls = ClassOf(bytes, align);
+        FreeBlock        *b;
+        if (owner && ownFree_[cls]) {
+            b = ownFree_[cls];
+        } else {
+            std::lock_guard<std::mutex> lock(mutex_);
+            b = sharedFree_[cls];
+            if (owner)
+                sharedFree_[cls] = nullptr; // the owner takes the whole list
+            if (!b)
+                b = Carve(cls, owner ? kRefill : 1);
+            else if (!owner)
+                sharedFree_[cls] = b->next;
+        }
+        if (owner)
+            ownFree_[cls] = b->next;
+        p = b;
+    }
+
+    Counted(owner, bytes, true);
+    return p;
+}
+
+void AddonMemory::do_deallocate(void *p, std::size_t bytes, std::size_t align) {
+    const bool owner = OnOwnerThread();
+    if (bytes > kMaxPooled || align > kMaxPooled) {
+        ::operator delete(p, std::align_val_t{align});
+    } else {
+        // Blocks of one class are interchangeable, whichever list they came from
+        const std::size_t cls = ClassOf(bytes, align);
+        auto             *b   = static_cast<FreeBlock *>(p);
+        if (owner) {
+            b->next       = ownFree_[cls];
+            ownFree_[cls] = b;
+        } else {
+            std::lock_guard<std::mutex> lock(mutex_);
+            b->next          = sharedFree_[cls];
+            sharedFree_[cls] = b;
+        }
+    }
+    Counted(owner, bytes, false);
+}
+
+bool AddonMemory::do_is_equal(const std::pmr::memory_resource &other) const noexcept {
+    return this == &other;
+}
+
+AddonMemory::Stats AddonMemory::stats() const {
+    Stats s;
+    s.live          = own_.live.load(std::memory_order_relaxed) + shared_.live.load(std::memory_order_relaxed);
+    s.peak          = peak_.load(std::memory_order_relaxed);
+    s.allocations   = own_.allocations.load(std::memory_order_relaxed) + shared_.allocations.load(std::memory_order_relaxed);
+    s.deallocations = own_.deallocations.load(std::memory_order_relaxed) + shared_.deallocations.load(std::memory_order_relaxed);
+    s.rejected      = rejected_.load(std::memory_order_relaxed);
+    s.budget        = budget_.load(std::memory_order_relaxed);
+    s.reserved      = reserved_.load(std::memory_order_relaxed);
+    return s;
+}
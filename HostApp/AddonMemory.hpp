@@ -0,0 +1,92 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+// Memory resource the host hands to one addon (IHostServices::Memory()).
+//
+// Blocks up to kMaxPooled bytes come from power-of-two size classes carved
+// out of 64 KiB chunks and recycled through free lists; larger ones go to
+// the global heap. The thread that created the resource (the host's cycle
+// thread, or the runner process for isolated addons) owns a private set of
+// free lists and counters and allocates without locks or atomic RMWs; other
+// threads share a mutex-protected set. Chunks are only returned when the
+// resource is destroyed, after the addon.
+//
+// Every allocation is counted. With a budget set, a request that would take
+// the live total over it throws std::bad_alloc, which is how a pmr resource
+// reports failure.
+class AddonMemory: public std::pmr::memory_resource {
+    public:
+        static constexpr std::size_t kMaxPooled = 4096;
+
+        struct Stats {
+                std::uint64_t live          = 0; // bytes currently allocated
+                std::uint64_t peak          = 0;
+                std::uint64_t allocations   = 0;
+                std::uint64_t deallocations = 0;
+                std::uint64_t rejected      = 0; // over budget
+                std::uint64_t budget        = 0; // 0 = unlimited
+                std::uint64_t reserved      = 0; // chunk bytes held by the pools
+        };
+
+        explicit AddonMemory(std::size_t budget = 0);
+        ~AddonMemory() override;
+
+        AddonMemory(const AddonMemory &)            = delete;
+        AddonMemory &operator=(const AddonMemory &) = delete;
+
+        // Hard cap on live bytes, 0 = unlimited; applies to later allocations
+        void setBudget(std::size_t bytes) {
+            budget_.store(bytes, std::memory_order_relaxed);
+        }
+
+        Stats stats() const;
+
+    private:
+        static constexpr std::size_t kClasses    = 9; // 16 B .. 4 KiB
+        static constexpr std::size_t kChunkBytes = std::size_t(64) << 10;
+        static constexpr std::size_t kRefill     = 32; // blocks carved per refill
+
+        struct FreeBlock {
+                FreeBlock *next;
+        };
+        using FreeLists = std::array<FreeBlock *, kClasses>;
+
+        // The owner's set is only written by the owner thread (load + store);
+        // the shared set takes fetch_add from any other thread.
+        struct Counters {
+                std::atomic<std::uint64_t> live{0}; // may wrap: frees on the other side
+                std::atomic<std::uint64_t> allocations{0};
+                std::atomic<std::uint64_t> deallocations{0};
+        };
+
+        void *do_allocate(std::size_t bytes, std::size_t align) override;
+        void  do_deallocate(void *p, std::size_t bytes, std::size_t align) override;
+        bool  do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+        bool       OnOwnerThread() const;
+        void       Admit(std::size_t bytes); // budget check, throws
+        void       Counted(bool owner, std::size_t bytes, bool alloc);
+        FreeBlock *Carve(std::size_t cls, std::size_t count); // mutex_ held
+
+        const void *owner_;     // thread tag of the creating thread
+        FreeLists   ownFree_{}; // owner thread only
+
+        std::mutex          mutex_; // guards the members up to end_
+        FreeLists           sharedFree_{};
+        std::vector<void *> chunks_;
+        std::uint8_t       *cursor_ = nullptr; // unused tail of chunks_.back()
+        std::uint8_t       *end_    = nullptr;
+
+        Counters                   own_;
+        Counters                   shared_;
+        std::atomic<std::uint64_t> peak_{0};
+        std::atomic<std::uint64_t> rejected_{0};
+        std::atomic<std::uint64_t> budget_;
+        std::atomic<std::uint64_t> reserved_{0};
+};
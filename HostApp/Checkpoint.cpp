@@ -0,0 +1,236 @@
+#include "Checkpoint.hpp"
+#include "AddOnManager.hpp"
+#include "MappedFile.hpp"
+#include "PortManager.hpp"
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <string_view>
+#include <vector>
+
+namespace {
+    constexpr char kMagic[4] = {'C', 'K', 'v', '1'};
+
+    enum class SectionKind : std::uint32_t {
+        DirectTransport = 0,
+        BufferedConnection = 1,
+        PluginState = 2
+    };
+
+    struct FileHeader {
+            char          magic[4];
+            std::uint32_t sectionCount;
+            std::uint64_t totalBytes;
+    };
+
+    struct SectionHeader {
+            SectionKind   kind;
+            std::uint32_t nameLen;
+            std::uint64_t typeHash;
+            std::uint64_t bytes;
+            std::uint32_t hasData;
+            std::uint32_t reserved;
+    };
+
+    constexpr std::size_t Align8(std::size_t n) {
+        return (n + 7) & ~std::size_t(7);
+    }
+
+    // One section to be written; data points into live memory until Save() copies it
+    struct Pending {
+            SectionKind               kind;
+            std::string               name;
+            std::uint64_t             typeHash = 0;
+            const void               *data     = nullptr;
+            std::size_t               bytes    = 0;
+            bool                      hasData  = true;
+            std::vector<std::uint8_t> owned{}; // plugin blobs
+    };
+
+    std::string PortName(const PortManager::PortKey &k) {
+        return k.addon + "::" + k.port;
+    }
+    std::string ConnName(const PortManager::Connection &c) {
+        return PortName(c.provider) + "->" + PortName(c.receiver);
+    }
+} // namespace
+
+bool Checkpoint::Save(const std::string &filename, PortManager &ports, AddOnManager &addons) {
+    std::vector<Pending> sections;
+
+    // Direct transports: one block per provider, receivers share it
+    for (const auto &[key, pi] : ports.ports()) {
+        if (pi.desc.AccessPolicy == PluginAPI::DataAccessPolicy::Direct &&
+            pi.desc.Direction == PluginAPI::PortDirection::Output && pi.transport) {
+            sections.push_back({.kind = SectionKind::DirectTransport,
+                .name                 = PortName(key),
+                .typeHash             = pi.desc.TypeHash,
+                .data                 = pi.transport,
+                .bytes                = pi.desc.PayloadSize});
+        }
+    }
+
+    for (const auto &c : ports.connections()) {
+        if (!c.slot || c.removed)
+            continue;
+        const auto *pi = ports.FindPort(c.provider);
+        sections.push_back({.kind = SectionKind::BufferedConnection,
+            .name                 = ConnName(c),
+            .typeHash             = pi ? pi->desc.TypeHash : 0,
+            .data                 = c.data,
+            .bytes                = c.bytes,
+            .hasData              = c.slot->hasData != 0});
+    }
+
+    for (const auto &a : addons.addons()) {
+        const std::size_t need = a.plugin->saveState(nullptr, 0);
+        if (need == 0)
+            continue;
+        Pending p{.kind = SectionKind::PluginState, .name = a.name};
+        p.owned.resize(need);
+        p.bytes = a.plugin->saveState(p.owned.data(), p.owned.size());
+        if (p.bytes == 0 || p.bytes > need)
+            continue;
+        p.data = p.owned.data();
+        sections.push_back(std::move(p));
+    }
+
+    std::size_t total = sizeof(FileHeader);
+    for (const auto &s : sections)
+        total += Align8(sizeof(SectionHeader) + s.name.size() + s.bytes);
+
+    // Write next to the target and rename, so a crash never leaves a torn checkpoint
+    const std::string tmp = filename + ".tmp";
+    {
+        MappedFile file;
+        if (!file.open(tmp, MappedFile::Mode::ReadWrite, total)) {
+            std::cerr << "[Checkpoint] Failed to create " << tmp << "\n";
+            return false;
+        }
+
+        auto      *base = file.data();
+        FileHeader hdr{};
+        std::memcpy(hdr.magic, kMagic, sizeof(kMagic));
+        hdr.sectionCount = static_cast<std::uint32_t>(sections.size());
+        hdr.totalBytes   = total;
+        std::memcpy(base, &hdr, sizeof(hdr));
+
+        std::size_t pos = sizeof(FileHeader);
+        for (const auto &s : sections) {
+            SectionHeader sh{s.kind, static_cast<std::uint32_t>(s.name.size()), s.typeHash,
+                s.bytes, s.hasData ? 1u : 0u, 0};
+            std::memcpy(base + pos, &sh, sizeof(sh));
+            std::memcpy(base + pos + sizeof(sh), s.name.data(), s.name.size());
+            std::memcpy(base + pos + sizeof(sh) + s.name.size(), s.data, s.bytes);
+            pos += Align8(sizeof(sh) + s.name.size() + s.bytes);
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp, filename, ec);
+    if (ec) {
+        std::cerr << "[Checkpoint] Failed to replace " << filename << ": " << ec.message() << "\n";
+        return false;
+    }
+
+    std::cout << "[Checkpoint] Saved " << sections.size() << " sections (" << total
+              << " bytes) to " << filename << "\n";
+    return true;
+}
+
+bool Checkpoint::Restore(const std::string &filename, PortManager &ports, AddOnManager &addons,
+    Stats *stats) {
+    MappedFile file;
+    if (!file.open(filename, MappedFile::Mode::ReadOnly) || file.size() < sizeof(FileHeader))
+        return false;
+
+    FileHeader hdr{};
+    std::memcpy(&hdr, file.data(), sizeof(hdr));
+    if (std::memcmp(hdr.magic, kMagic, sizeof(kMagic)) != 0 || hdr.totalBytes > file.size()) {
+        std::cerr << "[Checkpoint] Invalid checkpoint: " << filename << "\n";
+        return false;
+    }
+
+    struct Section {
+            SectionHeader       hdr;
+            const std::uint8_t *data;
+    };
+    std::map<std::pair<SectionKind, std::string_view>, Section> index;
+
+    // Every section has to fit in totalBytes (checked against the file above)
+    std::size_t pos = sizeof(FileHeader);
+    for (std::uint32_t i = 0; i < hdr.sectionCount; ++i) {
+        SectionHeader sh{};
+        if (pos > hdr.totalBytes || hdr.totalBytes - pos < sizeof(sh)) {
+            std::cerr << "[Checkpoint] Truncated checkpoint: " << filename << "\n";
+            return false;
+        }
+        std::memcpy(&sh, file.data() + pos, sizeof(sh));
+        const std::uint64_t room = hdr.totalBytes - pos - sizeof(sh);
+        if (sh.bytes > room || sh.nameLen > room - sh.bytes) {
+            std::cerr << "[Checkpoint] Truncated checkpoint: " << filename << "\n";
+            return false;
+        }
+        const char *name = reinterpret_cast<const char *>(file.data() + pos + sizeof(sh));
+        index[{sh.kind, std::string_view(name, sh.nameLen)}] =
+            Section{sh, file.data() + pos + sizeof(sh) + sh.nameLen};
+        pos += Align8(sizeof(sh) + sh.nameLen + sh.bytes);
+    }
+
+    Stats st;
+    auto  lookup = [&](SectionKind kind, const std::string &name) -> const Section * {
+        auto it = index.find({kind, std::string_view(name)});
+        return it == index.end() ? nullptr : &it->second;
+    };
+
+    for (const auto &[key, pi] : ports.ports()) {
+        if (pi.desc.AccessPolicy != PluginAPI::DataAccessPolicy::Direct ||
+            pi.desc.Direction != PluginAPI::PortDirection::Output || !pi.transport)
+            continue;
+        const auto *s = lookup(SectionKind::DirectTransport, PortName(key));
+        if (!s)
+            continue;
+        if (s->hdr.bytes != pi.desc.PayloadSize || s->hdr.typeHash != pi.desc.TypeHash) {
+            ++st.skipped;
+            continue;
+        }
+        std::memcpy(pi.transport, s->data, pi.desc.PayloadSize);
+        PluginAPI::StampDirectWrite(pi.transport); // readers see it as new
+        ++st.transports;
+    }
+
+    for (auto &c : ports.connections()) {
+        if (!c.slot || c.removed)
+            continue;
+        const auto *s  = lookup(SectionKind::BufferedConnection, ConnName(c));
+        const auto *pi = ports.FindPort(c.provider);
+        if (!s)
+            continue;
+        if (s->hdr.bytes != c.bytes || !pi || s->hdr.typeHash != pi->desc.TypeHash) {
+            ++st.skipped;
+            continue;
+        }
+        std::memcpy(c.data, s->data, c.bytes);
+        c.slot->hasData = s->hdr.hasData != 0 ? 1 : 0;
+        PluginAPI::PublishSequence(c.slot->header, c.slot->header.sequence + 1);
+        ++st.buffers;
+    }
+
+    for (auto &a : addons.addons()) {
+        const auto *s = lookup(SectionKind::PluginState, a.name);
+        if (!s)
+            continue;
+        if (a.plugin->restoreState(s->data, static_cast<std::size_t>(s->hdr.bytes)))
+            ++st.plugins;
+        else
+            ++st.skipped;
+    }
+
+    std::cout << "[Checkpoint] Restored " << st.transports << " transports, " << st.buffers
+              << " buffers, " << st.plugins << " plugin states (" << st.skipped
+              << " skipped) from " << filename << "\n";
+    if (stats)
+        *stats = st;
+    return true;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+class PortManager;
+class AddOnManager;
+
+// Warm-restart checkpoints ("CKv1").
+//
+// Save() snapshots every Direct transport, every Buffered connection buffer
+// and the opaque IPlugin::saveState() blob of each addon into a file-backed
+// mapping. Restore() copies them back after Connect() + initializeAll(), so a
+// restarted pipeline resumes from its last state instead of from zero.
+// Entries are matched by port/addon name and validated by size and TypeHash;
+// anything that no longer matches is skipped.
+class Checkpoint {
+    public:
+        struct Stats {
+                std::size_t transports = 0;
+                std::size_t buffers    = 0;
+                std::size_t plugins    = 0;
+                std::size_t skipped    = 0;
+        };
+
+        static bool Save(const std::string &filename, PortManager &ports, AddOnManager &addons);
+        static bool Restore(const std::string &filename, PortManager &ports, AddOnManager &addons,
+            Stats *stats = nullptr);
+};
@@ -0,0 +1,195 @@
+#include "GraphOptimizer.hpp"
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include "AddOnManager.hpp"
+#include "PortManager.hpp"
+
+using PluginAPI::ThreadingModel;
+
+namespace {
+    constexpr std::size_t kNone = static_cast<std::size_t>(-1);
+
+    void AddEdge(std::vector<std::size_t> &edges, std::size_t to) {
+        if (std::find(edges.begin(), edges.end(), to) == edges.end())
+            edges.push_back(to);
+    }
+
+    // "A, B, C ... (+n more)"
+    void PrintNames(const std::vector<std::string> &names, std::ostream &os, const char *sep,
+        std::size_t max = 8) {
+        for (std::size_t i = 0; i < names.size() && i < max; ++i)
+            os << (i ? sep : "") << names[i];
+        if (names.size() > max)
+            os << " ... (+" << names.size() - max << " more)";
+    }
+} // namespace
+
+GraphOptimizer::Report GraphOptimizer::Run(AddOnManager &addons, PortManager &ports, const Options &opt) {
+    Report      rep;
+    auto       &list = addons.addons();
+    const auto  n    = list.size();
+
+    std::map<std::string, std::size_t>    index;
+    std::vector<PluginAPI::ExecutionHints> hints(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        index[list[i].name] = i;
+        hints[i]            = list[i].plugin->getExecutionHints();
+    }
+    auto addonOf = [&](const std::string &name) {
+        const auto it = index.find(name);
+        return it == index.end() ? kNone : it->second;
+    };
+
+    // Addon-level graph
+    std::vector<std::vector<std::size_t>> succ(n), pred(n);
+    for (const auto &c : ports.connections()) {
+        const std::size_t p = addonOf(c.provider.addon);
+        const std::size_t r = addonOf(c.receiver.addon);
+        if (p == kNone || r == kNone || c.removed)
+            continue;
+        AddEdge(succ[p], r);
+        AddEdge(pred[r], p);
+    }
+    std::vector<bool> declaresOutputs(n, false);
+    for (const auto &[key, pi] : ports.ports()) {
+        const std::size_t a = addonOf(key.addon);
+        if (a != kNone && pi.desc.Direction == PluginAPI::PortDirection::Output)
+            declaresOutputs[a] = true;
+    }
+
+    // ---- prune: live = reaches a sink ----
+    std::vector<bool> live(n, !opt.prune);
+    if (opt.prune) {
+        std::vector<std::size_t> todo;
+        for (std::size_t i = 0; i < n; ++i) {
+            if (!list[i].enabled)
+                continue;
+            if (succ[i].empty() && (!declaresOutputs[i] || !pred[i].empty())) {
+                live[i] = true;
+                todo.push_back(i);
+            }
+        }
+        while (!todo.empty()) {
+            const std::size_t a = todo.back();
+            todo.pop_back();
+            for (std::size_t p : pred[a]) {
+                if (!live[p] && list[p].enabled) {
+                    live[p] = true;
+                    todo.push_back(p);
+                }
+            }
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            if (!live[i] && list[i].enabled) {
+                list[i].enabled = false;
+                rep.prunedAddons.push_back(list[i].name);
+            }
+        }
+
+        // Ports with at least one connection between live addons stay
+        std::map<PortManager::PortKey, bool> used;
+        for (const auto &c : ports.connections()) {
+            const std::size_t p = addonOf(c.provider.addon);
+            const std::size_t r = addonOf(c.receiver.addon);
+            if (p != kNone && r != kNone && live[p] && live[r] && !c.removed)
+                used[c.provider] = used[c.receiver] = true;
+        }
+        for (const auto &[key, info] : ports.ports()) {
+            if (used.contains(key) || info.desc.Type == PluginAPI::PortType::MappedFile)
+                continue; // resource ports have a file, not a peer
+            ports.FindPort(key)->pruned = true;
+            ++rep.prunedPorts;
+        }
+    }
+
+    // ---- specialize: single-reader Buffered links on the cycle thread ----
+    auto cycleThread = [&](std::size_t a) {
+        return a != kNone && hints[a].threading == ThreadingModel::CycleThread;
+    };
+    if (opt.specialize) {
+        for (const auto &[key, info] : ports.ports()) {
+            if (info.pruned || info.outbound->size() != 1 ||
+                info.desc.AccessPolicy != PluginAPI::DataAccessPolicy::Buffered ||
+                info.outbound->front()->policy.mode != DeliveryPolicy::Mode::All)
+                continue;
+            const std::size_t p = addonOf(key.addon);
+            const std::size_t r = addonOf(info.outbound->front()->receiver.addon);
+            if (!cycleThread(p) || !cycleThread(r) || !live[p] || !live[r])
+                continue;
+            ports.FindPort(key)->link = true;
+            ++rep.specializedLinks;
+        }
+    }
+
+    // ---- fuse: 1:1 chains of light addons ----
+    if (opt.fuse) {
+        std::vector<std::size_t> next(n, kNone), prev(n, kNone);
+        for (std::size_t a = 0; a < n; ++a) {
+            if (succ[a].size() != 1)
+                continue;
+            const std::size_t b = succ[a].front();
+            if (b != a && pred[b].size() == 1 && live[a] && live[b] && list[a].enabled && list[b].enabled &&
+                hints[a].light && hints[b].light) {
+                next[a] = b;
+                prev[b] = a;
+            }
+        }
+
+        // Walk from each head; links left unvisited form cycles and are dropped
+        std::vector<bool> visited(n, false);
+        for (std::size_t a = 0; a < n; ++a) {
+            if (prev[a] != kNone || next[a] == kNone)
+                continue;
+            for (std::size_t m = a; m != kNone; m = next[m])
+                visited[m] = true;
+        }
+        for (std::size_t a = 0; a < n; ++a) {
+            if (!visited[a])
+                next[a] = prev[a] = kNone;
+        }
+
+        // Each chain runs at its head's position, members right after it
+        std::vector<std::size_t> order;
+        order.reserve(n);
+        for (std::size_t a = 0; a < n; ++a) {
+            if (prev[a] != kNone)
+                continue; // placed by its head
+            order.push_back(a);
+            if (next[a] == kNone)
+                continue;
+            const int                unit = static_cast<int>(rep.fusedChains.size());
+            std::vector<std::string> names;
+            for (std::size_t m = a; m != kNone; m = next[m]) {
+                if (m != a)
+                    order.push_back(m);
+                list[m].unit = unit;
+                names.push_back(list[m].name);
+            }
+            rep.fusedChains.push_back(std::move(names));
+        }
+        if (!rep.fusedChains.empty())
+            addons.reorder(order);
+    }
+
+    return rep;
+}
+
+void GraphOptimizer::Print(const Report &r, std::ostream &os) {
+    os << "\n[GraphOptimizer] Pruned " << r.prunedAddons.size() << " addons";
+    if (!r.prunedAddons.empty()) {
+        os << " (";
+        PrintNames(r.prunedAddons, os, ", ");
+        os << ")";
+    }
+    os << " and " << r.prunedPorts << " ports\n";
+    os << "[GraphOptimizer] Specialized " << r.specializedLinks << " single-reader links\n";
+    os << "[GraphOptimizer] Fused " << r.fusedChains.size() << " chains\n";
+    for (std::size_t i = 0; i < r.fusedChains.size() && i < 8; ++i) {
+        os << "  ";
+        PrintNames(r.fusedChains[i], os, " -> ");
+        os << "\n";
+    }
+    if (r.fusedChains.size() > 8)
+        os << "  ... (+" << r.fusedChains.size() - 8 << " more)\n";
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+class AddOnManager;
+class PortManager;
+
+// Optional pass between wiring and AddOnManager::initializeAll(); the graph
+// runs as declared without it.
+//
+//  - prune:      addons from which no sink is reachable are disabled, and
+//                ports without a live peer get a no-op handle. A sink is an
+//                addon without output ports, or one that consumes something
+//                and feeds nothing.
+//  - specialize: Buffered outputs with a single reader, between addons that
+//                use their ports only from the cycle thread, get the
+//                single-slot write path (PortManager::kLinkOps), unless the
+//                connection has a delivery policy.
+//  - fuse:       chains of light addons (ExecutionHints::light) where each
+//                link is the only edge out of one and into the next become
+//                one scheduling unit: consecutive in the cycle, and one
+//                runner dispatch under `--isolate each`.
+class GraphOptimizer {
+    public:
+        struct Options {
+                bool prune      = true;
+                bool specialize = true;
+                bool fuse       = true;
+        };
+
+        struct Report {
+                std::vector<std::string>              prunedAddons;
+                std::size_t                           prunedPorts      = 0;
+                std::size_t                           specializedLinks = 0;
+                std::vector<std::vector<std::string>> fusedChains;
+        };
+
+        static Report Run(AddOnManager &addons, PortManager &ports, const Options &opt);
+        static Report Run(AddOnManager &addons, PortManager &ports) {
+            return Run(addons, ports, Options{});
+        }
+        static void   Print(const Report &r, std::ostream &os);
+};
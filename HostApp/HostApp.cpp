@@ -1,34 +1,360 @@
 #include <iostream>
+#include <algorithm>
+#include <chrono>
 #include <filesystem>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
 #include "AddOnManager.hpp"
+#include "Checkpoint.hpp"
+#include "GraphOptimizer.hpp"
+#include "HostClock.hpp"
+#include "HostLogger.hpp"
+#include "LoadGenerator.hpp"
+#include "NumaPlacement.hpp"
+#include "NumaTopology.hpp"
+#include "PageFaults.hpp"
 #include "PortManager.hpp"
+#include "PortReplayer.hpp"
+#include "StatsPublisher.hpp"
 
 namespace fs = std::filesystem;
 
-int main() {
+static void PrintUsage() {
+    std::cout << "Usage: HostApp [--record <log>] [--checkpoint <file>] [--metrics <ms>]\n"
+              << "               [--profile] [--trace <trace.json>] [--cycles <n>]\n"
+              << "               [--synth <spec>|default] [--stats <name>]\n"
+              << "               [--isolate each|all|A,B;C] [--runner-timeout <ms>]\n"
+              << "               [--mem-budget [<addon>=]<KiB>]... [--optimize]\n"
+              << "               [--period <us>] [--clock real|virtual]\n"
+              << "               [--log-level debug|info|warn|error]\n"
+              << "               [--low-jitter] [--warmup <cycles>]\n"
+              << "               [--resource <addon>::<port>=<file>]... [--numa auto|<node>:<cpus>;...]\n"
+              << "       HostApp --replay <log> [--addons A,B,...] [--realtime] [--batch <n>]\n"
+              << "               [--clock real|virtual]\n";
+}
+
+int main(int argc, char **argv) {
+    std::string           recordFile;
+    std::string           replayFile;
+    std::string           checkpointFile;
+    std::set<std::string> replayAddons;
+    bool                  realtime        = false;
+    int                   metricsPeriodMs = -1; // -1 = off, 0 = final summary only
+    bool                  profile         = false;
+    std::string           traceFile;
+    std::string           synthSpec;
+    std::string           statsName;
+    int                   cycles = 10;
+    std::string           isolateSpec;
+    std::string           numaSpec; // "" = no placement
+    bool                  optimize = false;
+    int                   runnerTimeoutMs = 1000;
+    int                   batch           = 1; // replay cycles per runBatch()
+    int                   periodUs        = 0; // 0 = cycles back to back
+    HostClock::Mode       clockMode       = HostClock::Mode::Real;
+    PluginAPI::LogLevel   logLevel        = PluginAPI::LogLevel::Info;
+    bool                  lowJitter       = false;
+    int                   warmup          = -1; // dry cycles, -1 = 100 with --low-jitter, else 0
+
+    std::vector<std::pair<std::string, std::size_t>>          memBudgets; // addon ("" = all), bytes
+    std::vector<std::pair<PortManager::PortKey, std::string>> resources;  // resource port, file
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--record" && i + 1 < argc) {
+            recordFile = argv[++i];
+        } else if (arg == "--checkpoint" && i + 1 < argc) {
+            checkpointFile = argv[++i];
+        } else if (arg == "--replay" && i + 1 < argc) {
+            replayFile = argv[++i];
+        } else if (arg == "--addons" && i + 1 < argc) {
+            std::stringstream ss(argv[++i]);
+            for (std::string name; std::getline(ss, name, ',');)
+                replayAddons.insert(name);
+        } else if (arg == "--metrics" && i + 1 < argc) {
+            metricsPeriodMs = std::stoi(argv[++i]);
+        } else if (arg == "--profile") {
+            profile = true;
+        } else if (arg == "--trace" && i + 1 < argc) {
+            traceFile = argv[++i];
+        } else if (arg == "--synth" && i + 1 < argc) {
+            synthSpec = argv[++i];
+        } else if (arg == "--stats" && i + 1 < argc) {
+            statsName = argv[++i];
+        } else if (arg == "--cycles" && i + 1 < argc) {
+            cycles = std::stoi(argv[++i]);
+        } else if (arg == "--isolate" && i + 1 < argc) {
+            isolateSpec = argv[++i];
+        } else if (arg == "--runner-timeout" && i + 1 < argc) {
+            runnerTimeoutMs = std::stoi(argv[++i]);
+        } else if (arg == "--mem-budget" && i + 1 < argc) {
+            // "Addon=KiB" for one addon, plain "KiB" for every addon
+            const std::string value = argv[++i];
+            const auto        eq    = value.find('=');
+            const std::string name  = eq == std::string::npos ? "" : value.substr(0, eq);
+            memBudgets.emplace_back(name, std::stoull(value.substr(eq == std::string::npos ? 0 : eq + 1)) << 10);
+        } else if (arg == "--resource" && i + 1 < argc) {
+            // "Addon::Port=file"
+            const std::string value = argv[++i];
+            const auto        sep   = value.find("::");
+            const auto        eq    = value.find('=');
+            if (sep == std::string::npos || eq == std::string::npos || eq < sep) {
+                PrintUsage();
+                return 1;
+            }
+            resources.push_back({{value.substr(0, sep), value.substr(sep + 2, eq - sep - 2)}, value.substr(eq + 1)});
+        } else if (arg == "--numa" && i + 1 < argc) {
+            numaSpec = argv[++i];
+        } else if (arg == "--optimize") {
+            optimize = true;
+        } else if (arg == "--batch" && i + 1 < argc) {
+            batch = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--period" && i + 1 < argc) {
+            periodUs = std::max(0, std::stoi(argv[++i]));
+        } else if (arg == "--clock" && i + 1 < argc) {
+            const std::string mode = argv[++i];
+            if (mode != "real" && mode != "virtual") {
+                PrintUsage();
+                return 1;
+            }
+            clockMode = mode == "virtual" ? HostClock::Mode::Virtual : HostClock::Mode::Real;
+        } else if (arg == "--log-level" && i + 1 < argc) {
+            const std::string level = argv[++i];
+            if (level == "debug") {
+                logLevel = PluginAPI::LogLevel::Debug;
+            } else if (level == "info") {
+                logLevel = PluginAPI::LogLevel::Info;
+            } else if (level == "warn") {
+                logLevel = PluginAPI::LogLevel::Warn;
+            } else if (level == "error") {
+                logLevel = PluginAPI::LogLevel::Error;
+            } else {
+                PrintUsage();
+                return 1;
+            }
+        } else if (arg == "--low-jitter") {
+            lowJitter = true;
+        } else if (arg == "--warmup" && i + 1 < argc) {
+            warmup = std::max(0, std::stoi(argv[++i]));
+        } else if (arg == "--realtime") {
+            realtime = true;
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    // Runner processes own their addons' state: nothing to record,
+    // replay into or checkpoint from the host
+    if (!isolateSpec.empty() && (!recordFile.empty() || !replayFile.empty() || !checkpointFile.empty())) {
+        std::cerr << "[HostApp] --isolate cannot be combined with --record, --replay or --checkpoint\n";
+        return 1;
+    }
+
+    // Replay drives a subset of the addons; pruning would fight it
+    if (optimize && !replayFile.empty()) {
+        std::cerr << "[HostApp] --optimize cannot be combined with --replay\n";
+        return 1;
+    }
+
+    // Virtual time exists in the host process only
+    if (clockMode == HostClock::Mode::Virtual && !isolateSpec.empty()) {
+        std::cerr << "[HostApp] --clock virtual cannot be combined with --isolate\n";
+        return 1;
+    }
+
+    if (batch > 1 && replayFile.empty()) {
+        std::cerr << "[HostApp] --batch only applies to --replay\n";
+        return 1;
+    }
+
+    if (warmup < 0)
+        warmup = lowJitter ? 100 : 0;
+
     std::cout << "[HostApp] Starting AddOnManager + PortManager demo\n";
 
+    // Outlives the managers: addons and the host log through it to the end.
+    // Its thread starts after the runners fork (until then logs are written
+    // synchronously).
+    std::optional<HostLogger> logger;
+    HostLogger::SetMinLevel(logLevel);
+
     AddOnManager mgr;
     PortManager  portMgr;
+    HostClock    clock(clockMode);
+    portMgr.UseClock(&clock);
+    for (const auto &[name, bytes] : memBudgets)
+        mgr.setMemoryBudget(name, bytes);
 
-    mgr.addSearchDir(fs::current_path() / "bin");
-
-    if (!mgr.scanAndLoad()) {
-        std::cerr << "[HostApp] No addons loaded.\n";
+    // Transports must be in shared memory before anything is connected
+    if (!isolateSpec.empty() && !portMgr.UseSharedTransports())
+        return 1;
+    if (lowJitter && !portMgr.UseLowJitterTransports())
         return 1;
+
+    if (!synthSpec.empty()) {
+        // Stress graph of synthetic addons instead of the demo addons
+        LoadGenerator::Spec spec;
+        if (!LoadGenerator::ParseSpec(synthSpec, spec) ||
+            !LoadGenerator::Build(spec, LoadGenerator::DefaultLibrary(fs::current_path() / "bin"), mgr, portMgr)) {
+            std::cerr << "[HostApp] Failed to build synthetic graph.\n";
+            return 1;
+        }
+    } else {
+        mgr.addSearchDir(fs::current_path() / "bin");
+
+        if (!mgr.scanAndLoad()) {
+            std::cerr << "[HostApp] No addons loaded.\n";
+            return 1;
+        }
+
+        // Register all ports in PortManager
+        mgr.discoverPortsForAll(portMgr);
+
+        portMgr.Connect("MyAddon", "OutPacket",
+            "MyAddon2", "InPacket");
+
+        portMgr.Connect("MyAddon", "OutPacket",
+            "MyAddon3", "InPacket");
+
+        portMgr.PrintConnections();
     }
 
-    // Register all ports in PortManager
-    mgr.discoverPortsForAll(portMgr);
+    // Mapped once per file, before the runners fork and inherit the mappings
+    for (const auto &[port, file] : resources) {
+        if (!portMgr.BindResource(port, file))
+            return 1;
+    }
+    if (!resources.empty())
+        std::cout << "[HostApp] Resources: " << portMgr.resources().size() << " files, "
+                  << (portMgr.resources().mappedBytes() >> 10) << " KiB mapped\n";
 
-    portMgr.Connect("MyAddon", "OutPacket",
-        "MyAddon2", "InPacket");
+    // Before isolate() and profiling: fusing reorders the addons
+    if (optimize)
+        GraphOptimizer::Print(GraphOptimizer::Run(mgr, portMgr), std::cout);
 
-    portMgr.Connect("MyAddon", "OutPacket",
-        "MyAddon3", "InPacket");
+    if (!isolateSpec.empty()) {
+        // "A,B;C": runner 1 hosts A and B, runner 2 hosts C
+        std::vector<std::vector<std::string>> groups;
+        std::stringstream                     ss(isolateSpec);
+        for (std::string group; std::getline(ss, group, ';');) {
+            std::stringstream        gs(group);
+            std::vector<std::string> names;
+            for (std::string name; std::getline(gs, name, ',');)
+                names.push_back(name);
+            groups.push_back(std::move(names));
+        }
+        if (!mgr.isolate(groups, std::chrono::milliseconds(runnerTimeoutMs)))
+            return 1;
+    }
+
+    // After isolate(): every runner gets a node along with the cycle thread
+    if (!numaSpec.empty()) {
+        NumaTopology topo;
+        std::string  why;
+        if (numaSpec == "auto")
+            topo = NumaTopology::Detect();
+        else if (!NumaTopology::Parse(numaSpec, topo, why)) {
+            std::cerr << "[HostApp] --numa: " << why << "\n";
+            return 1;
+        }
+        topo.Print(std::cout);
+        NumaPlacement::Print(NumaPlacement::Run(mgr, portMgr, topo), topo, std::cout);
+    }
+
+    // The last point where the host is single-threaded: the runners (and
+    // their restarts) fork from here, before any of the threads below
+    mgr.startRunners(portMgr);
+
+    logger.emplace();
+    portMgr.UseLogger(&*logger);
+
+    // The stats page is fed by the profiler and the metrics
+    if (profile || !traceFile.empty() || !statsName.empty())
+        mgr.enableProfiling(!traceFile.empty());
+
+    if (metricsPeriodMs >= 0 || !statsName.empty())
+        portMgr.EnableMetrics();
+    if (metricsPeriodMs > 0)
+        portMgr.metrics()->StartPeriodicDump(std::chrono::milliseconds(metricsPeriodMs), std::cout);
+
+    StatsPublisher stats;
+    if (!statsName.empty() && !stats.Open(StatsPage::PathFor(statsName), mgr, portMgr))
+        return 1;
 
-    portMgr.PrintConnections();
-    mgr.runAll(portMgr);
+    if (!replayFile.empty()) {
+        PortReplayer replayer;
+        if (!replayer.Open(replayFile))
+            return 1;
+        mgr.initializeAll(portMgr);
+        replayer.Replay(portMgr, mgr, replayAddons,
+            realtime ? PortReplayer::Timing::Original : PortReplayer::Timing::AsFastAsPossible,
+            static_cast<std::size_t>(batch));
+        logger->Flush(); // run() output before the shutdown messages
+        mgr.shutdownAll();
+    } else {
+        if (!recordFile.empty() && !portMgr.StartRecording(recordFile))
+            return 1;
+
+        mgr.initializeAll(portMgr);
+
+        // Before the restore, which then overwrites what the dry cycles left
+        if (warmup > 0) {
+            std::cout << "[HostApp] Warm-up: " << warmup << " cycles\n";
+            mgr.warmUp(static_cast<std::size_t>(warmup));
+            logger->Flush();
+        }
+
+        // Warm restart: transports + plugin state from the last run
+        if (!checkpointFile.empty() && fs::exists(checkpointFile))
+            Checkpoint::Restore(checkpointFile, portMgr, mgr);
+
+        std::cout << "[HostApp] Run\n";
+        CycleScheduler      scheduler(clock, static_cast<std::uint64_t>(periodUs) * 1000);
+        const std::uint64_t wallStart     = PluginAPI::SteadyNowNs();
+        const PageFaults    threadFaults  = PageFaults::Thread();
+        const PageFaults    processFaults = PageFaults::Process();
+        for (int i = 0; i < cycles; ++i) {
+            scheduler.WaitNext();
+            mgr.runCycle();
+            stats.Update(mgr, portMgr, static_cast<std::uint64_t>(i + 1));
+        }
+        const PageFaults steady  = PageFaults::Thread() - threadFaults;
+        const PageFaults process = PageFaults::Process() - processFaults;
+        logger->Flush(); // run() output before the summaries
+        if (lowJitter) {
+            std::cout << "[HostApp] Steady state: " << steady.minor << " minor / " << steady.major
+                      << " major page faults on the cycle thread, " << process.minor << " / " << process.major
+                      << " process-wide, over " << cycles << " cycles (" << (portMgr.arena().locked() >> 10)
+                      << " KiB of transports locked)\n";
+        }
+        stats.Publish(mgr, portMgr, static_cast<std::uint64_t>(cycles));
+        if (periodUs || clockMode == HostClock::Mode::Virtual)
+            scheduler.PrintSummary(std::cout, PluginAPI::SteadyNowNs() - wallStart);
+
+        if (!checkpointFile.empty())
+            Checkpoint::Save(checkpointFile, portMgr, mgr);
+
+        mgr.shutdownAll();
+        portMgr.StopRecording();
+    }
+
+    stats.Close();
+
+    if (auto *m = portMgr.metrics()) {
+        m->StopPeriodicDump();
+        if (metricsPeriodMs >= 0)
+            m->PrintSummary(std::cout);
+    }
+
+    if (auto *p = mgr.profiler(); p && (profile || !traceFile.empty())) {
+        p->PrintSummary(std::cout);
+        if (!traceFile.empty())
+            p->ExportChromeTrace(traceFile);
+    }
 
     mgr.unloadAll();
 
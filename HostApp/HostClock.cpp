@@ -0,0 +1,56 @@
+#include "HostClock.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include "../include/PluginAPI.hpp"
+
+using PluginAPI::SteadyNowNs;
+
+HostClock::HostClock(Mode mode)
+    : mode_(mode), virtualNs_(SteadyNowNs()) {}
+
+std::uint64_t HostClock::Now() const {
+    if (mode_ == Mode::Virtual)
+        return virtualNs_.load(std::memory_order_relaxed);
+    return SteadyNowNs();
+}
+
+void HostClock::SleepUntil(std::uint64_t ns) {
+    if (mode_ == Mode::Virtual) {
+        if (ns > virtualNs_.load(std::memory_order_relaxed))
+            virtualNs_.store(ns, std::memory_order_relaxed);
+        return;
+    }
+    const std::uint64_t now = SteadyNowNs();
+    if (ns > now)
+        std::this_thread::sleep_for(std::chrono::nanoseconds(ns - now));
+}
+
+CycleScheduler::CycleScheduler(HostClock &clock, std::uint64_t periodNs)
+    : clock_(clock), periodNs_(periodNs), startNs_(clock.Now()) {}
+
+void CycleScheduler::WaitNext() {
+    const std::uint64_t due = startNs_ + stats_.cycles * periodNs_;
+    ++stats_.cycles;
+    if (periodNs_)
+        clock_.SleepUntil(due);
+
+    // Real clock only: virtual time is never behind a deadline it jumped to
+    const std::uint64_t now = clock_.Now();
+    if (periodNs_ && now > due + periodNs_) {
+        ++stats_.late;
+        stats_.maxLateNs = std::max(stats_.maxLateNs, now - due);
+    }
+    stats_.hostNs = now - startNs_;
+}
+
+void CycleScheduler::PrintSummary(std::ostream &os, std::uint64_t wallNs) const {
+    const bool virt = clock_.mode() == HostClock::Mode::Virtual;
+    os << "[CycleScheduler] " << stats_.cycles << " cycles, period " << periodNs_ / 1000 << " us, "
+       << (virt ? "virtual" : "real") << " clock: " << stats_.hostNs / 1000000 << " ms host time in "
+       << wallNs / 1000000 << " ms wall";
+    if (stats_.late)
+        os << ", " << stats_.late << " late (max " << stats_.maxLateNs / 1000 << " us)";
+    os << "\n";
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+
+// Time source behind IHostServices::Now().
+//
+//  - Real:    the steady clock; SleepUntil() sleeps.
+//  - Virtual: starts at the steady clock's current value and only moves
+//             when the host calls SleepUntil(), which jumps to the deadline
+//             at once. Time spent computing is not counted.
+//
+// Both modes use the steady clock's epoch, so their values are comparable.
+// Virtual time lives in this process: it cannot drive isolated runners.
+class HostClock {
+    public:
+        enum class Mode {
+            Real,
+            Virtual
+        };
+
+        explicit HostClock(Mode mode = Mode::Real);
+
+        Mode mode() const {
+            return mode_;
+        }
+        std::uint64_t Now() const;
+        void          SleepUntil(std::uint64_t ns);
+
+    private:
+        Mode                       mode_;
+        std::atomic<std::uint64_t> virtualNs_; // Mode::Virtual; any thread may read
+};
+
+// Host cycles on a fixed period: cycle k is due at start + k * period.
+// Against a real clock a late cycle runs immediately and the next ones keep
+// their slots (catching up back to back), so the cycles and the Now() each
+// one sees are those of the virtual schedule. Period 0 runs back to back.
+class CycleScheduler {
+    public:
+        CycleScheduler(HostClock &clock, std::uint64_t periodNs);
+
+        // Waits until the next cycle is due
+        void WaitNext();
+
+        struct Stats {
+                std::uint64_t cycles    = 0;
+                std::uint64_t late      = 0; // started after the next slot (real clock)
+                std::uint64_t maxLateNs = 0;
+                std::uint64_t hostNs    = 0; // host time from start to the last cycle
+        };
+        const Stats &stats() const {
+            return stats_;
+        }
+
+        void PrintSummary(std::ostream &os, std::uint64_t wallNs) const;
+
+    private:
+        HostClock    &clock_;
+        std::uint64_t periodNs_;
+        std::uint64_t startNs_;
+        Stats         stats_;
+};
@@ -0,0 +1,311 @@
+#include "HostLogger.hpp"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+using PluginAPI::LogArg;
+using PluginAPI::LogLevel;
+
+namespace {
+    constexpr std::uint64_t kWindowNs = 1000000000ULL; // rate-limit window
+    constexpr std::uint32_t kMaxSites = 1024;
+    constexpr std::uint32_t kPad      = 0; // Record::site of the filler before a wrap
+
+    constexpr std::size_t Align8(std::size_t n) {
+        return (n + 7) & ~std::size_t(7);
+    }
+
+    struct Site {
+            LogLevel                   level        = LogLevel::Info;
+            std::uint32_t              maxPerSecond = 0;
+            std::string                format; // copied: the addon may be unloaded first
+            std::atomic<std::uint64_t> windowNs{0};
+            std::atomic<std::uint32_t> inWindow{0};
+            std::atomic<std::uint64_t> suppressed{0}; // not reported yet
+    };
+
+    struct SiteTable {
+            std::mutex                 mutex; // registration
+            std::atomic<std::uint32_t> count{1}; // id 0 = none
+            std::atomic<LogLevel>      minLevel{LogLevel::Info};
+            Site                       sites[kMaxSites];
+    };
+
+    // Refreshed by the log thread on every pass (about 1 ms), 0 while no log
+    // thread runs; precise enough for one-second windows and much cheaper to
+    // read than the clock
+    std::atomic<std::uint64_t> gCoarseNs{0};
+
+    SiteTable &Table() {
+        static SiteTable table;
+        return table;
+    }
+
+    // Level filter and per-site rate limit. The window reset races with
+    // concurrent callers of the same site; that costs at most a few records.
+    bool Admit(Site &site) {
+        if (site.level < Table().minLevel.load(std::memory_order_relaxed))
+            return false;
+        if (!site.maxPerSecond)
+            return true;
+        std::uint64_t now = gCoarseNs.load(std::memory_order_relaxed);
+        if (!now)
+            now = PluginAPI::SteadyNowNs();
+        if (now - site.windowNs.load(std::memory_order_relaxed) >= kWindowNs) {
+            site.windowNs.store(now, std::memory_order_relaxed);
+            site.inWindow.store(0, std::memory_order_relaxed);
+        }
+        if (site.inWindow.fetch_add(1, std::memory_order_relaxed) < site.maxPerSecond)
+            return true;
+        site.suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // [Record][8-byte value per argument; a string's value is its length,
+    // followed by its bytes padded to 8]
+    struct Record {
+            std::uint32_t site;  // kPad: skip `bytes` to the end of the ring
+            std::uint32_t bytes; // whole record, a multiple of 8
+            std::uint8_t  count;
+            std::uint8_t  types[PluginAPI::kMaxLogArgs];
+    };
+    constexpr std::size_t kRecordBytes = Align8(sizeof(Record));
+
+    std::size_t EncodedBytes(const LogArg *args, std::size_t count) {
+        std::size_t bytes = kRecordBytes + count * sizeof(std::uint64_t);
+        for (std::size_t i = 0; i < count; ++i) {
+            if (args[i].type == LogArg::Type::Str)
+                bytes += Align8(args[i].len);
+        }
+        return bytes;
+    }
+
+    void Encode(std::uint8_t *at, std::uint32_t site, std::size_t bytes, const LogArg *args, std::size_t count) {
+        auto *rec  = reinterpret_cast<Record *>(at);
+        rec->site  = site;
+        rec->bytes = static_cast<std::uint32_t>(bytes);
+        rec->count = static_cast<std::uint8_t>(count);
+        at += kRecordBytes;
+        for (std::size_t i = 0; i < count; ++i) {
+            const LogArg &a = args[i];
+            rec->types[i]   = static_cast<std::uint8_t>(a.type);
+            if (a.type == LogArg::Type::Str) {
+                const std::uint64_t len = a.len;
+                std::memcpy(at, &len, sizeof(len));
+                std::memcpy(at + sizeof(len), a.s, a.len);
+                at += sizeof(len) + Align8(a.len);
+            } else {
+                std::memcpy(at, &a.u, sizeof(a.u));
+                at += sizeof(a.u);
+            }
+        }
+    }
+
+    // Appends the formatted record plus a newline to `out`
+    void Decode(const std::uint8_t *at, std::string &out) {
+        const auto *rec = reinterpret_cast<const Record *>(at);
+        LogArg      args[PluginAPI::kMaxLogArgs];
+        at += kRecordBytes;
+        for (std::size_t i = 0; i < rec->count; ++i) {
+            args[i].type = static_cast<LogArg::Type>(rec->types[i]);
+            std::memcpy(&args[i].u, at, sizeof(args[i].u));
+            at += sizeof(std::uint64_t);
+            if (args[i].type == LogArg::Type::Str) {
+                args[i].len = static_cast<std::uint32_t>(args[i].u);
+                args[i].s   = reinterpret_cast<const char *>(at);
+                at += Align8(args[i].len);
+            }
+        }
+        PluginAPI::FormatLog(out, Table().sites[rec->site].format.c_str(), args, rec->count);
+        out += '\n';
+    }
+
+    void Write(const std::string &text, std::FILE *to) {
+        if (text.empty())
+            return;
+        std::fwrite(text.data(), 1, text.size(), to);
+        std::fflush(to);
+    }
+
+    std::atomic<std::uint64_t> gSerial{0};
+
+    struct ThreadSlot {
+            std::uint64_t serial = 0;
+            void         *ring   = nullptr;
+    };
+    thread_local ThreadSlot tRing;
+} // namespace
+
+// Single producer (the owning thread), single consumer (the log thread).
+// Positions only grow; the offset is position & mask.
+struct HostLogger::Ring {
+        // Zeroed, so its pages fault in here rather than in a hot Log()
+        explicit Ring(std::size_t bytes)
+            : buf(new std::uint8_t[bytes]()), size(bytes) {}
+
+        std::unique_ptr<std::uint8_t[]> buf;
+        const std::size_t               size;
+
+        alignas(64) std::atomic<std::uint64_t> tail{0}; // producer
+        std::uint64_t                          headSeen = 0; // producer's last look at head
+        alignas(64) std::atomic<std::uint64_t> head{0}; // consumer
+        std::atomic<std::uint64_t>             dropped{0};
+};
+
+HostLogger::HostLogger(std::size_t ringBytes, std::FILE *out, std::FILE *err)
+    : ringBytes_(std::bit_ceil(std::max<std::size_t>(ringBytes, 4096))), out_(out), err_(err),
+      serial_(gSerial.fetch_add(1, std::memory_order_relaxed) + 1),
+      thread_([this] { Loop(); }) {}
+
+HostLogger::~HostLogger() {
+    stop_.store(true, std::memory_order_release);
+    wake_.notify_one();
+    thread_.join();
+}
+
+std::uint32_t HostLogger::RegisterSite(LogLevel level, const char *format, std::uint32_t maxPerSecond) {
+    auto                       &t = Table();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    const std::uint32_t         id = t.count.load(std::memory_order_relaxed);
+    if (id == kMaxSites)
+        return 0;
+    Site &s        = t.sites[id];
+    s.level        = level;
+    s.maxPerSecond = maxPerSecond;
+    s.format       = format ? format : "";
+    t.count.store(id + 1, std::memory_order_release);
+    return id;
+}
+
+void HostLogger::SetMinLevel(LogLevel level) {
+    Table().minLevel.store(level, std::memory_order_relaxed);
+}
+
+void HostLogger::WriteNow(std::uint32_t site, const LogArg *args, std::size_t count) {
+    if (!site || site >= kMaxSites || count > PluginAPI::kMaxLogArgs)
+        return;
+    Site &s = Table().sites[site];
+    if (!Admit(s))
+        return;
+    std::string line;
+    PluginAPI::FormatLog(line, s.format.c_str(), args, count);
+    line += '\n';
+    Write(line, s.level >= LogLevel::Warn ? stderr : stdout);
+}
+
+HostLogger::Ring *HostLogger::ThreadRing() {
+    if (tRing.serial == serial_)
+        return static_cast<Ring *>(tRing.ring);
+    std::lock_guard<std::mutex> lock(mutex_);
+    rings_.push_back(std::make_unique<Ring>(ringBytes_));
+    tRing = ThreadSlot{serial_, rings_.back().get()};
+    return rings_.back().get();
+}
+
+void HostLogger::Log(std::uint32_t site, const LogArg *args, std::size_t count) {
+    if (!site || site >= kMaxSites || count > PluginAPI::kMaxLogArgs)
+        return;
+    if (!Admit(Table().sites[site]))
+        return;
+
+    Ring             &r     = *ThreadRing();
+    const std::size_t bytes = EncodedBytes(args, count);
+    std::uint64_t     tail  = r.tail.load(std::memory_order_relaxed);
+    const std::size_t off   = tail & (r.size - 1);
+    const std::size_t pad   = off + bytes > r.size ? r.size - off : 0;
+    const std::uint64_t end = tail + pad + bytes;
+    if (end - r.headSeen > r.size)
+        r.headSeen = r.head.load(std::memory_order_acquire); // only look when it seems full
+    if (bytes > r.size / 2 || end - r.headSeen > r.size) {
+        r.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    if (pad) {
+        auto *filler  = reinterpret_cast<Record *>(r.buf.get() + off);
+        filler->site  = kPad;
+        filler->bytes = static_cast<std::uint32_t>(pad);
+        tail += pad;
+    }
+    Encode(r.buf.get() + (tail & (r.size - 1)), site, bytes, args, count);
+    r.tail.store(tail + bytes, std::memory_order_release);
+}
+
+bool HostLogger::Drain() {
+    std::vector<Ring *> rings;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto &r : rings_)
+            rings.push_back(r.get());
+    }
+
+    std::string   out, err;
+    std::uint64_t written = 0;
+    for (Ring *r : rings) {
+        std::uint64_t       head = r->head.load(std::memory_order_relaxed);
+        const std::uint64_t tail = r->tail.load(std::memory_order_acquire);
+        while (head != tail) {
+            const std::uint8_t *at  = r->buf.get() + (head & (r->size - 1));
+            const auto         *rec = reinterpret_cast<const Record *>(at);
+            if (rec->site != kPad) {
+                const bool warn = Table().sites[rec->site].level >= LogLevel::Warn;
+                Decode(at, warn ? err : out);
+                ++written;
+            }
+            head += rec->bytes;
+        }
+        r->head.store(head, std::memory_order_release);
+
+        if (const std::uint64_t n = r->dropped.exchange(0, std::memory_order_relaxed)) {
+            dropped_.fetch_add(n, std::memory_order_relaxed);
+            err += "[HostLogger] " + std::to_string(n) + " records dropped, log ring full\n";
+        }
+    }
+
+    auto               &t     = Table();
+    const std::uint32_t sites = t.count.load(std::memory_order_acquire);
+    for (std::uint32_t id = 1; id < sites; ++id) {
+        if (const std::uint64_t n = t.sites[id].suppressed.exchange(0, std::memory_order_relaxed)) {
+            suppressed_.fetch_add(n, std::memory_order_relaxed);
+            err += "[HostLogger] " + std::to_string(n) + " records over the rate limit: \"" + t.sites[id].format + "\"\n";
+        }
+    }
+
+    Write(out, out_);
+    Write(err, err_);
+    written_.fetch_add(written, std::memory_order_relaxed);
+    return written != 0;
+}
+
+void HostLogger::Loop() {
+    while (!stop_.load(std::memory_order_acquire)) {
+        gCoarseNs.store(PluginAPI::SteadyNowNs(), std::memory_order_relaxed);
+        const bool busy = Drain();
+        passes_.fetch_add(1, std::memory_order_release);
+        if (!busy) {
+            std::unique_lock<std::mutex> lock(waitMutex_);
+            wake_.wait_for(lock, std::chrono::milliseconds(1));
+        }
+    }
+    gCoarseNs.store(0, std::memory_order_relaxed);
+    Drain();
+    passes_.fetch_add(1, std::memory_order_release);
+}
+
+void HostLogger::Flush() {
+    // A whole pass that started after this call
+    const std::uint64_t target = passes_.load(std::memory_order_acquire) + 2;
+    wake_.notify_one();
+    while (passes_.load(std::memory_order_acquire) < target && !stop_.load(std::memory_order_acquire))
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+}
+
+HostLogger::Stats HostLogger::stats() const {
+    Stats s;
+    s.written    = written_.load(std::memory_order_relaxed);
+    s.dropped    = dropped_.load(std::memory_order_relaxed);
+    s.suppressed = suppressed_.load(std::memory_order_relaxed);
+    return s;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../include/PluginAPI.hpp"
+
+// Asynchronous log behind IHostServices::LogRecord() (see PLUGIN_LOG).
+//
+// Call sites register once in a process-wide table (format, level, rate
+// limit); their ids stay valid across HostLogger instances and in forked
+// runners. Log() copies the site id and the binary arguments into a ring
+// owned by the calling thread (single producer, no locks) and
+// returns; one background thread formats the rings and writes the text,
+// Info and below to `out` (stdout), Warn and Error to `err` (stderr). A
+// full ring drops the record, a site over its per-second limit drops it
+// too; both are counted and reported by the log thread.
+//
+// WriteNow() formats on the calling thread instead, for hosts or runner
+// processes without a log thread.
+class HostLogger {
+    public:
+        static constexpr std::size_t kDefaultRingBytes = std::size_t(64) << 10; // per thread
+
+        explicit HostLogger(std::size_t ringBytes = kDefaultRingBytes, std::FILE *out = stdout,
+            std::FILE *err = stderr);
+        ~HostLogger(); // writes whatever is queued, then stops the thread
+
+        HostLogger(const HostLogger &)            = delete;
+        HostLogger &operator=(const HostLogger &) = delete;
+
+        // Process-wide call-site table; 0 = table full (the caller prints synchronously)
+        static std::uint32_t RegisterSite(PluginAPI::LogLevel level, const char *format, std::uint32_t maxPerSecond);
+        // Records below this level are dropped at the call site
+        static void SetMinLevel(PluginAPI::LogLevel level);
+        static void WriteNow(std::uint32_t site, const PluginAPI::LogArg *args, std::size_t count);
+
+        void Log(std::uint32_t site, const PluginAPI::LogArg *args, std::size_t count);
+
+        // Returns once everything logged before the call is written
+        void Flush();
+
+        struct Stats {
+                std::uint64_t written    = 0;
+                std::uint64_t dropped    = 0; // ring full
+                std::uint64_t suppressed = 0; // over a site's rate limit
+        };
+        Stats stats() const;
+
+    private:
+        struct Ring;
+
+        Ring *ThreadRing();
+        bool  Drain(); // one pass over every ring; true if anything was written
+        void  Loop();
+
+        const std::size_t   ringBytes_;
+        std::FILE *const    out_;
+        std::FILE *const    err_;
+        const std::uint64_t serial_; // tells this logger's thread_local rings from a previous one's
+
+        std::mutex                         mutex_; // guards rings_
+        std::vector<std::unique_ptr<Ring>> rings_;
+
+        std::mutex                 waitMutex_;
+        std::condition_variable    wake_;
+        std::atomic<bool>          stop_{false};
+        std::atomic<std::uint64_t> passes_{0};
+        std::atomic<std::uint64_t> written_{0};
+        std::atomic<std::uint64_t> dropped_{0};
+        std::atomic<std::uint64_t> suppressed_{0};
+        std::thread                thread_; // last: starts in the constructor
+};
@@ -0,0 +1,67 @@
+#include "JoinStage.hpp"
+#include <algorithm>
+#include <iostream>
+#include "AddOnManager.hpp"
+
+using PluginAPI::JoinPolicy;
+
+bool JoinStage::Resolve(const std::string &addon, const PluginAPI::JoinSpec &spec, IHostPortServices &svc) {
+    inputs_.clear();
+    views_.clear();
+    policy_      = spec.policy;
+    toleranceNs_ = spec.toleranceNs;
+
+    for (std::size_t i = 0; i < spec.count; ++i) {
+        void *h = svc.ResolveInput(addon, spec.ports[i]);
+        if (!h) {
+            std::cerr << "[JoinStage] " << addon << ": no input port '" << spec.ports[i] << "' to join\n";
+            inputs_.clear();
+            return false;
+        }
+        inputs_.push_back(Input{h, 0});
+    }
+    views_.resize(inputs_.size());
+    return !inputs_.empty();
+}
+
+bool JoinStage::Match(IHostPortServices &svc) {
+    bool          allNew  = true;
+    bool          anyNew  = false;
+    bool          sameSeq = true;
+    std::uint64_t seq     = 0;
+    std::uint64_t minNs   = UINT64_MAX;
+    std::uint64_t maxNs   = 0;
+
+    for (std::size_t i = 0; i < inputs_.size(); ++i) {
+        auto &v = views_[i];
+        if (!svc.PeekInput(inputs_[i].handle, v) || v.header.sequence == 0) {
+            ++waited_; // an input was never written
+            return false;
+        }
+        const bool fresh = v.header.sequence > inputs_[i].consumed;
+        allNew           = allNew && fresh;
+        anyNew           = anyNew || fresh;
+        sameSeq          = sameSeq && (i == 0 || v.header.sequence == seq);
+        seq              = v.header.sequence;
+        minNs            = std::min(minNs, v.header.writeNs);
+        maxNs            = std::max(maxNs, v.header.writeNs);
+    }
+
+    bool ok = false;
+    switch (policy_) {
+    case JoinPolicy::ExactSequence: ok = allNew && sameSeq; break;
+    case JoinPolicy::ApproximateTime: ok = allNew && maxNs - minNs <= toleranceNs_; break;
+    case JoinPolicy::LatestOfEach: ok = anyNew; break;
+    }
+    if (!ok) {
+        ++waited_;
+        return false;
+    }
+
+    for (std::size_t i = 0; i < inputs_.size(); ++i) {
+        inputs_[i].consumed = views_[i].header.sequence;
+        svc.ConsumeInput(inputs_[i].handle);
+    }
+    ++matched_;
+    return true;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../include/PluginAPI.hpp"
+
+class IHostPortServices;
+
+// Host side of PluginAPI::JoinSpec for one addon: checks its inputs once per
+// cycle and, when they match the policy, hands out one zero-copy view per
+// input. Every addon that joins the same kind of inputs gets the same
+// matching logic, next to the transports.
+class JoinStage {
+    public:
+        // Resolves the spec's port names against `addon`'s inputs; false (and
+        // a message) if one is unknown.
+        bool Resolve(const std::string &addon, const PluginAPI::JoinSpec &spec, IHostPortServices &svc);
+
+        // True (and views() filled, inputs consumed) when the inputs match
+        bool Match(IHostPortServices &svc);
+
+        const PluginAPI::JoinView *views() const {
+            return views_.data();
+        }
+        std::size_t size() const {
+            return views_.size();
+        }
+
+        PluginAPI::JoinPolicy policy() const {
+            return policy_;
+        }
+        std::uint64_t matched() const {
+            return matched_;
+        }
+        std::uint64_t waited() const {
+            return waited_;
+        }
+
+    private:
+        struct Input {
+                void         *handle   = nullptr; // IHostPortServices::ResolveInput()
+                std::uint64_t consumed = 0;       // sequence at the last match
+        };
+
+        std::vector<Input>               inputs_;
+        std::vector<PluginAPI::JoinView> views_;
+        PluginAPI::JoinPolicy            policy_      = PluginAPI::JoinPolicy::LatestOfEach;
+        std::uint64_t                    toleranceNs_ = 0;
+        std::uint64_t                    matched_     = 0;
+        std::uint64_t                    waited_      = 0; // cycles without a match
+};
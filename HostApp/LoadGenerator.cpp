@@ -0,0 +1,191 @@
+#include "LoadGenerator.hpp"
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include "AddOnManager.hpp"
+#include "PortManager.hpp"
+
+namespace fs = std::filesystem;
+
+bool LoadGenerator::ParseSpec(const std::string &text, Spec &out) {
+    Spec s;
+    if (text.empty() || text == "default") {
+        out = s;
+        return true;
+    }
+
+    std::stringstream ss(text);
+    for (std::string item; std::getline(ss, item, ',');) {
+        const auto eq = item.find('=');
+        if (eq == std::string::npos) {
+            std::cerr << "[LoadGenerator] Expected key=value, got '" << item << "'\n";
+            return false;
+        }
+        const std::string key   = item.substr(0, eq);
+        const std::string value = item.substr(eq + 1);
+
+        if (key == "policy") {
+            if (value == "buffered")
+                s.policy = PluginAPI::DataAccessPolicy::Buffered;
+            else if (value == "direct")
+                s.policy = PluginAPI::DataAccessPolicy::Direct;
+            else {
+                std::cerr << "[LoadGenerator] Unknown policy '" << value << "'\n";
+                return false;
+            }
+            continue;
+        }
+
+        if (key == "join") {
+            s.join = value != "off";
+            if (value == "exact")
+                s.joinPolicy = PluginAPI::JoinPolicy::ExactSequence;
+            else if (value == "approx")
+                s.joinPolicy = PluginAPI::JoinPolicy::ApproximateTime;
+            else if (value == "latest")
+                s.joinPolicy = PluginAPI::JoinPolicy::LatestOfEach;
+            else if (value != "off") {
+                std::cerr << "[LoadGenerator] Unknown join policy '" << value << "'\n";
+                return false;
+            }
+            continue;
+        }
+
+        std::uint32_t v = 0;
+        try {
+            v = static_cast<std::uint32_t>(std::stoul(value));
+        } catch (...) {
+            std::cerr << "[LoadGenerator] Bad value for " << key << ": '" << value << "'\n";
+            return false;
+        }
+
+        if (key == "producers")
+            s.producers = v;
+        else if (key == "layers")
+            s.layers = v;
+        else if (key == "width")
+            s.width = v;
+        else if (key == "sinks")
+            s.sinks = v;
+        else if (key == "fanin")
+            s.fanIn = v;
+        else if (key == "fanout")
+            s.fanOut = v;
+        else if (key == "bytes")
+            s.payloadBytes = v;
+        else if (key == "every")
+            s.emitEvery = v;
+        else if (key == "work")
+            s.workIterations = v;
+        else if (key == "tolerance")
+            s.toleranceNs = v;
+        else if (key == "crash")
+            s.crashAtTick = v;
+        else {
+            std::cerr << "[LoadGenerator] Unknown key '" << key << "'\n";
+            return false;
+        }
+    }
+
+    if (s.producers == 0 || s.fanIn == 0 || s.fanOut == 0 || s.payloadBytes == 0 ||
+        (s.layers > 0 && s.width == 0)) {
+        std::cerr << "[LoadGenerator] producers, fanin, fanout, bytes and width must be > 0\n";
+        return false;
+    }
+    out = s;
+    return true;
+}
+
+fs::path LoadGenerator::DefaultLibrary(const fs::path &binDir) {
+#ifdef _WIN32
+    return binDir / "synth" / "SynthAddon.dll";
+#else
+    return binDir / "synth" / "libSynthAddon.so";
+#endif
+}
+
+bool LoadGenerator::Build(const Spec &spec, const fs::path &library,
+    AddOnManager &addons, PortManager &ports) {
+    struct Layer {
+            std::vector<std::string> names;
+            std::uint32_t            outputs = 0;
+    };
+    std::vector<Layer> layers;
+
+    // Fault injection (crash=<tick>) hits one node with both inputs and outputs
+    const std::string crashNode = spec.layers > 0 ? "Synth.L0.0" : "Synth.P0";
+
+    auto addLayer = [&](const std::string &prefix, std::uint32_t count, SynthConfig cfg) {
+        Layer layer;
+        layer.outputs = cfg.outputs;
+        for (std::uint32_t i = 0; i < count; ++i) {
+            std::string name = prefix + std::to_string(i);
+            SynthConfig node = cfg;
+            node.abortAtTick = name == crashNode ? spec.crashAtTick : 0;
+            if (!addons.loadInstance(library, name, kSynthFactorySymbol, &node))
+                return false;
+
+            AddOnManager::discoverPorts(addons.addons().back(), ports);
+            layer.names.push_back(std::move(name));
+        }
+        layers.push_back(std::move(layer));
+        return true;
+    };
+
+    SynthConfig base;
+    base.policy          = spec.policy;
+    base.payloadBytes    = spec.payloadBytes;
+    base.emitEvery       = spec.emitEvery;
+    base.workIterations  = spec.workIterations;
+    base.join            = spec.join;
+    base.joinPolicy      = spec.joinPolicy;
+    base.joinToleranceNs = spec.toleranceNs;
+
+    SynthConfig producer = base;
+    producer.role        = SynthConfig::Role::Producer;
+    producer.outputs     = spec.fanOut;
+
+    SynthConfig filter = base;
+    filter.role        = SynthConfig::Role::Filter;
+    filter.inputs      = spec.fanIn;
+    filter.outputs     = spec.fanOut;
+
+    SynthConfig sink = base;
+    sink.role        = SynthConfig::Role::Sink;
+    sink.inputs      = spec.fanIn;
+    sink.outputs     = 0;
+
+    if (!addLayer("Synth.P", spec.producers, producer))
+        return false;
+    for (std::uint32_t l = 0; l < spec.layers; ++l) {
+        if (!addLayer("Synth.L" + std::to_string(l) + ".", spec.width, filter))
+            return false;
+    }
+    if (!addLayer("Synth.S", spec.sinks, sink))
+        return false;
+
+    // Wire every layer to the one before it
+    std::size_t links = 0;
+    for (std::size_t l = 1; l < layers.size(); ++l) {
+        const Layer &prev = layers[l - 1];
+        const Layer &cur  = layers[l];
+        const auto   n    = prev.names.size();
+        for (std::size_t k = 0; k < cur.names.size(); ++k) {
+            for (std::uint32_t j = 0; j < spec.fanIn; ++j) {
+                const auto &from = prev.names[(k * spec.fanIn + j) % n];
+                const auto  out  = (k + j) % prev.outputs;
+                if (!ports.Connect(from, "out" + std::to_string(out),
+                        cur.names[k], "in" + std::to_string(j)))
+                    return false;
+                ++links;
+            }
+        }
+    }
+
+    std::cout << "[LoadGenerator] Built " << spec.Addons() << " synthetic addons, "
+              << links << " connections (" << spec.payloadBytes << " B payloads, "
+              << PluginAPI::to_string(spec.policy)
+              << (spec.join ? std::string(", join ") + PluginAPI::to_string(spec.joinPolicy) : std::string())
+              << ")\n";
+    return true;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include "../include/SynthConfig.hpp"
+
+class AddOnManager;
+class PortManager;
+
+// Builds large layered graphs of SynthAddon instances for stress runs:
+//
+//   producers -> layers x width filters -> sinks
+//
+// Input j of node k in one layer is fed by output (k + j) % fanOut of node
+// (k * fanIn + j) % n of the layer before, so every node has `fanIn`
+// providers and outputs are shared by roughly fanIn * n / (prev * fanOut)
+// receivers each.
+class LoadGenerator {
+    public:
+        struct Spec {
+                std::uint32_t               producers      = 16;
+                std::uint32_t               layers         = 4;
+                std::uint32_t               width          = 64;
+                std::uint32_t               sinks          = 16;
+                std::uint32_t               fanIn          = 2;
+                std::uint32_t               fanOut         = 2;
+                std::uint32_t               payloadBytes   = 256;
+                std::uint32_t               emitEvery      = 1;
+                std::uint32_t               workIterations = 100;
+                PluginAPI::DataAccessPolicy policy         = PluginAPI::DataAccessPolicy::Buffered;
+                bool                        join           = false; // host-side joins for filters/sinks
+                PluginAPI::JoinPolicy       joinPolicy     = PluginAPI::JoinPolicy::LatestOfEach;
+                std::uint32_t               toleranceNs    = 0;     // join=approx
+                std::uint32_t               crashAtTick    = 0;     // Synth.L0.0 (or Synth.P0) aborts then
+
+                std::uint32_t Addons() const {
+                    return producers + layers * width + sinks;
+                }
+        };
+
+        // "producers=16,layers=4,width=64,sinks=16,fanin=2,fanout=2,
+        //  bytes=256,every=1,work=100,policy=buffered|direct,
+        //  join=off|exact|approx|latest,tolerance=<ns>,crash=<tick>"
+        // Keys may be omitted; "default" keeps every default.
+        static bool ParseSpec(const std::string &text, Spec &out);
+
+        // bin/synth/(lib)SynthAddon.(so|dll), kept out of bin/ so scanAndLoad()
+        // does not pick it up as a regular addon
+        static std::filesystem::path DefaultLibrary(const std::filesystem::path &binDir);
+
+        // Instantiates the graph into `addons`, registers its ports and wires
+        // the connections. Instance names are "Synth.P<i>", "Synth.L<l>.<i>"
+        // and "Synth.S<i>".
+        static bool Build(const Spec &spec, const std::filesystem::path &library,
+            AddOnManager &addons, PortManager &ports);
+};
@@ -0,0 +1,181 @@
+#pragma once
+#include <filesystem>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+// Thin RAII wrapper around a memory-mapped file (mmap / MapViewOfFile).
+// ReadOnly maps an existing file; ReadWrite creates/truncates it and can be
+// grown in place with resize().
+class MappedFile {
+    public:
+        enum class Mode {
+            ReadOnly,
+            ReadWrite
+        };
+
+        MappedFile() = default;
+        ~MappedFile() {
+            close();
+        }
+
+        MappedFile(const MappedFile &)            = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        bool open(const std::filesystem::path &p, Mode mode, std::size_t initialSize = 0) {
+            close();
+            path_ = p;
+            mode_ = mode;
+
+#ifdef _WIN32
+            const bool rw = mode == Mode::ReadWrite;
+            file_         = CreateFileA(p.string().c_str(),
+                        rw ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+                        FILE_SHARE_READ, nullptr,
+                        rw ? CREATE_ALWAYS : OPEN_EXISTING,
+                        FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file_ == INVALID_HANDLE_VALUE) {
+                file_ = nullptr;
+                return false;
+            }
+            if (!rw) {
+                LARGE_INTEGER sz{};
+                GetFileSizeEx(file_, &sz);
+                initialSize = static_cast<std::size_t>(sz.QuadPart);
+            }
+#else
+            fd_ = mode == Mode::ReadWrite
+                      ? ::open(p.string().c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644)
+                      : ::open(p.string().c_str(), O_RDONLY);
+            if (fd_ < 0)
+                return false;
+            if (mode == Mode::ReadOnly) {
+                struct stat st{};
+                if (::fstat(fd_, &st) != 0) {
+                    close();
+                    return false;
+                }
+                initialSize = static_cast<std::size_t>(st.st_size);
+            }
+#endif
+            if (initialSize == 0)
+                return true; // empty file: valid but nothing mapped yet
+            return mapSize(initialSize);
+        }
+
+        // Grow (or shrink) the file and remap it. Existing contents are kept.
+        bool resize(std::size_t newSize) {
+            if (mode_ != Mode::ReadWrite || !isOpen())
+                return false;
+            unmap();
+            return mapSize(newSize);
+        }
+
+        // Shrink the file to its final length and release the mapping.
+        void close(std::size_t finalSize = static_cast<std::size_t>(-1)) {
+            unmap();
+#ifdef _WIN32
+            if (file_) {
+                if (finalSize != static_cast<std::size_t>(-1) && mode_ == Mode::ReadWrite) {
+                    LARGE_INTEGER li{};
+                    li.QuadPart = static_cast<LONGLONG>(finalSize);
+                    SetFilePointerEx(file_, li, nullptr, FILE_BEGIN);
+                    SetEndOfFile(file_);
+                }
+                CloseHandle(file_);
+                file_ = nullptr;
+            }
+#else
+            if (fd_ >= 0) {
+                if (finalSize != static_cast<std::size_t>(-1) && mode_ == Mode::ReadWrite)
+                    (void)::ftruncate(fd_, static_cast<off_t>(finalSize));
+                ::close(fd_);
+                fd_ = -1;
+            }
+#endif
+        }
+
+        bool isOpen() const {
+#ifdef _WIN32
+            return file_ != nullptr;
+#else
+            return fd_ >= 0;
+#endif
+        }
+
+        std::uint8_t *data() {
+            return static_cast<std::uint8_t *>(data_);
+        }
+        const std::uint8_t *data() const {
+            return static_cast<const std::uint8_t *>(data_);
+        }
+        std::size_t size() const {
+            return size_;
+        }
+        const std::filesystem::path &path() const {
+            return path_;
+        }
+
+    private:
+        bool mapSize(std::size_t bytes) {
+            const bool rw = mode_ == Mode::ReadWrite;
+#ifdef _WIN32
+            LARGE_INTEGER li{};
+            li.QuadPart = static_cast<LONGLONG>(bytes);
+            mapping_    = CreateFileMappingA(file_, nullptr, rw ? PAGE_READWRITE : PAGE_READONLY,
+                   li.HighPart, li.LowPart, nullptr);
+            if (!mapping_)
+                return false;
+            data_ = MapViewOfFile(mapping_, rw ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, bytes);
+            if (!data_) {
+                CloseHandle(mapping_);
+                mapping_ = nullptr;
+                return false;
+            }
+#else
+            if (rw && ::ftruncate(fd_, static_cast<off_t>(bytes)) != 0)
+                return false;
+            void *p = ::mmap(nullptr, bytes, rw ? (PROT_READ | PROT_WRITE) : PROT_READ,
+                MAP_SHARED, fd_, 0);
+            if (p == MAP_FAILED)
+                return false;
+            data_ = p;
+#endif
+            size_ = bytes;
+            return true;
+        }
+
+        void unmap() {
+            if (!data_)
+                return;
+#ifdef _WIN32
+            UnmapViewOfFile(data_);
+            CloseHandle(mapping_);
+            mapping_ = nullptr;
+#else
+            ::munmap(data_, size_);
+#endif
+            data_ = nullptr;
+            size_ = 0;
+        }
+
+        std::filesystem::path path_;
+        Mode                  mode_ = Mode::ReadOnly;
+        void                 *data_ = nullptr;
+        std::size_t           size_ = 0;
+#ifdef _WIN32
+        HANDLE file_    = nullptr;
+        HANDLE mapping_ = nullptr;
+#else
+        int fd_ = -1;
+#endif
+};
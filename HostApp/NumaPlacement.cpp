@@ -0,0 +1,183 @@
+#include "NumaPlacement.hpp"
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include "AddOnManager.hpp"
+#include "NumaTopology.hpp"
+#include "PortManager.hpp"
+
+namespace {
+    constexpr std::size_t kNone = static_cast<std::size_t>(-1);
+
+    // What one connection moves per cycle, every addon running once
+    std::uint64_t CycleBytes(const PortManager::Connection &c, const PortManager::PortInfo &prov) {
+        const std::uint64_t bytes = prov.desc.PayloadSize;
+        if (c.policy.mode == DeliveryPolicy::Mode::EveryNth)
+            return bytes / static_cast<std::uint64_t>(c.policy.value);
+        return bytes;
+    }
+
+    std::size_t Root(std::vector<std::size_t> &parent, std::size_t x) {
+        while (parent[x] != x)
+            x = parent[x] = parent[parent[x]];
+        return x;
+    }
+} // namespace
+
+NumaPlacement::Report NumaPlacement::Run(AddOnManager &addons, PortManager &ports, const NumaTopology &topo) {
+    Report      rep;
+    auto       &list     = addons.addons();
+    RunnerPool *runners  = addons.runners();
+    const auto  n        = list.size();
+    const auto  contexts = 1 + (runners ? runners->size() : 0);
+
+    std::map<std::string, std::size_t> index;
+    for (std::size_t i = 0; i < n; ++i)
+        index[list[i].name] = i;
+    auto addonOf = [&](const std::string &name) {
+        const auto it = index.find(name);
+        return it == index.end() ? kNone : it->second;
+    };
+    auto contextOf = [&](std::size_t a) {
+        return list[a].runner < 0 ? 0 : 1 + static_cast<std::size_t>(list[a].runner);
+    };
+
+    // ---- traffic: bytes per cycle of every connection and addon ----
+    struct Edge {
+            PortManager::Connection *conn;
+            std::size_t              provider;
+            std::size_t              receiver;
+            std::uint64_t            bytes;
+            bool                     direct;
+    };
+    std::vector<Edge>          edges;
+    std::vector<std::uint64_t> traffic(n, 0);
+    for (auto &c : ports.connections()) {
+        const std::size_t p    = addonOf(c.provider.addon);
+        const std::size_t r    = addonOf(c.receiver.addon);
+        const auto        prov = ports.ports().find(c.provider);
+        if (c.removed || p == kNone || r == kNone || prov == ports.ports().end() || !list[p].enabled ||
+            !list[r].enabled)
+            continue;
+        const std::uint64_t bytes = CycleBytes(c, prov->second);
+        edges.push_back({&c, p, r, bytes, prov->second.desc.AccessPolicy == PluginAPI::DataAccessPolicy::Direct});
+        traffic[p] += bytes;
+        traffic[r] += bytes;
+        rep.totalBytes += bytes;
+    }
+
+    // ---- contexts: merge along the heaviest links, an even share per node ----
+    std::map<std::pair<std::size_t, std::size_t>, std::uint64_t> between;
+    for (const Edge &e : edges) {
+        const std::size_t a = contextOf(e.provider);
+        const std::size_t b = contextOf(e.receiver);
+        if (a != b)
+            between[{std::min(a, b), std::max(a, b)}] += e.bytes;
+    }
+    std::vector<std::pair<std::uint64_t, std::pair<std::size_t, std::size_t>>> heaviest;
+    for (const auto &[pair, bytes] : between)
+        heaviest.push_back({bytes, pair});
+    std::stable_sort(heaviest.begin(), heaviest.end(), [](const auto &x, const auto &y) { return x.first > y.first; });
+
+    const std::size_t        share = (contexts + topo.size() - 1) / topo.size();
+    std::vector<std::size_t> parent(contexts), members(contexts, 1);
+    for (std::size_t c = 0; c < contexts; ++c)
+        parent[c] = c;
+    for (const auto &[bytes, pair] : heaviest) {
+        const std::size_t a = Root(parent, pair.first);
+        const std::size_t b = Root(parent, pair.second);
+        if (a != b && members[a] + members[b] <= share) {
+            parent[b] = a;
+            members[a] += members[b];
+        }
+    }
+
+    std::vector<std::vector<std::size_t>> groups;
+    std::vector<std::size_t>              groupOf(contexts, kNone);
+    for (std::size_t c = 0; c < contexts; ++c) {
+        const std::size_t root = Root(parent, c);
+        if (groupOf[root] == kNone) {
+            groupOf[root] = groups.size();
+            groups.emplace_back();
+        }
+        groups[groupOf[root]].push_back(c);
+    }
+    std::stable_sort(groups.begin(), groups.end(), [](const auto &x, const auto &y) { return x.size() > y.size(); });
+
+    rep.contextNodes.assign(contexts, 0);
+    std::vector<std::size_t> load(topo.size(), 0);
+    for (const auto &g : groups) {
+        const std::size_t node = static_cast<std::size_t>(std::min_element(load.begin(), load.end()) - load.begin());
+        for (std::size_t c : g)
+            rep.contextNodes[c] = node;
+        load[node] += g.size();
+    }
+    rep.addonNodes.resize(n);
+    for (std::size_t i = 0; i < n; ++i)
+        rep.addonNodes[i] = rep.contextNodes[contextOf(i)];
+
+    // ---- threads: the cycle thread here, runners when they fork ----
+    rep.threadsBound = topo.BindThread(rep.contextNodes[0]);
+    for (std::size_t k = 0; runners && k < runners->size(); ++k)
+        runners->SetCpus(k, topo.nodes()[rep.contextNodes[1 + k]].cpus);
+
+    // ---- memory: each transport on the node of its heaviest user ----
+    if (topo.size() > 1) {
+        auto heavier = [&](std::size_t a, std::size_t b) {
+            return traffic[b] > traffic[a] ? b : a;
+        };
+        std::map<PortManager::PortKey, std::size_t> directUser; // provider -> heaviest endpoint
+        for (const Edge &e : edges) {
+            if (e.direct) {
+                auto &user = directUser.try_emplace(e.conn->provider, e.provider).first->second;
+                user       = heavier(e.receiver, user);
+                continue;
+            }
+            const int node = topo.nodes()[rep.addonNodes[heavier(e.receiver, e.provider)]].id;
+            if (ports.MoveToNode(*e.conn, node))
+                ++rep.movedTransports;
+        }
+        for (const auto &[provider, user] : directUser) {
+            if (ports.MoveToNode(provider, topo.nodes()[rep.addonNodes[user]].id))
+                ++rep.movedTransports;
+        }
+    }
+
+    // ---- report: what still crosses nodes ----
+    for (const Edge &e : edges) {
+        const std::size_t from = rep.addonNodes[e.provider];
+        const std::size_t to   = rep.addonNodes[e.receiver];
+        if (from == to)
+            continue;
+        rep.crossNode.push_back({e.conn->provider.addon + "::" + e.conn->provider.port,
+            e.conn->receiver.addon + "::" + e.conn->receiver.port, from, to, e.bytes, topo.distance(from, to)});
+        rep.crossBytes += e.bytes;
+    }
+    std::stable_sort(rep.crossNode.begin(), rep.crossNode.end(),
+        [](const Link &x, const Link &y) { return x.bytes > y.bytes; });
+    return rep;
+}
+
+void NumaPlacement::Print(const Report &r, const NumaTopology &topo, std::ostream &os) {
+    const auto id = [&](std::size_t node) {
+        return topo.nodes()[node].id;
+    };
+    os << "\n[NumaPlacement] Host thread on node " << id(r.contextNodes[0])
+       << (r.threadsBound ? "" : " (affinity not set)") << "\n";
+    for (std::size_t k = 1; k < r.contextNodes.size() && k <= 8; ++k)
+        os << "  runner " << k - 1 << " -> node " << id(r.contextNodes[k]) << "\n";
+    if (r.contextNodes.size() > 9)
+        os << "  ... (+" << r.contextNodes.size() - 9 << " more runners)\n";
+    os << "[NumaPlacement] Moved " << r.movedTransports << " transports\n";
+
+    const double share = r.totalBytes ? 100.0 * static_cast<double>(r.crossBytes) / static_cast<double>(r.totalBytes) : 0;
+    os << "[NumaPlacement] " << r.crossNode.size() << " cross-node links, " << r.crossBytes << " of "
+       << r.totalBytes << " bytes per cycle (" << static_cast<int>(share + 0.5) << "%)\n";
+    for (std::size_t i = 0; i < r.crossNode.size() && i < 8; ++i) {
+        const Link &l = r.crossNode[i];
+        os << "  " << l.provider << " -> " << l.receiver << ": node " << id(l.fromNode) << " -> "
+           << id(l.toNode) << ", " << l.bytes << " B/cycle, distance " << l.distance << "\n";
+    }
+    if (r.crossNode.size() > 8)
+        os << "  ... (+" << r.crossNode.size() - 8 << " more)\n";
+}
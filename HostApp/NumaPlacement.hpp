@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+class AddOnManager;
+class NumaTopology;
+class PortManager;
+
+// NUMA placement pass, after AddOnManager::isolate() and before
+// initializeAll(). The graph runs wherever the OS puts it without it.
+//
+// An addon runs on the thread of its context: the host's cycle thread, or
+// its isolated runner. Each context gets a node:
+//  - every connection weighs the bytes it moves per cycle (payload size,
+//    divided by N for EveryNth),
+//  - contexts joined by the heaviest connections are merged into groups,
+//    up to an even share of the contexts per node,
+//  - groups go, largest first, to the node with the fewest contexts.
+// The calling thread (the cycle thread) and every runner are then bound to
+// the CPUs of their node. Each transport is moved to the node of its
+// heaviest user, the endpoint addon with the most traffic, so the memory of
+// a bandwidth-heavy chain sits where the chain runs. The report lists the
+// connections whose provider and receiver still run on different nodes.
+class NumaPlacement {
+    public:
+        struct Link {
+                std::string   provider; // "Addon::Port"
+                std::string   receiver;
+                std::size_t   fromNode = 0; // indices into NumaTopology::nodes()
+                std::size_t   toNode   = 0;
+                std::uint64_t bytes    = 0; // per cycle
+                int           distance = 0;
+        };
+
+        struct Report {
+                std::vector<std::size_t> contextNodes; // [0] = host thread, [1 + k] = runner k
+                std::vector<std::size_t> addonNodes;   // by addon index
+                std::size_t              movedTransports = 0;
+                std::uint64_t            totalBytes      = 0; // per cycle, every connection
+                std::uint64_t            crossBytes      = 0; // per cycle, over crossNode
+                std::vector<Link>        crossNode;           // heaviest first
+                bool                     threadsBound = true;
+        };
+
+        static Report Run(AddOnManager &addons, PortManager &ports, const NumaTopology &topo);
+        static void   Print(const Report &r, const NumaTopology &topo, std::ostream &os);
+};
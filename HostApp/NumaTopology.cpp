@@ -0,0 +1,148 @@
+#include "NumaTopology.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#ifdef __linux__
+    #include <sched.h>
+#endif
+
+namespace {
+    // Kernel cpulist format: "0-3,8,10-11"
+    bool ParseCpuList(const std::string &list, std::vector<int> &cpus) {
+        std::stringstream ss(list);
+        for (std::string range; std::getline(ss, range, ',');) {
+            if (range.empty())
+                continue;
+            try {
+                const auto dash = range.find('-');
+                const int  lo   = std::stoi(range.substr(0, dash));
+                const int  hi   = dash == std::string::npos ? lo : std::stoi(range.substr(dash + 1));
+                if (lo < 0 || hi < lo || hi > 65535)
+                    return false;
+                for (int c = lo; c <= hi; ++c)
+                    cpus.push_back(c);
+            } catch (const std::exception &) {
+                return false;
+            }
+        }
+        std::sort(cpus.begin(), cpus.end());
+        cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+        return true;
+    }
+} // namespace
+
+NumaTopology NumaTopology::Detect() {
+    NumaTopology t;
+#ifdef __linux__
+    namespace fs = std::filesystem;
+    const fs::path  root("/sys/devices/system/node");
+    std::error_code ec;
+    for (const auto &entry : fs::directory_iterator(root, ec)) {
+        const std::string name = entry.path().filename().string();
+        if (name.rfind("node", 0) != 0 || name.size() == 4 ||
+            name.find_first_not_of("0123456789", 4) != std::string::npos)
+            continue;
+        Node          n;
+        std::ifstream list(entry.path() / "cpulist");
+        std::string   line;
+        n.id = std::stoi(name.substr(4));
+        if (!std::getline(list, line) || !ParseCpuList(line, n.cpus) || n.cpus.empty())
+            continue; // memory-only node
+        t.nodes_.push_back(std::move(n));
+    }
+    std::sort(t.nodes_.begin(), t.nodes_.end(), [](const Node &a, const Node &b) { return a.id < b.id; });
+
+    // Row i of node i's "distance" file is indexed by kernel node number
+    for (const Node &n : t.nodes_) {
+        std::ifstream    f(root / ("node" + std::to_string(n.id)) / "distance");
+        std::vector<int> all, row;
+        for (int d; f >> d;)
+            all.push_back(d);
+        for (const Node &m : t.nodes_) {
+            if (static_cast<std::size_t>(m.id) >= all.size())
+                break;
+            row.push_back(all[static_cast<std::size_t>(m.id)]);
+        }
+        if (row.size() != t.nodes_.size()) {
+            t.distance_.clear();
+            break;
+        }
+        t.distance_.push_back(std::move(row));
+    }
+#endif
+    if (t.nodes_.empty()) {
+        Node n;
+        const unsigned cpus = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned c = 0; c < cpus; ++c)
+            n.cpus.push_back(static_cast<int>(c));
+        t.nodes_.push_back(std::move(n));
+    }
+    return t;
+}
+
+bool NumaTopology::Parse(const std::string &spec, NumaTopology &out, std::string &why) {
+    NumaTopology      t;
+    std::stringstream ss(spec);
+    for (std::string item; std::getline(ss, item, ';');) {
+        const auto colon = item.find(':');
+        Node       n;
+        try {
+            n.id = colon == std::string::npos ? -1 : std::stoi(item.substr(0, colon));
+        } catch (const std::exception &) {
+            n.id = -1;
+        }
+        if (n.id < 0 || !ParseCpuList(item.substr(colon + 1), n.cpus) || n.cpus.empty()) {
+            why = "expected <node>:<cpus>, got '" + item + "'";
+            return false;
+        }
+        for (const Node &m : t.nodes_) {
+            if (m.id == n.id) {
+                why = "node " + std::to_string(n.id) + " listed twice";
+                return false;
+            }
+        }
+        t.nodes_.push_back(std::move(n));
+    }
+    if (t.nodes_.empty()) {
+        why = "no nodes";
+        return false;
+    }
+    out = std::move(t);
+    return true;
+}
+
+int NumaTopology::distance(std::size_t a, std::size_t b) const {
+    if (!distance_.empty())
+        return distance_[a][b];
+    return a == b ? 10 : 20;
+}
+
+bool NumaTopology::BindThread(std::size_t node) const {
+    return BindCpus(nodes_[node].cpus);
+}
+
+bool NumaTopology::BindCpus(const std::vector<int> &cpus) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int c : cpus) {
+        if (c < CPU_SETSIZE)
+            CPU_SET(c, &set);
+    }
+    return ::sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
+
+void NumaTopology::Print(std::ostream &os) const {
+    os << "[NumaTopology] " << nodes_.size() << (nodes_.size() == 1 ? " node" : " nodes") << ":";
+    for (const Node &n : nodes_)
+        os << " " << n.id << " (" << n.cpus.size() << " CPUs)";
+    os << "\n";
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// NUMA nodes the host places addons and transports on (see NumaPlacement).
+//
+// Detect() reads the kernel's view (/sys/devices/system/node); where there
+// is none, the machine is one node holding every CPU. Parse() takes an
+// explicit layout instead, "node:cpus;node:cpus" with cpus in the kernel's
+// list format ("0:0-7,16-23;1:8-15,24-31"), for machines whose sysfs is
+// hidden (containers) or to try a placement on a smaller box. Only nodes
+// with CPUs are listed.
+class NumaTopology {
+    public:
+        struct Node {
+                int              id = 0; // kernel node number: mbind() target
+                std::vector<int> cpus;
+        };
+
+        static NumaTopology Detect();
+        static bool         Parse(const std::string &spec, NumaTopology &out, std::string &why);
+
+        const std::vector<Node> &nodes() const {
+            return nodes_;
+        }
+        std::size_t size() const {
+            return nodes_.size();
+        }
+
+        // Relative access cost between nodes (by index into nodes()), 10 =
+        // local, as in the ACPI SLIT; 20 for remote nodes without a table
+        int distance(std::size_t a, std::size_t b) const;
+
+        // Restrict the calling thread (a runner: its process) to the CPUs of
+        // nodes()[node], or to `cpus`; later threads it starts inherit the mask
+        bool        BindThread(std::size_t node) const;
+        static bool BindCpus(const std::vector<int> &cpus);
+
+        void Print(std::ostream &os) const;
+
+    private:
+        std::vector<Node>             nodes_;
+        std::vector<std::vector<int>> distance_; // empty = 10 / 20
+};
@@ -0,0 +1,32 @@
+#include "PageFaults.hpp"
+
+#ifndef _WIN32
+    #include <sys/resource.h>
+#endif
+
+namespace {
+#ifndef _WIN32
+    PageFaults Usage(int who) {
+        rusage ru{};
+        if (::getrusage(who, &ru) != 0)
+            return {};
+        return {static_cast<std::uint64_t>(ru.ru_minflt), static_cast<std::uint64_t>(ru.ru_majflt)};
+    }
+#endif
+} // namespace
+
+PageFaults PageFaults::Thread() {
+#ifdef RUSAGE_THREAD
+    return Usage(RUSAGE_THREAD);
+#else
+    return {};
+#endif
+}
+
+PageFaults PageFaults::Process() {
+#ifndef _WIN32
+    return Usage(RUSAGE_SELF);
+#else
+    return {};
+#endif
+}
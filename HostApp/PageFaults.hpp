@@ -0,0 +1,17 @@
+#pragma once
+#include <cstdint>
+
+// Page-fault counters from getrusage(): of the calling thread or of the
+// whole process. Zero where unsupported. HostApp --low-jitter reports the
+// difference over the live cycles.
+struct PageFaults {
+        std::uint64_t minor = 0; // no I/O: first touch, COW, THP
+        std::uint64_t major = 0; // needed I/O
+
+        static PageFaults Thread();
+        static PageFaults Process();
+
+        PageFaults operator-(const PageFaults &o) const {
+            return {minor - o.minor, major - o.major};
+        }
+};
@@ -1,9 +1,49 @@
 ﻿#include "PortManager.hpp"
+#include <algorithm>
+#include <new>
 
 using namespace PluginAPI;
 
+const std::vector<PortManager::Connection *> PortManager::kNoOutbound;
+
+PortManager::~PortManager() {
+    ReleaseRoutes();
+}
+
+void PortManager::ReleaseRoutes() {
+    for (auto &[key, pi] : ports_) {
+        if (pi.outbound != &kNoOutbound)
+            delete pi.outbound;
+        pi.outbound = &kNoOutbound;
+    }
+}
+
 void PortManager::BeginAddon(const std::string &addonName) {
-    currentAddon_ = addonName;
+    currentAddon_  = addonName;
+    currentMemory_ = nullptr;
+}
+
+void PortManager::UseAddonMemory(std::pmr::memory_resource *mr) {
+    currentMemory_ = mr;
+}
+
+std::pmr::memory_resource *PortManager::Memory() {
+    return currentMemory_ ? currentMemory_ : std::pmr::get_default_resource();
+}
+
+std::uint64_t PortManager::Now() {
+    return clock_ ? clock_->Now() : SteadyNowNs();
+}
+
+std::uint32_t PortManager::RegisterLogSite(LogLevel level, const char *format, std::uint32_t maxPerSecond) {
+    return HostLogger::RegisterSite(level, format, maxPerSecond);
+}
+
+void PortManager::LogRecord(std::uint32_t site, const LogArg *args, std::size_t count) {
+    if (logger_)
+        logger_->Log(site, args, count);
+    else
+        HostLogger::WriteNow(site, args, count);
 }
 
 void PortManager::CreatePort(const PortDescriptor &desc) {
@@ -21,21 +61,24 @@ void PortManager::CreatePort(const PortDescriptor &desc) {
     }
 
     PortInfo info;
-    info.key  = key;
-    info.desc = desc;
+    info.key     = key;
+    info.desc    = desc;
+    info.id      = nextPortId_++;
+    info.addonId = AddonId(key.addon);
 
     ports_.emplace(key, std::move(info));
 
-    std::cout << "  [PortManager] Registered port " << key.addon << "::" << key.port
-              << " | Dir=" << to_string(desc.Direction)
-              << " | Type=" << to_string(desc.Type)
-              << " | Policy=" << to_string(desc.AccessPolicy)
-              << "\n";
+    PLUGIN_LOG(this, LogLevel::Debug, 0, "  [PortManager] Registered port {}::{} | Dir={} | Type={} | Policy={}",
+        key.addon, key.port, to_string(desc.Direction), to_string(desc.Type), to_string(desc.AccessPolicy));
 }
 
 bool PortManager::Validate(const PortDescriptor &prov,
     const PortDescriptor                        &recv,
     std::string                                 &why) {
+    if (prov.Type == PortType::MappedFile || recv.Type == PortType::MappedFile) {
+        why = "resource ports are bound to files (BindResource), not connected";
+        return false;
+    }
     if (prov.Direction != PortDirection::Output) {
         why = "provider is not Output";
         return false;
@@ -54,8 +97,25 @@ bool PortManager::Validate(const PortDescriptor &prov,
     return true;
 }
 
-bool PortManager::Connect(const PortKey &provider, const PortKey &receiver) {
-    auto pIt = ports_.find(provider);
+// Connect() and LoadFromFile() alike: Admit() and Link() rely on these ranges
+bool PortManager::ValidatePolicy(const DeliveryPolicy &policy, const PortDescriptor &prov, std::string &why) {
+    using Mode = DeliveryPolicy::Mode;
+    if (policy.mode != Mode::All && prov.AccessPolicy != PluginAPI::DataAccessPolicy::Buffered) {
+        why = "delivery policies need Buffered ports";
+        return false;
+    }
+    // Written so NaN fails too: the countdown is 32 bits, the interval 1e9 / rate ns
+    if ((policy.mode == Mode::EveryNth && !(policy.value >= 1 && policy.value <= 4294967295.0)) ||
+        (policy.mode == Mode::MaxRate && !(policy.value >= 1e-9))) {
+        why = "invalid delivery policy value " + std::to_string(policy.value);
+        return false;
+    }
+    return true;
+}
+
+bool PortManager::Connect(const PortKey &provider, const PortKey &receiver, const DeliveryPolicy &policy) {
+    std::lock_guard<std::mutex> lock(graphMutex_);
+    auto                        pIt = ports_.find(provider);
     auto rIt = ports_.find(receiver);
     if (pIt == ports_.end() || rIt == ports_.end())
         return false;
@@ -83,32 +143,227 @@ bool PortManager::Connect(const PortKey &provider, const PortKey &receiver) {
         return false;
     }
 
+    if (prov.desc.AccessPolicy == PluginAPI::DataAccessPolicy::Buffered && !Rewirable(prov, "Connect"))
+        return false;
+
+    if (!ValidatePolicy(policy, prov.desc, why)) {
+        std::cerr << "[PortManager] Connect failed: " << why << "\n";
+        return false;
+    }
+
     Connection conn;
     conn.provider = provider;
     conn.receiver = receiver;
+    conn.id       = static_cast<std::uint32_t>(connections_.size());
+    conn.policy   = policy;
 
     if (prov.desc.AccessPolicy == PluginAPI::DataAccessPolicy::Direct) {
         // DIRECT: shared memory
         if (!prov.transport) {
-            prov.transport = ::operator new(prov.desc.PayloadSize);
-            std::memset(prov.transport, 0, prov.desc.PayloadSize);
+            // [MessageHeader | pad to kDirectHeaderBytes][payload]
+            const std::size_t total = kDirectHeaderBytes + prov.desc.PayloadSize;
+            void             *block = arena_.Allocate(total, kDirectHeaderBytes);
+            if (!block)
+                return false;
+            prov.transport = static_cast<std::uint8_t *>(block) + kDirectHeaderBytes;
+
+            MessageHeader *h = DirectHeaderOf(prov.transport);
+            h->port          = prov.id;
+            h->originPort    = prov.id;
         }
         recv.transport = prov.transport;
-        // buffer unused for direct
-    } else {
-        // BUFFERED: allocate per-connection buffer
-        conn.buffer.resize(prov.desc.PayloadSize);
-        conn.hasData = false;
     }
+    // BUFFERED: Link() allocates the per-connection slot
 
     connections_.push_back(std::move(conn));
+    Link(connections_.back());
+    if (prov.desc.AccessPolicy == PluginAPI::DataAccessPolicy::Buffered && !connections_.back().slot) {
+        connections_.pop_back(); // arena exhausted
+        return false;
+    }
+    return true;
+}
+
+// Allocate the Buffered slot of `c` and resolve the routes of both ends
+void PortManager::Link(Connection &c) {
+    PortInfo *prov = FindPort(c.provider);
+    PortInfo *recv = FindPort(c.receiver);
+    if (!prov || !recv || prov->desc.AccessPolicy != PluginAPI::DataAccessPolicy::Buffered)
+        return;
+
+    if (!c.slot) {
+        // [Slot | pad to 64][payload]; Conflate connections share the
+        // provider's payload instead
+        const bool conflate = c.policy.mode == DeliveryPolicy::Mode::Conflate;
+        if (conflate && !prov->latest) {
+            auto *latest = static_cast<std::uint8_t *>(arena_.Allocate(prov->desc.PayloadSize));
+            if (!latest)
+                return;
+            std::atomic_ref<std::uint8_t *>(prov->latest).store(latest, std::memory_order_relaxed);
+        }
+        auto *mem = static_cast<std::uint8_t *>(arena_.Allocate(kSlotBytes + (conflate ? 0 : prov->desc.PayloadSize)));
+        if (!mem)
+            return;
+        c.slot  = new (mem) Slot{};
+        c.data  = conflate ? prov->latest : mem + kSlotBytes;
+        c.bytes = prov->desc.PayloadSize;
+    }
+    if (c.policy.mode == DeliveryPolicy::Mode::MaxRate)
+        c.intervalNs = static_cast<std::uint64_t>(1e9 / c.policy.value);
+
+    // A receiver's versions never go backwards across rewiring
+    if (const Connection *old = Inbound(*recv))
+        recv->retiredSeq = std::max(recv->retiredSeq, LoadSequence(old->slot->header));
+    c.slot->header.sequence = std::max(c.slot->header.sequence, recv->retiredSeq);
+
+    prov->owner = this;
+    recv->owner = this;
+    std::vector<Connection *> routes(*prov->outbound);
+    routes.push_back(&c);
+    Publish(*prov, std::move(routes));
+    std::atomic_ref<Connection *>(recv->inbound).store(&c, std::memory_order_release);
+}
+
+// Swaps in a new route array for `prov`; the old one is freed once no
+// Route() can still be walking it
+void PortManager::Publish(PortInfo &prov, std::vector<Connection *> routes) {
+    using Routes      = const std::vector<Connection *> *;
+    const Routes next = new std::vector<Connection *>(std::move(routes));
+    const Routes old  = prov.outbound;
+    std::atomic_ref<Routes>(prov.outbound).store(next, std::memory_order_release);
+    if (old == &kNoOutbound)
+        return;
+    if (rewiring_)
+        rcu_.Synchronize();
+    delete old;
+}
+
+bool PortManager::Rewirable(const PortInfo &prov, const char *what) const {
+    if (batchCycles_) {
+        std::cerr << "[PortManager] " << what << " failed: the graph is fixed during a batch\n";
+        return false;
+    }
+    if (prov.link || prov.pruned) {
+        std::cerr << "[PortManager] " << what << " failed: " << prov.key.addon << "::" << prov.key.port
+                  << " was optimized for a fixed graph\n";
+        return false;
+    }
+    return true;
+}
+
+bool PortManager::Disconnect(const PortKey &provider, const PortKey &receiver) {
+    std::lock_guard<std::mutex> lock(graphMutex_);
+    PortInfo                   *prov = FindPort(provider);
+    PortInfo                   *recv = FindPort(receiver);
+    if (!prov || !recv)
+        return false;
+    if (prov->desc.AccessPolicy != PluginAPI::DataAccessPolicy::Buffered) {
+        std::cerr << "[PortManager] Disconnect failed: Direct ports share one block for good\n";
+        return false;
+    }
+    if (!Rewirable(*prov, "Disconnect"))
+        return false;
+
+    Connection *conn = nullptr;
+    for (Connection *c : *prov->outbound) {
+        if (c->receiver.addon == receiver.addon && c->receiver.port == receiver.port)
+            conn = c;
+    }
+    if (!conn)
+        return false;
+
+    // Readers that already hold the connection keep a valid slot: neither
+    // is ever freed
+    if (Inbound(*recv) == conn) {
+        recv->retiredSeq = std::max(recv->retiredSeq, LoadSequence(conn->slot->header));
+        std::atomic_ref<Connection *>(recv->inbound).store(nullptr, std::memory_order_release);
+    }
+    std::vector<Connection *> routes;
+    for (Connection *c : *prov->outbound) {
+        if (c != conn)
+            routes.push_back(c);
+    }
+    Publish(*prov, std::move(routes));
+    conn->removed = true;
+    return true;
+}
+
+bool PortManager::EnableRewiring() {
+    if (arena_.shared()) {
+        std::cerr << "[PortManager] Runtime rewiring is not available with isolated runners\n";
+        return false;
+    }
+    rewiring_ = true;
+    return true;
+}
+
+bool PortManager::BindResource(const PortKey &port, const std::string &path) {
+    PortInfo *pi = FindPort(port);
+    if (!pi || pi->desc.Type != PortType::MappedFile || pi->desc.Direction != PortDirection::Input) {
+        std::cerr << "[PortManager] BindResource failed: " << port.addon << "::" << port.port
+                  << " is not a resource input\n";
+        return false;
+    }
+
+    std::string                    why;
+    const ResourceStore::Resource *res = resources_.Open(path, why);
+    if (!res) {
+        std::cerr << "[PortManager] BindResource failed: " << why << "\n";
+        return false;
+    }
+    if (res->typeHash != pi->desc.TypeHash || res->payloadSize != pi->desc.PayloadSize) {
+        std::cerr << "[PortManager] BindResource failed: " << res->path << " does not hold the payload of "
+                  << port.addon << "::" << port.port << " (file: " << res->payloadSize << " bytes, port: "
+                  << pi->desc.PayloadSize << " bytes" << (res->typeHash != pi->desc.TypeHash ? ", other type" : "")
+                  << ")\n";
+        return false;
+    }
+
+    pi->resource = res;
+    if (arena_.lowJitter())
+        resources_.Populate(); // no first-touch faults once the addons run
     return true;
 }
 
 bool PortManager::Connect(const std::string &providerAddon, const std::string &providerPort,
-    const std::string &receiverAddon, const std::string &receiverPort) {
+    const std::string &receiverAddon, const std::string &receiverPort, const DeliveryPolicy &policy) {
     return Connect(PortKey{providerAddon, providerPort},
-        PortKey{receiverAddon, receiverPort});
+        PortKey{receiverAddon, receiverPort}, policy);
+}
+
+// Whether a write now reaches `c` under its delivery policy. MaxRate runs
+// on the host clock, so a virtual-time run admits what real time would.
+bool PortManager::Admit(Connection &c) {
+    switch (c.policy.mode) {
+        case DeliveryPolicy::Mode::EveryNth:
+            if (c.countdown) {
+                --c.countdown;
+                return false;
+            }
+            c.countdown = static_cast<std::uint32_t>(c.policy.value) - 1;
+            return true;
+        case DeliveryPolicy::Mode::MaxRate: {
+            const std::uint64_t now = Now();
+            if (now < c.nextNs)
+                return false;
+            c.nextNs = now + c.intervalNs;
+            return true;
+        }
+        default:
+            return true;
+    }
+}
+
+std::uint32_t PortManager::AddonId(const std::string &addon) {
+    auto [it, inserted] = addonIds_.try_emplace(addon, static_cast<std::uint32_t>(addonIds_.size()));
+    if (inserted)
+        origins_.emplace_back();
+    return it->second;
+}
+
+PortManager::PortInfo *PortManager::FindPort(const PortKey &key) {
+    auto it = ports_.find(key);
+    return it == ports_.end() ? nullptr : &it->second;
 }
 
 void PortManager::PrintPorts() const {
@@ -118,14 +373,18 @@ void PortManager::PrintPorts() const {
         std::cout << "  " << k.addon << "::" << k.port
                   << " | " << to_string(d.Direction)
                   << " | " << to_string(d.Type)
-                  << " | " << to_string(d.AccessPolicy)
-                  << "\n";
+                  << " | " << to_string(d.AccessPolicy);
+        if (info.resource)
+            std::cout << " | " << info.resource->path;
+        std::cout << "\n";
     }
 }
 
 void PortManager::PrintConnections() const {
     std::cout << "\n[PortManager] Connections:\n";
     for (const auto &c : connections_) {
+        if (c.removed)
+            continue;
         std::cout << "  " << c.provider.addon << "::" << c.provider.port
                   << " -> "
                   << c.receiver.addon << "::" << c.receiver.port
@@ -139,14 +398,36 @@ PluginAPI::PortHandle PortManager::OpenPort(const char *name) {
         return {};
 
     auto &pi = it->second;
+    opened_  = true;
+
+    if (pi.desc.Type == PortType::MappedFile) {
+        // Resource – the mapped payload, read-only and never written
+        return PluginAPI::PortHandle{pi.resource ? const_cast<void *>(pi.resource->payload) : nullptr};
+    }
 
     if (pi.desc.AccessPolicy == PluginAPI::DataAccessPolicy::Direct) {
-        // Direct – transport set in Connect()
+        // Direct – transport set in Connect(), version in its header
+        if (!pi.transport || pi.pruned)
+            return {};
         return PluginAPI::PortHandle{pi.transport};
     }
 
-    // Buffered – use PortInfo* as handle.impl
-    return PluginAPI::PortHandle{&pi};
+    // Buffered – the resolved fast path as handle.impl; inputs read the
+    // version of their provider's connection, unless rewiring may swap
+    // that connection later
+    pi.owner = this;
+    if (pi.pruned) {
+        pi.fast = {&kPrunedOps, &pi, nullptr};
+        return PluginAPI::PortHandle{&pi.fast};
+    }
+    pi.fast = {pi.link ? &kLinkOps : &kBufferedOps, &pi,
+        pi.inbound && !rewiring_ ? &pi.inbound->slot->header.sequence : nullptr};
+    return PluginAPI::PortHandle{&pi.fast};
+}
+
+// Buffered handles point to PortInfo::fast, whose ctx is the PortInfo
+PortManager::PortInfo *PortManager::PortOf(PluginAPI::PortHandle h) {
+    return h.impl ? static_cast<PortInfo *>(static_cast<PluginAPI::PortFastPath *>(h.impl)->ctx) : nullptr;
 }
 
 // Demo transport: each port gets a tiny byte buffer in PortInfo::transport.
@@ -161,61 +442,555 @@ bool PortManager::Read(PluginAPI::PortHandle h,
     size_t                                   bytes,
     size_t                                  &outBytes) {
     outBytes = 0;
-    if (!h.impl)
+    auto *pi = PortOf(h);
+    if (!pi)
         return false;
 
-    auto *pi = static_cast<PortInfo *>(h.impl);
-
     if (pi->desc.AccessPolicy == PluginAPI::DataAccessPolicy::Direct) {
         return false; // Direct ports should use directPtr_, not Read()
     }
+    return ReadPort(*pi, dst, bytes, outBytes);
+}
 
-    // Find the connection where this port is the receiver
-    for (auto &conn : connections_) {
-        if (conn.receiver.addon == pi->key.addon &&
-            conn.receiver.port == pi->key.port) {
-            if (!conn.hasData)
-                return false; // nothing written yet
+bool PortManager::ReadPort(PortInfo &pi, void *dst, size_t bytes, size_t &outBytes) {
+    Connection *conn = Inbound(pi);
+    if (!conn)
+        return false; // no connection found
 
-            const size_t n = std::min(bytes, conn.buffer.size());
-            std::memcpy(dst, conn.buffer.data(), n);
-            outBytes = n;
-            return true;
-        }
+    if (!conn->slot->hasData) {
+        if (metrics_)
+            metrics_->OnEmptyRead(pi.id, conn->id);
+        return false; // nothing written yet
+    }
+
+    const size_t n = std::min(bytes, conn->bytes);
+    std::memcpy(dst, conn->data, n);
+    outBytes = n;
+    NoteRead(pi, *conn, n);
+    return true;
+}
+
+// Read bookkeeping shared by ReadPort() and joins: metrics, skipped
+// sequence numbers and the origin this addon's next writes inherit
+void PortManager::NoteRead(const PortInfo &pi, Connection &conn, size_t bytes) {
+    Slot       &slot = *conn.slot;
+    const auto &hdr  = slot.header;
+    if (metrics_) {
+        const std::uint64_t now     = SteadyNowNs();
+        const std::uint64_t skipped = (slot.lastReadSeq && hdr.sequence > slot.lastReadSeq + 1)
+                                          ? hdr.sequence - slot.lastReadSeq - 1
+                                          : 0;
+        metrics_->OnRead(pi.id, conn.id, bytes, now - hdr.writeNs, now - hdr.originNs, skipped,
+            hdr.sequence != slot.lastReadSeq);
     }
+    slot.lastReadSeq = hdr.sequence;
+    slot.unread      = 0;
 
-    return false; // no connection found
+    // Remember the oldest origin this addon consumed in this cycle
+    NoteOrigin(pi, hdr);
+}
+
+void PortManager::NoteOrigin(const PortInfo &pi, const PluginAPI::MessageHeader &hdr) {
+    auto &o = origins_[pi.addonId];
+    if (o.cycle != cycle_ || hdr.originNs < o.originNs)
+        o = Origin{cycle_, hdr.originNs, hdr.originPort};
 }
 
 bool PortManager::Write(PluginAPI::PortHandle h, const void *src, size_t bytes, size_t &outBytes) {
     outBytes = 0;
-    if (!h.impl)
+    auto *pi = PortOf(h);
+    if (!pi)
         return false;
 
-    auto *pi = static_cast<PortInfo *>(h.impl);
-
     // For Direct ports, AddOnPort::write might bypass this; for now,
     // we assume only Buffered ports call Write().
     if (pi->desc.AccessPolicy == PluginAPI::DataAccessPolicy::Direct) {
         return false;
     }
+    return WritePort(*pi, src, bytes, outBytes);
+}
+
+bool PortManager::WritePort(PortInfo &pi, const void *src, size_t bytes, size_t &outBytes) {
+    if (recorder_)
+        recorder_->Append(pi.id, src, bytes);
+    if (metrics_)
+        metrics_->OnWrite(pi.id, bytes);
+
+    // Propagate the origin of whatever this addon read this cycle; a pure
+    // source starts a new chain.
+    const auto &o = origins_[pi.addonId];
+    if (o.cycle == cycle_)
+        return Route(pi, src, bytes, outBytes, o.originNs, o.port);
+    return Route(pi, src, bytes, outBytes, 0, pi.id);
+}
+
+bool PortManager::ReadHeader(PluginAPI::PortHandle h, PluginAPI::MessageHeader &out) {
+    PortInfo *pi = PortOf(h);
+    return pi && OpsReadHeader(pi, out);
+}
+
+// -------- Buffered fast path (PortFastPath::ops) --------
+// No virtual dispatch and no policy check: OpenPort() hands these out only
+// for Buffered ports, with the PortInfo as ctx.
+const PluginAPI::TransportOps PortManager::kBufferedOps{
+    &PortManager::OpsRead,
+    &PortManager::OpsWrite,
+    &PortManager::OpsReadHeader};
+
+bool PortManager::OpsRead(void *ctx, void *dst, std::size_t bytes) {
+    auto  *pi = static_cast<PortInfo *>(ctx);
+    size_t n  = 0;
+    return pi->owner && pi->owner->ReadPort(*pi, dst, bytes, n);
+}
+
+bool PortManager::OpsWrite(void *ctx, const void *src, std::size_t bytes) {
+    auto  *pi = static_cast<PortInfo *>(ctx);
+    size_t n  = 0;
+    return pi->owner && pi->owner->WritePort(*pi, src, bytes, n);
+}
+
+bool PortManager::OpsReadHeader(void *ctx, PluginAPI::MessageHeader &out) {
+    const Connection *conn = Inbound(*static_cast<PortInfo *>(ctx));
+    if (!conn || !conn->slot->hasData)
+        return false;
+    out = conn->slot->header;
+    return true;
+}
+
+// Single-reader link between cycle-thread addons (GraphOptimizer): one slot,
+// no fan-out loop, and a plain sequence store: the reader runs after the
+// writer on the same thread, or after a runner hand-off that orders them.
+// Recording and metrics need the generic path.
+const PluginAPI::TransportOps PortManager::kLinkOps{
+    &PortManager::OpsRead,
+    &PortManager::OpsWriteLink,
+    &PortManager::OpsReadHeader};
+
+bool PortManager::OpsWriteLink(void *ctx, const void *src, std::size_t bytes) {
+    auto        *pi = static_cast<PortInfo *>(ctx);
+    PortManager *pm = pi->owner;
+    if (pm->recorder_ || pm->metrics_ || pm->batchCycles_) {
+        size_t n = 0;
+        return pm->WritePort(*pi, src, bytes, n);
+    }
+
+    Connection         &conn = *pi->outbound->front();
+    Slot               &slot = *conn.slot;
+    const auto         &o    = pm->origins_[pi->addonId];
+    const std::uint64_t now  = SteadyNowNs();
+    std::memcpy(conn.data, src, std::min(bytes, conn.bytes));
+
+    const bool chained     = o.cycle == pm->cycle_;
+    slot.header.writeNs    = now;
+    slot.header.originNs   = chained ? o.originNs : now;
+    slot.header.port       = pi->id;
+    slot.header.originPort = chained ? o.port : pi->id;
+    slot.header.sequence  += 1;
+    slot.hasData           = 1;
+    slot.unread            = 1;
+    return true;
+}
+
+// Pruned ports: nothing to read, nobody to write to
+const PluginAPI::TransportOps PortManager::kPrunedOps{
+    &PortManager::OpsPrunedRead,
+    &PortManager::OpsPrunedWrite,
+    &PortManager::OpsPrunedReadHeader};
+
+bool PortManager::OpsPrunedRead(void *, void *, std::size_t) {
+    return false;
+}
+bool PortManager::OpsPrunedWrite(void *, const void *, std::size_t) {
+    return false;
+}
+bool PortManager::OpsPrunedReadHeader(void *, PluginAPI::MessageHeader &) {
+    return false;
+}
+
+// -------- Joins (IHostPortServices) --------
+// The handle is the receiver's PortInfo; views point at the Direct block or
+// the connection's Buffered slot.
+void *PortManager::ResolveInput(const std::string &addon, const std::string &port) {
+    PortInfo *pi = FindPort(PortKey{addon, port});
+    if (!pi || pi->desc.Direction != PluginAPI::PortDirection::Input)
+        return nullptr;
+    return pi;
+}
+
+bool PortManager::PeekInput(void *input, PluginAPI::JoinView &out) {
+    auto *pi = static_cast<PortInfo *>(input);
+    if (pi->desc.AccessPolicy == PluginAPI::DataAccessPolicy::Direct) {
+        if (!pi->transport)
+            return false;
+        const MessageHeader *h = DirectHeaderOf(pi->transport);
+        out.data               = pi->transport;
+        out.bytes              = pi->desc.PayloadSize;
+        out.header             = *h;
+        out.header.sequence    = LoadSequence(*h);
+        return true;
+    }
+
+    Connection *conn = Inbound(*pi);
+    if (!conn || !conn->slot->hasData)
+        return false;
+    out.data   = conn->data;
+    out.bytes  = conn->bytes;
+    out.header = conn->slot->header;
+    return true;
+}
+
+void PortManager::ConsumeInput(void *input) {
+    auto *pi = static_cast<PortInfo *>(input);
+    if (pi->desc.AccessPolicy == PluginAPI::DataAccessPolicy::Direct) {
+        if (pi->transport)
+            NoteOrigin(*pi, *DirectHeaderOf(pi->transport));
+        return;
+    }
+    if (Connection *conn = Inbound(*pi))
+        NoteRead(*pi, *conn, conn->bytes);
+}
+
+// Copy one write into every connection where this port is the provider.
+// originNs == 0 starts a new chain at this write.
+bool PortManager::Route(const PortInfo &pi, const void *src, size_t bytes, size_t &outBytes,
+    std::uint64_t originNs, std::uint32_t originPort) {
+    const std::uint64_t now = SteadyNowNs();
+    if (originNs == 0)
+        originNs = now;
+
+    // Routes first: a Conflate connection in them implies `latest` is set
+    const RcuDomain::ReadGuard guard(rcu_, rewiring_);
+    const auto                &routes = Outbound(pi);
+    std::uint8_t *const        latest =
+        std::atomic_ref<std::uint8_t *>(const_cast<std::uint8_t *&>(pi.latest)).load(std::memory_order_relaxed);
+
+    // One copy for every Conflate reader
+    if (latest && !batchCycles_)
+        std::memcpy(latest, src, std::min(bytes, pi.desc.PayloadSize));
 
-    // Find all connections where this port is the provider
     bool any = false;
-    for (auto &conn : connections_) {
-        if (conn.provider.addon == pi->key.addon &&
-            conn.provider.port == pi->key.port) {
-            const size_t n = std::min(bytes, conn.buffer.size());
-            std::memcpy(conn.buffer.data(), src, n);
-            conn.hasData = true;
-            outBytes     = n; // last value wins for outBytes
-            any          = true;
+    for (Connection *conn : routes) {
+        Slot        &slot = *conn->slot;
+        const size_t n    = std::min(bytes, conn->bytes);
+        if (conn->policy.mode != DeliveryPolicy::Mode::All && !Admit(*conn)) {
+            if (metrics_)
+                metrics_->OnFiltered(conn->id);
+            outBytes = n; // accepted, just not for this reader
+            any      = true;
+            continue;
         }
+        if (batchCycles_) {
+            MessageHeader &hdr = Enqueue(*conn, src, n);
+            hdr.writeNs        = now;
+            hdr.originNs       = originNs;
+            hdr.port           = pi.id;
+            hdr.originPort     = originPort;
+            outBytes           = n;
+            any                = true;
+            continue;
+        }
+        if (conn->data != latest)
+            std::memcpy(conn->data, src, n);
+        if (metrics_)
+            metrics_->OnDeliver(conn->id, n, slot.unread != 0);
+
+        slot.header.writeNs    = now;
+        slot.header.originNs   = originNs;
+        slot.header.port       = pi.id;
+        slot.header.originPort = originPort;
+        PublishSequence(slot.header, slot.header.sequence + 1);
+        slot.hasData = 1;
+        slot.unread  = 1;
+        outBytes      = n; // last value wins for outBytes
+        any           = true;
     }
 
     return any;
 }
 
+bool PortManager::Inject(PortInfo &pi, const void *src, size_t bytes) {
+    if (pi.desc.AccessPolicy == PluginAPI::DataAccessPolicy::Direct) {
+        if (!pi.transport)
+            return false;
+        std::memcpy(pi.transport, src, std::min(bytes, pi.desc.PayloadSize));
+        StampDirectWrite(pi.transport);
+        return true;
+    }
+    size_t wrote = 0;
+    return Route(pi, src, bytes, wrote, 0, pi.id);
+}
+
+// -------- Offline batch mode --------
+
+void PortManager::BeginBatch(std::size_t cycles) {
+    batch_.assign(connections_.size(), BatchQueue{});
+    for (const Connection &c : connections_) {
+        auto &q = batch_[c.id];
+        q.frames.reserve(cycles);
+        q.data.reserve(cycles * c.bytes);
+    }
+    batchCycles_ = cycles;
+    batchCycle_  = 0;
+}
+
+void PortManager::EndBatch() {
+    FlushBatch();
+    batch_.clear();
+    batchCycles_ = 0;
+}
+
+// Appends one frame; the caller stamps everything but the sequence, which
+// continues from the slot (or the previous frame) as if the write had landed
+MessageHeader &PortManager::Enqueue(Connection &conn, const void *src, size_t bytes) {
+    auto               &q   = batch_[conn.id];
+    const std::size_t   at  = q.data.size();
+    const std::uint64_t seq = (q.frames.empty() ? conn.slot->header.sequence : q.frames.back().header.sequence) + 1;
+    q.data.resize(at + conn.bytes);
+    std::memcpy(q.data.data() + at, src, bytes);
+
+    BatchQueue::Frame f;
+    f.header.sequence = seq;
+    f.cycle           = batchCycle_ != kWholeBatch
+                            ? batchCycle_
+                            : static_cast<std::uint32_t>(std::min(q.frames.size(), batchCycles_ - 1));
+    q.frames.push_back(f);
+    return q.frames.back().header;
+}
+
+// Frame `frame` of the connection's queue becomes the slot's current value
+void PortManager::Deliver(Connection &conn, std::size_t frame) {
+    const auto &q    = batch_[conn.id];
+    const auto &f    = q.frames[frame];
+    Slot       &slot = *conn.slot;
+    std::memcpy(conn.data, q.data.data() + frame * conn.bytes, conn.bytes);
+    if (metrics_)
+        metrics_->OnDeliver(conn.id, conn.bytes, slot.unread != 0);
+    slot.header.writeNs    = f.header.writeNs;
+    slot.header.originNs   = f.header.originNs;
+    slot.header.port       = f.header.port;
+    slot.header.originPort = f.header.originPort;
+    PublishSequence(slot.header, f.header.sequence);
+    slot.hasData = 1;
+    slot.unread  = 1;
+}
+
+void PortManager::StepInputs(const std::string &addon, std::uint32_t cycle) {
+    for (auto it = ports_.lower_bound(PortKey{addon, ""}); it != ports_.end() && it->first.addon == addon; ++it) {
+        Connection *conn = Inbound(it->second);
+        if (!conn)
+            continue;
+        auto       &q    = batch_[conn->id];
+        std::size_t last = q.delivered;
+        while (last < q.frames.size() && q.frames[last].cycle <= cycle)
+            ++last;
+        if (last != q.delivered) {
+            Deliver(*conn, last - 1); // intermediate frames were overwritten
+            q.delivered = last;
+        }
+    }
+}
+
+void PortManager::FlushBatch() {
+    for (Connection &c : connections_) {
+        if (c.id >= batch_.size())
+            continue;
+        auto &q = batch_[c.id];
+        if (q.delivered < q.frames.size())
+            Deliver(c, q.frames.size() - 1);
+        q.frames.clear();
+        q.data.clear();
+        q.read = q.delivered = 0;
+    }
+}
+
+std::size_t PortManager::ReadBatch(PortHandle h, void *dst, size_t frameBytes, size_t maxFrames) {
+    if (!batchCycles_)
+        return IHostServices::ReadBatch(h, dst, frameBytes, maxFrames);
+    PortInfo   *pi      = PortOf(h);
+    Connection *inbound = pi ? Inbound(*pi) : nullptr;
+    if (!inbound || pi->pruned || pi->desc.AccessPolicy == DataAccessPolicy::Direct)
+        return 0;
+
+    Connection  &conn  = *inbound;
+    auto        &q     = batch_[conn.id];
+    const size_t count = std::min(maxFrames, q.frames.size() - q.read);
+    const size_t n     = std::min(frameBytes, conn.bytes);
+    auto        *out   = static_cast<std::uint8_t *>(dst);
+    for (std::size_t k = 0; k < count; ++k) {
+        const auto &f = q.frames[q.read + k];
+        std::memcpy(out + k * frameBytes, q.data.data() + (q.read + k) * conn.bytes, n);
+        if (metrics_) {
+            const std::uint64_t now = Now();
+            metrics_->OnRead(pi->id, conn.id, n, now - f.header.writeNs, now - f.header.originNs, 0, true);
+        }
+        NoteOrigin(*pi, f.header);
+    }
+    q.read += count;
+    if (count)
+        conn.slot->lastReadSeq = q.frames[q.read - 1].header.sequence;
+    return count;
+}
+
+void PortManager::EndCycle() {
+    ++cycle_; // invalidates per-addon origins
+
+    if (metrics_)
+        CountDirectWrites(true);
+    if (!recorder_)
+        return;
+
+    // Direct outputs never pass through Write(): snapshot them once per cycle
+    for (const auto &[key, pi] : ports_) {
+        if (pi.desc.AccessPolicy == PluginAPI::DataAccessPolicy::Direct &&
+            pi.desc.Direction == PluginAPI::PortDirection::Output &&
+            pi.transport) {
+            recorder_->Append(pi.id, pi.transport, pi.desc.PayloadSize);
+        }
+    }
+    recorder_->MarkCycle();
+}
+
+bool PortManager::StartRecording(const std::string &filename) {
+    std::vector<PortRecorder::PortEntry> entries;
+    entries.reserve(ports_.size());
+    for (const auto &[key, pi] : ports_) {
+        PortRecorder::PortEntry e;
+        e.id          = pi.id;
+        e.addon       = key.addon;
+        e.port        = key.port;
+        e.payloadSize = static_cast<std::uint32_t>(pi.desc.PayloadSize);
+        e.typeHash    = pi.desc.TypeHash;
+        e.policy      = static_cast<std::uint8_t>(pi.desc.AccessPolicy);
+        entries.push_back(std::move(e));
+    }
+
+    auto rec = std::make_unique<PortRecorder>();
+    if (!rec->Start(filename, entries))
+        return false;
+    recorder_ = std::move(rec);
+    return true;
+}
+
+bool PortManager::UseSharedTransports(std::size_t capacity) {
+    if (!connections_.empty()) {
+        std::cerr << "[PortManager] Shared transports must be enabled before Connect()\n";
+        return false;
+    }
+    return arena_.OpenShared(capacity);
+}
+
+bool PortManager::UseLowJitterTransports(std::size_t capacity) {
+    if (!connections_.empty()) {
+        std::cerr << "[PortManager] Low-jitter transports must be enabled before Connect()\n";
+        return false;
+    }
+    return arena_.OpenLowJitter(capacity);
+}
+
+bool PortManager::Movable(const char *what) const {
+    if (opened_) {
+        std::cerr << "[PortManager] " << what << " failed: addons already hold pointers to the transports\n";
+        return false;
+    }
+    return true;
+}
+
+bool PortManager::MoveToNode(Connection &c, int node) {
+    if (!c.slot || !Movable("MoveToNode"))
+        return false;
+    const bool  conflate = c.policy.mode == DeliveryPolicy::Mode::Conflate;
+    auto *const mem      = static_cast<std::uint8_t *>(arena_.AllocateOn(node, kSlotBytes + (conflate ? 0 : c.bytes)));
+    if (!mem)
+        return false;
+    c.slot = new (mem) Slot(*c.slot);
+    if (!conflate) {
+        std::memcpy(mem + kSlotBytes, c.data, c.bytes);
+        c.data = mem + kSlotBytes;
+    }
+    return true;
+}
+
+bool PortManager::MoveToNode(const PortKey &directProvider, int node) {
+    PortInfo *prov = FindPort(directProvider);
+    if (!prov || !prov->transport || prov->desc.AccessPolicy != PluginAPI::DataAccessPolicy::Direct ||
+        !Movable("MoveToNode"))
+        return false;
+    const std::size_t total = kDirectHeaderBytes + prov->desc.PayloadSize;
+    auto *const       block = static_cast<std::uint8_t *>(arena_.AllocateOn(node, total, kDirectHeaderBytes));
+    if (!block)
+        return false;
+    std::memcpy(block, DirectHeaderOf(prov->transport), total);
+
+    void *const old = prov->transport;
+    for (auto &[key, pi] : ports_) {
+        if (pi.transport == old && pi.desc.AccessPolicy == PluginAPI::DataAccessPolicy::Direct)
+            pi.transport = block + kDirectHeaderBytes;
+    }
+    return true;
+}
+
+void PortManager::BeginWarmUp() {
+    warmRecorder_ = std::move(recorder_);
+    warmMetrics_  = std::move(metrics_);
+}
+
+void PortManager::EndWarmUp() {
+    recorder_ = std::move(warmRecorder_);
+    metrics_  = std::move(warmMetrics_);
+    if (metrics_)
+        CountDirectWrites(false); // the dry cycles' writes are not traffic
+}
+
+void PortManager::CountDirectWrites(bool count) {
+    for (auto &[key, pi] : ports_) {
+        if (pi.desc.AccessPolicy != PluginAPI::DataAccessPolicy::Direct ||
+            pi.desc.Direction != PluginAPI::PortDirection::Output || !pi.transport)
+            continue;
+        const std::uint64_t seq = PluginAPI::LoadSequence(*PluginAPI::DirectHeaderOf(pi.transport));
+        if (count && seq > pi.directSeq)
+            metrics_->OnWrite(pi.id, pi.desc.PayloadSize, seq - pi.directSeq);
+        pi.directSeq = seq;
+    }
+}
+
+void PortManager::DetachForRunner() {
+    // Owned by the host process: flushing or joining them here would corrupt
+    // the recording or hang on a thread that does not exist after fork()
+    (void)recorder_.release();
+    (void)metrics_.release();
+    logger_ = nullptr; // its thread stayed in the host: log synchronously
+    if (arena_.lowJitter()) {
+        arena_.Populate(); // no first-touch faults in the runner either
+        resources_.Populate();
+    }
+}
+
+void PortManager::EnableMetrics() {
+    std::vector<std::string> portNames(nextPortId_);
+    for (const auto &[key, pi] : ports_)
+        portNames[pi.id] = key.addon + "::" + key.port;
+
+    std::vector<std::string> connNames;
+    connNames.reserve(connections_.size());
+    for (const auto &c : connections_)
+        connNames.push_back(c.provider.addon + "::" + c.provider.port + " -> " +
+                            c.receiver.addon + "::" + c.receiver.port);
+
+    metrics_ = std::make_unique<PortMetrics>(std::move(portNames), std::move(connNames));
+    CountDirectWrites(false);
+}
+
+void PortManager::DisableMetrics() {
+    metrics_.reset();
+}
+
+void PortManager::StopRecording() {
+    if (recorder_) {
+        recorder_->Stop();
+        recorder_.reset();
+    }
+}
+
 #if 0 // jsonv ersion
 
 // Project functions
@@ -302,12 +1077,14 @@ bool PortManager::LoadFromFile(const std::string &filename) {
         PortKey prov{entry["provider_addon"], entry["provider_port"]};
         PortKey recv{entry["receiver_addon"], entry["receiver_port"]};
         connections_.push_back({prov, recv});
+        Link(connections_.back());
     }
 
     return true;
 }
 #else
     #include <fstream>
+    #include <iomanip>
     #include <limits>
 
 bool PortManager::SaveToFile(const std::string &filename) const {
@@ -318,11 +1095,14 @@ bool PortManager::SaveToFile(const std::string &filename) const {
         return false;
     }
 
-    // Magic + version
-    out << "PMv1\n";
+    // Magic + version; v2 adds the delivery policy of each connection
+    out << "PMv2\n";
 
-    // Counts
-    out << ports_.size() << " " << connections_.size() << "\n";
+    // Counts; Disconnect()ed connections are not saved
+    const std::lock_guard<std::mutex> lock(graphMutex_);
+    const auto                        live = std::count_if(connections_.begin(), connections_.end(),
+        [](const Connection &c) { return !c.removed; });
+    out << ports_.size() << " " << live << "\n";
 
     // Ports
     for (const auto &[key, info] : ports_) {
@@ -341,10 +1121,13 @@ bool PortManager::SaveToFile(const std::string &filename) const {
 
     // Connections
     for (const auto &c : connections_) {
+        if (c.removed)
+            continue;
         out << c.provider.addon << "\n";
         out << c.provider.port << "\n";
         out << c.receiver.addon << "\n";
         out << c.receiver.port << "\n";
+        out << static_cast<int>(c.policy.mode) << " " << std::setprecision(15) << c.policy.value << "\n";
     }
 
     return true;
@@ -362,10 +1145,11 @@ bool PortManager::LoadFromFile(const std::string &filename) {
         std::cerr << "[PortManager] Failed to read magic from file\n";
         return false;
     }
-    if (magic != "PMv1") {
+    if (magic != "PMv1" && magic != "PMv2") {
         std::cerr << "[PortManager] Unsupported file format: " << magic << "\n";
         return false;
     }
+    const bool withPolicies = magic == "PMv2";
 
     std::size_t numPorts = 0;
     std::size_t numConns = 0;
@@ -378,8 +1162,11 @@ bool PortManager::LoadFromFile(const std::string &filename) {
 
     in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
 
+    std::lock_guard<std::mutex> lock(graphMutex_);
+    ReleaseRoutes();
     ports_.clear();
     connections_.clear();
+    nextPortId_ = 0;
 
     // ---- Load ports ----
     for (std::size_t i = 0; i < numPorts; ++i) {
@@ -418,6 +1205,8 @@ bool PortManager::LoadFromFile(const std::string &filename) {
         info.key       = key;
         info.desc      = desc;
         info.transport = nullptr; // will be recreated on Connect/OpenPort
+        info.id        = nextPortId_++;
+        info.addonId   = AddonId(key.addon);
 
         ports_.emplace(key, std::move(info));
     }
@@ -446,7 +1235,29 @@ bool PortManager::LoadFromFile(const std::string &filename) {
             return false;
         }
 
+        if (withPolicies) {
+            int    modeInt = 0;
+            double value   = 0;
+            if (!(in >> modeInt >> value) || modeInt < 0 ||
+                modeInt > static_cast<int>(DeliveryPolicy::Mode::Conflate)) {
+                std::cerr << "[PortManager] Failed to read delivery policy for connection "
+                          << i << "\n";
+                return false;
+            }
+            in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            c.policy = {static_cast<DeliveryPolicy::Mode>(modeInt), value};
+
+            std::string why;
+            const auto  prov = ports_.find(c.provider);
+            if (prov != ports_.end() && !ValidatePolicy(c.policy, prov->second.desc, why)) {
+                std::cerr << "[PortManager] Invalid delivery policy for connection " << i << ": " << why << "\n";
+                return false;
+            }
+        }
+
+        c.id = static_cast<std::uint32_t>(connections_.size());
         connections_.push_back(std::move(c));
+        Link(connections_.back());
     }
 
     return true;
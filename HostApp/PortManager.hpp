@@ -1,11 +1,49 @@
 #pragma once
+#include <deque>
 #include <map>
 #include <set>
 #include <vector>
 #include <string>
+#include <memory>
+#include <mutex>
 #include <iostream>
 #include "../include/PluginAPI.hpp"
 #include "AddOnManager.hpp" // for IHostPortServices
+#include "HostClock.hpp"
+#include "HostLogger.hpp"
+#include "PortRecorder.hpp"
+#include "PortMetrics.hpp"
+#include "RcuDomain.hpp"
+#include "ResourceStore.hpp"
+#include "TransportArena.hpp"
+
+// Which writes of a Buffered provider reach one connection
+// (PortManager::Connect(), saved with the graph). Decided in Route() before
+// anything is copied, so a slow reader behind a fast writer costs neither
+// bandwidth nor slot updates.
+//  - All:      every write (default)
+//  - EveryNth: writes 0, N, 2N, ... of the provider
+//  - MaxRate:  a write only if 1/Hz passed since the last one delivered,
+//              on the host clock (Now())
+//  - Conflate: the reader gets the provider's single shared copy of its
+//              latest write; each write is copied once, however many
+//              Conflate readers there are
+struct DeliveryPolicy {
+        enum struct Mode : std::uint8_t { All, EveryNth, MaxRate, Conflate };
+
+        Mode   mode  = Mode::All;
+        double value = 0; // N for EveryNth, Hz for MaxRate
+
+        static DeliveryPolicy EveryNth(std::uint32_t n) {
+            return {Mode::EveryNth, static_cast<double>(n)};
+        }
+        static DeliveryPolicy MaxRate(double hz) {
+            return {Mode::MaxRate, hz};
+        }
+        static DeliveryPolicy Conflate() {
+            return {Mode::Conflate, 0};
+        }
+};
 
 class PortManager: public IHostPortServices, public PluginAPI::IHostServices {
     public:
@@ -19,58 +57,338 @@ class PortManager: public IHostPortServices, public PluginAPI::IHostServices {
                 }
         };
 
+        struct Connection;
+
         struct PortInfo {
                 PortKey                   key;
                 PluginAPI::PortDescriptor desc;
                 void                     *transport = nullptr; // used for Direct; null for Buffered
+                std::uint32_t             id        = 0;       // stable numeric id (recording, metrics)
+                std::uint32_t             addonId   = 0;       // index of the owning addon (origin tracking)
+                std::uint64_t             directSeq = 0;       // Direct output: sequence metrics counted up to
+
+                // Buffered routes, resolved at Connect() so Read/Write never search.
+                // Both are swapped as a whole when the graph changes; the data
+                // path loads them atomically (see EnableRewiring()).
+                PortManager                     *owner      = nullptr;
+                Connection                      *inbound    = nullptr;       // receiver: its provider's connection
+                const std::vector<Connection *> *outbound   = &kNoOutbound; // provider: every connection it feeds
+                std::uint64_t                    retiredSeq = 0;            // receiver: last sequence of a removed inbound
+
+                // Set by GraphOptimizer before the addons initialize: OpenPort()
+                // hands out a no-op handle for pruned ports and the single-reader
+                // write path for `link` providers
+                bool pruned = false;
+                bool link   = false;
+
+                // Provider: latest payload, shared by its Conflate connections
+                std::uint8_t *latest = nullptr;
+
+                // MappedFile input: the file bound by BindResource()
+                const ResourceStore::Resource *resource = nullptr;
+
+                // What a Buffered handle from OpenPort() points to; ctx is this PortInfo
+                PluginAPI::PortFastPath fast{};
+        };
+
+
+        // Buffered transport state of one connection, followed by its
+        // payload in the transport arena (shared with isolated runners)
+        struct Slot {
+                PluginAPI::MessageHeader header;          // stamped on every write
+                std::uint64_t            lastReadSeq = 0; // header.sequence at the last Read()
+                std::uint8_t             hasData     = 0;
+                std::uint8_t             unread      = 0; // written since the last Read()
         };
 
         struct Connection {
                 PortKey provider;
                 PortKey receiver;
 
-                // For buffered ports:
-                std::vector<std::uint8_t> buffer;
-                bool                      hasData = false;
+                // For buffered ports (allocated by Link()):
+                Slot         *slot  = nullptr;
+                std::uint8_t *data  = nullptr; // payload, `bytes` long
+                std::size_t   bytes = 0;
+
+                std::uint32_t id = 0; // index at creation (metrics)
+
+                DeliveryPolicy policy;
+                std::uint64_t  intervalNs = 0; // MaxRate: 1e9 / Hz
+                std::uint64_t  nextNs     = 0; // MaxRate: earliest next delivery
+                std::uint32_t  countdown  = 0; // EveryNth: writes left to skip
+
+                bool removed = false; // Disconnect()ed; kept for its id, and its slot for late readers
         };
 
+        PortManager() = default;
+        ~PortManager() override;
+
         // Called by AddOnManager before pushing ports of one addon
         void BeginAddon(const std::string &addonName);
 
         // IHostPortServices
-        void CreatePort(const PluginAPI::PortDescriptor &desc) override;
+        void  CreatePort(const PluginAPI::PortDescriptor &desc) override;
+        void  UseAddonMemory(std::pmr::memory_resource *mr) override;
+        void  EndCycle() override;
+        void *ResolveInput(const std::string &addon, const std::string &port) override;
+        bool  PeekInput(void *input, PluginAPI::JoinView &out) override;
+        void  ConsumeInput(void *input) override;
 
-        // Connect by keys
-        bool Connect(const PortKey &provider, const PortKey &receiver);
+        // Connect by keys; a policy other than All needs Buffered ports
+        bool Connect(const PortKey &provider, const PortKey &receiver, const DeliveryPolicy &policy = {});
 
         // Convenience connect by names
         bool Connect(const std::string &providerAddon, const std::string &providerPort,
-            const std::string &receiverAddon, const std::string &receiverPort);
+            const std::string &receiverAddon, const std::string &receiverPort,
+            const DeliveryPolicy &policy = {});
+
+        // Buffered connections only; the connection stays in connections()
+        // with `removed` set
+        bool Disconnect(const PortKey &provider, const PortKey &receiver);
+
+        // Resource ports (PortType::MappedFile inputs, see ResourcePort.hpp)
+        // are bound to a file instead of connected. The file is mapped once
+        // (see ResourceStore), and its header must match the port's TypeHash
+        // and PayloadSize. Call before the addons open their ports.
+        bool BindResource(const PortKey &port, const std::string &path);
+        const ResourceStore &resources() const {
+            return resources_;
+        }
+
+        // Runtime rewiring: call before the addons open their ports. From
+        // then on Connect() and Disconnect() may run on a control thread
+        // while addons read and write. A change publishes a new route array
+        // for the provider (one atomic store) and frees the old one after
+        // an RCU grace period, so the data path never waits or locks; each
+        // Write() pays two thread-local stores for its read-side section.
+        // Buffered inputs then read their version through the ops (no
+        // cached header pointer), and a new inbound continues the sequence
+        // of the one it replaces. Not with isolated runners (they keep the
+        // routes they forked with), batch mode, or ports the GraphOptimizer
+        // pruned or specialized.
+        bool EnableRewiring();
+        bool rewiring() const {
+            return rewiring_;
+        }
+
+        // Host code walking connections() while a control thread may rewire
+        std::unique_lock<std::mutex> LockGraph() const {
+            return std::unique_lock<std::mutex>(graphMutex_);
+        }
 
         const std::map<PortKey, PortInfo> &ports() const {
             return ports_;
         }
-        const std::vector<Connection> &connections() const {
+        // deque: PortInfo routes point into it
+        const std::deque<Connection> &connections() const {
+            return connections_;
+        }
+        std::deque<Connection> &connections() {
             return connections_;
         }
 
+        PortInfo *FindPort(const PortKey &key);
+
         void PrintPorts() const;
         void PrintConnections() const;
 
         PluginAPI::PortHandle OpenPort(const char *name) override;
         bool                  Read(PluginAPI::PortHandle h, void *dst, size_t bytes, size_t &outBytes) override;
         bool                  Write(PluginAPI::PortHandle h, const void *src, size_t bytes, size_t &outBytes) override;
+        bool                  ReadHeader(PluginAPI::PortHandle h, PluginAPI::MessageHeader &out) override;
+        bool                  FastPaths() override {
+            return true;
+        }
+        std::pmr::memory_resource *Memory() override;
+        std::uint64_t              Now() override;
+
+        // Time source for Now() (and replay timing); null = steady clock
+        void UseClock(HostClock *clock) {
+            clock_ = clock;
+        }
+        HostClock *clock() const {
+            return clock_;
+        }
+
+        // LogRecord() goes to `logger`'s rings; null = formatted on the spot
+        std::uint32_t RegisterLogSite(PluginAPI::LogLevel level, const char *format,
+            std::uint32_t maxPerSecond) override;
+        void          LogRecord(std::uint32_t site, const PluginAPI::LogArg *args, std::size_t count) override;
+        void          UseLogger(HostLogger *logger) {
+            logger_ = logger;
+        }
 
         // Project functionalities
         bool SaveToFile(const std::string &filename) const;
         bool LoadFromFile(const std::string &filename);
 
+        // Traffic recording: every Buffered write plus the state of each
+        // Direct output once per cycle (see PortRecorder / PortReplayer).
+        bool StartRecording(const std::string &filename);
+        void StopRecording();
+
+        // Traffic counters for every port/connection that exists when enabled
+        void               EnableMetrics();
+        void               DisableMetrics();
+        const PortMetrics *metrics() const {
+            return metrics_.get();
+        }
+        PortMetrics *metrics() {
+            return metrics_.get();
+        }
+
+        // Allocate every transport from one MAP_SHARED region so processes
+        // forked later (RunnerPool) share them; call before Connect()
+        bool UseSharedTransports(std::size_t capacity = TransportArena::kDefaultSharedBytes);
+        // Back every transport with pre-faulted, mlock()ed memory, from
+        // hugepages when reserved (see TransportArena); call before Connect()
+        bool UseLowJitterTransports(std::size_t capacity = TransportArena::kDefaultLowJitterBytes);
+        const TransportArena &arena() const {
+            return arena_;
+        }
+
+        // NUMA placement (see NumaPlacement), before the addons open their
+        // ports: copy a transport into memory on `node` (kernel number) and
+        // repoint everything that uses it. A Buffered connection moves its
+        // slot and payload (a Conflate one only its slot), a Direct provider
+        // the block its receivers share. The old block stays in the arena.
+        bool MoveToNode(Connection &c, int node);
+        bool MoveToNode(const PortKey &directProvider, int node);
+
+        // Warm-up cycles (HostApp --warmup) exercise the transports without
+        // being recorded or counted: the recorder and the metrics are set
+        // aside until EndWarmUp()
+        void BeginWarmUp() override;
+        void EndWarmUp() override;
+
+        // In a forked runner: drop (without flushing) the recorder and
+        // metrics inherited from the host, which belong to the host process
+        void DetachForRunner() override;
+
+        // Replay: publish data as if the port's addon had written it
+        bool Inject(PortInfo &pi, const void *src, size_t bytes);
+
+        // Offline batch mode (PortReplayer --batch): Buffered writes queue
+        // up per connection instead of overwriting the slot, so a runBatch()
+        // consumer sees every frame of the batch through ReadBatch(). Not
+        // for isolated runners (the queues live in the host only).
+        static constexpr std::uint32_t kWholeBatch = UINT32_MAX;
+        void                           BeginBatch(std::size_t cycles);
+        void                           EndBatch();
+        bool                           batching() const {
+            return batchCycles_ != 0;
+        }
+        // Cycle of the batch that following writes belong to; kWholeBatch
+        // while an addon runs runBatch() (its k-th write counts as cycle k)
+        void SetBatchCycle(std::uint32_t cycle) {
+            batchCycle_ = cycle;
+        }
+        // run() fallback: deliver the newest frame queued for cycle <= `cycle`
+        // to each of `addon`'s inputs, as if it had been routed just now
+        void StepInputs(const std::string &addon, std::uint32_t cycle);
+        // End of a batch: every slot gets its connection's newest frame
+        void FlushBatch();
+
+        std::size_t ReadBatch(PluginAPI::PortHandle h, void *dst, size_t frameBytes, size_t maxFrames) override;
+
     private:
-        static bool Validate(const PluginAPI::PortDescriptor &prov,
+        static PortInfo *PortOf(PluginAPI::PortHandle h);
+        static bool      Validate(const PluginAPI::PortDescriptor &prov,
             const PluginAPI::PortDescriptor                  &recv,
             std::string                                      &why);
+        static bool ValidatePolicy(const DeliveryPolicy &policy, const PluginAPI::PortDescriptor &prov, std::string &why);
+
+        bool Route(const PortInfo &pi, const void *src, size_t bytes, size_t &outBytes,
+            std::uint64_t originNs, std::uint32_t originPort);
 
+        void Link(Connection &c);
+        void Publish(PortInfo &prov, std::vector<Connection *> routes);
+        void ReleaseRoutes();
+        bool Rewirable(const PortInfo &prov, const char *what) const;
+        bool Movable(const char *what) const;
+        bool Admit(Connection &c);
+        bool ReadPort(PortInfo &pi, void *dst, size_t bytes, size_t &outBytes);
+        bool WritePort(PortInfo &pi, const void *src, size_t bytes, size_t &outBytes);
+        void NoteRead(const PortInfo &pi, Connection &conn, size_t bytes);
+        // Direct outputs never pass through Write(): their stamped sequence
+        // numbers since the last call become writes (or only the baseline)
+        void CountDirectWrites(bool count);
+        void NoteOrigin(const PortInfo &pi, const PluginAPI::MessageHeader &hdr);
+
+        // PortHandle::ops for Buffered ports; ctx is the PortInfo
+        static bool                          OpsRead(void *ctx, void *dst, std::size_t bytes);
+        static bool                          OpsWrite(void *ctx, const void *src, std::size_t bytes);
+        static bool                          OpsReadHeader(void *ctx, PluginAPI::MessageHeader &out);
+        static bool                          OpsWriteLink(void *ctx, const void *src, std::size_t bytes);
+        static bool                          OpsPrunedRead(void *ctx, void *dst, std::size_t bytes);
+        static bool                          OpsPrunedWrite(void *ctx, const void *src, std::size_t bytes);
+        static bool                          OpsPrunedReadHeader(void *ctx, PluginAPI::MessageHeader &out);
+        static const PluginAPI::TransportOps kBufferedOps;
+        static const PluginAPI::TransportOps kLinkOps;
+        static const PluginAPI::TransportOps kPrunedOps;
+
+        static const std::vector<Connection *> kNoOutbound;
+
+        // Buffered block: [Slot | pad to 64][payload]
+        static constexpr std::size_t kSlotBytes = (sizeof(Slot) + 63) & ~std::size_t(63);
+
+        // Route loads for the data path; plain fields, atomic accesses
+        static Connection *Inbound(const PortInfo &pi) {
+            return std::atomic_ref<Connection *>(const_cast<Connection *&>(pi.inbound)).load(std::memory_order_acquire);
+        }
+        static const std::vector<Connection *> &Outbound(const PortInfo &pi) {
+            using Routes = const std::vector<Connection *> *;
+            return *std::atomic_ref<Routes>(const_cast<Routes &>(pi.outbound)).load(std::memory_order_acquire);
+        }
+
+        std::uint32_t AddonId(const std::string &addon);
+
+        // Oldest input an addon read during the current cycle; its writes inherit it
+        struct Origin {
+                std::uint64_t cycle    = UINT64_MAX;
+                std::uint64_t originNs = 0;
+                std::uint32_t port     = 0;
+        };
+
+        // Frames routed into one connection during a batch
+        struct BatchQueue {
+                struct Frame {
+                        PluginAPI::MessageHeader header;
+                        std::uint32_t            cycle = 0;
+                };
+                std::vector<std::uint8_t> data; // frame payloads back to back, conn.bytes each
+                std::vector<Frame>        frames;
+                std::size_t               read      = 0; // next frame for ReadBatch()
+                std::size_t               delivered = 0; // frames already passed by StepInputs()
+        };
+        PluginAPI::MessageHeader &Enqueue(Connection &conn, const void *src, size_t bytes);
+        void                      Deliver(Connection &conn, std::size_t frame);
+
+        TransportArena              arena_;
+        ResourceStore               resources_;
         std::string                 currentAddon_;
+        std::pmr::memory_resource  *currentMemory_ = nullptr; // of currentAddon_, see UseAddonMemory()
+        HostClock                  *clock_         = nullptr;
+        HostLogger                 *logger_        = nullptr;
         std::map<PortKey, PortInfo> ports_;
-        std::vector<Connection>     connections_;
+        std::deque<Connection>      connections_;
+        std::uint32_t               nextPortId_ = 0;
+        bool                        opened_     = false; // an addon called OpenPort()
+
+        std::map<std::string, std::uint32_t> addonIds_;
+        std::vector<Origin>                  origins_; // by addonId
+        std::uint64_t                        cycle_ = 0;
+
+        std::vector<BatchQueue> batch_;           // by Connection::id, while batching()
+        std::size_t             batchCycles_ = 0; // BeginBatch(), 0 = off
+        std::uint32_t           batchCycle_  = 0;
+
+        std::unique_ptr<PortRecorder> recorder_;
+        std::unique_ptr<PortMetrics>  metrics_;
+        std::unique_ptr<PortRecorder> warmRecorder_; // set aside by BeginWarmUp()
+        std::unique_ptr<PortMetrics>  warmMetrics_;
+
+        mutable std::mutex graphMutex_; // serializes Connect/Disconnect/LoadFromFile
+        RcuDomain          rcu_;        // Route() readers of PortInfo::outbound
+        bool               rewiring_ = false;
 };
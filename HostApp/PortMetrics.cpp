@@ -0,0 +1,130 @@
+#include "PortMetrics.hpp"
+#include <iomanip>
+
+std::uint64_t PortMetrics::Snapshot::LatencySamples() const {
+    std::uint64_t n = 0;
+    for (auto v : latency)
+        n += v;
+    return n;
+}
+
+namespace {
+    std::uint64_t BucketPercentile(const std::array<std::uint64_t, PortMetrics::kLatencyBuckets> &h, double p) {
+        std::uint64_t total = 0;
+        for (auto v : h)
+            total += v;
+        if (total == 0)
+            return 0;
+        const auto    rank = static_cast<std::uint64_t>(p * static_cast<double>(total - 1));
+        std::uint64_t seen = 0;
+        for (std::size_t b = 0; b < h.size(); ++b) {
+            seen += h[b];
+            if (seen > rank)
+                return std::uint64_t(1) << b;
+        }
+        return std::uint64_t(1) << (h.size() - 1);
+    }
+} // namespace
+
+std::uint64_t PortMetrics::Snapshot::LatencyPercentile(double p) const {
+    return BucketPercentile(latency, p);
+}
+
+std::uint64_t PortMetrics::Snapshot::EndToEndPercentile(double p) const {
+    return BucketPercentile(endToEnd, p);
+}
+
+PortMetrics::PortMetrics(std::vector<std::string> portNames, std::vector<std::string> connNames)
+    : portNames_(std::move(portNames)), connNames_(std::move(connNames)) {
+    for (auto &s : shards_) {
+        s.ports = std::make_unique<Counters[]>(portNames_.size());
+        s.conns = std::make_unique<Counters[]>(connNames_.size());
+    }
+}
+
+PortMetrics::~PortMetrics() {
+    StopPeriodicDump();
+}
+
+PortMetrics::Snapshot PortMetrics::Sum(const Shard *shards,
+    std::unique_ptr<Counters[]> Shard::*which,
+    std::uint32_t idx) {
+    Snapshot out;
+    for (std::size_t s = 0; s < kShards; ++s) {
+        const Counters &c = (shards[s].*which)[idx];
+        out.writes += c.writes.load(std::memory_order_relaxed);
+        out.reads += c.reads.load(std::memory_order_relaxed);
+        out.bytesIn += c.bytesIn.load(std::memory_order_relaxed);
+        out.bytesOut += c.bytesOut.load(std::memory_order_relaxed);
+        out.emptyReads += c.emptyReads.load(std::memory_order_relaxed);
+        out.drops += c.drops.load(std::memory_order_relaxed);
+        out.skipped += c.skipped.load(std::memory_order_relaxed);
+        out.filtered += c.filtered.load(std::memory_order_relaxed);
+        for (std::size_t b = 0; b < kLatencyBuckets; ++b) {
+            out.latency[b] += c.latency[b].load(std::memory_order_relaxed);
+            out.endToEnd[b] += c.endToEnd[b].load(std::memory_order_relaxed);
+        }
+    }
+    return out;
+}
+
+PortMetrics::Snapshot PortMetrics::Port(std::uint32_t port) const {
+    return port < portNames_.size() ? Sum(shards_, &Shard::ports, port) : Snapshot{};
+}
+
+PortMetrics::Snapshot PortMetrics::Connection(std::uint32_t conn) const {
+    return conn < connNames_.size() ? Sum(shards_, &Shard::conns, conn) : Snapshot{};
+}
+
+void PortMetrics::PrintSummary(std::ostream &os) const {
+    os << "\n[PortMetrics] Ports:\n";
+    for (std::uint32_t i = 0; i < portNames_.size(); ++i) {
+        const auto s = Port(i);
+        if (s.writes == 0 && s.reads == 0 && s.emptyReads == 0)
+            continue;
+        os << "  " << std::left << std::setw(32) << portNames_[i] << std::right
+           << " writes=" << s.writes
+           << " reads=" << s.reads
+           << " empty=" << s.emptyReads
+           << " in=" << s.bytesIn << "B"
+           << " out=" << s.bytesOut << "B\n";
+    }
+
+    os << "[PortMetrics] Connections:\n";
+    for (std::uint32_t i = 0; i < connNames_.size(); ++i) {
+        const auto s = Connection(i);
+        os << "  " << connNames_[i]
+           << " | writes=" << s.writes
+           << " reads=" << s.reads
+           << " empty=" << s.emptyReads
+           << " drops=" << s.drops
+           << " skipped=" << s.skipped;
+        if (s.filtered)
+            os << " filtered=" << s.filtered;
+        os << " | latency p50<=" << s.LatencyPercentile(0.50) << "ns"
+           << " p99<=" << s.LatencyPercentile(0.99) << "ns"
+           << " | end-to-end p50<=" << s.EndToEndPercentile(0.50) << "ns"
+           << " p99<=" << s.EndToEndPercentile(0.99) << "ns\n";
+    }
+}
+
+void PortMetrics::StartPeriodicDump(std::chrono::milliseconds interval, std::ostream &os) {
+    StopPeriodicDump();
+    dumpStop_ = false;
+    dumper_   = std::thread([this, interval, &os] {
+        std::unique_lock lock(dumpMutex_);
+        while (!dumpCv_.wait_for(lock, interval, [this] { return dumpStop_; }))
+            PrintSummary(os);
+    });
+}
+
+void PortMetrics::StopPeriodicDump() {
+    if (!dumper_.joinable())
+        return;
+    {
+        std::lock_guard lock(dumpMutex_);
+        dumpStop_ = true;
+    }
+    dumpCv_.notify_all();
+    dumper_.join();
+}
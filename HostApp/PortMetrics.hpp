@@ -0,0 +1,161 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Per-port and per-connection traffic counters.
+//
+// Every counter lives in one of kShards per-thread shards and is bumped with
+// relaxed atomics, so concurrent writers never share a cache line in the
+// common case. Queries sum the shards.
+class PortMetrics {
+    public:
+        static constexpr std::size_t kShards         = 16;
+        static constexpr std::size_t kLatencyBuckets = 40; // bucket i: [2^(i-1), 2^i) ns
+
+        struct Snapshot {
+                std::uint64_t writes     = 0;
+                std::uint64_t reads      = 0;
+                std::uint64_t bytesIn    = 0; // written into the port / connection
+                std::uint64_t bytesOut   = 0; // read out of it
+                std::uint64_t emptyReads = 0; // Read() with nothing written yet
+                std::uint64_t drops      = 0; // overwritten before anyone read it
+                std::uint64_t skipped    = 0; // sequence numbers never seen by the reader
+                std::uint64_t filtered   = 0; // writes held back by the delivery policy
+
+                std::array<std::uint64_t, kLatencyBuckets> latency{};    // write->read, ns
+                std::array<std::uint64_t, kLatencyBuckets> endToEnd{};   // chain origin->read, ns
+
+                std::uint64_t LatencySamples() const;
+                // Upper bound of the bucket holding the p-th percentile (0..1), in ns
+                std::uint64_t LatencyPercentile(double p) const;
+                std::uint64_t EndToEndPercentile(double p) const;
+        };
+
+        PortMetrics(std::vector<std::string> portNames, std::vector<std::string> connNames);
+        ~PortMetrics();
+
+        PortMetrics(const PortMetrics &)            = delete;
+        PortMetrics &operator=(const PortMetrics &) = delete;
+
+        // -------- Hot path (ids outside the enabled range are ignored) --------
+        void OnWrite(std::uint32_t port, std::size_t bytes, std::uint64_t count = 1) {
+            if (auto *c = PortCounters(port)) {
+                Bump(c->writes, count);
+                Bump(c->bytesIn, bytes * count);
+            }
+        }
+        void OnDeliver(std::uint32_t conn, std::size_t bytes, bool overwroteUnread) {
+            if (auto *c = ConnCounters(conn)) {
+                Bump(c->writes);
+                Bump(c->bytesIn, bytes);
+                if (overwroteUnread)
+                    Bump(c->drops);
+            }
+        }
+        void OnFiltered(std::uint32_t conn) {
+            if (auto *c = ConnCounters(conn))
+                Bump(c->filtered);
+        }
+        // `fresh`: the sequence advanced since the last read; a re-read of the
+        // same value is counted but is no latency sample
+        void OnRead(std::uint32_t port, std::uint32_t conn, std::size_t bytes,
+            std::uint64_t latencyNs, std::uint64_t endToEndNs, std::uint64_t skipped, bool fresh) {
+            if (auto *c = PortCounters(port)) {
+                Bump(c->reads);
+                Bump(c->bytesOut, bytes);
+            }
+            if (auto *c = ConnCounters(conn)) {
+                Bump(c->reads);
+                Bump(c->bytesOut, bytes);
+                if (fresh) {
+                    Bump(c->latency[LatencyBucket(latencyNs)]);
+                    Bump(c->endToEnd[LatencyBucket(endToEndNs)]);
+                }
+                if (skipped)
+                    Bump(c->skipped, skipped);
+            }
+        }
+        void OnEmptyRead(std::uint32_t port, std::uint32_t conn) {
+            if (auto *c = PortCounters(port))
+                Bump(c->emptyReads);
+            if (auto *c = ConnCounters(conn))
+                Bump(c->emptyReads);
+        }
+
+        // -------- Query --------
+        Snapshot Port(std::uint32_t port) const;
+        Snapshot Connection(std::uint32_t conn) const;
+
+        std::size_t PortCount() const {
+            return portNames_.size();
+        }
+        std::size_t ConnectionCount() const {
+            return connNames_.size();
+        }
+
+        void PrintSummary(std::ostream &os) const;
+
+        // Background thread printing PrintSummary() every `interval`
+        void StartPeriodicDump(std::chrono::milliseconds interval, std::ostream &os);
+        void StopPeriodicDump();
+
+    private:
+        struct alignas(64) Counters {
+                std::atomic<std::uint64_t> writes{0};
+                std::atomic<std::uint64_t> reads{0};
+                std::atomic<std::uint64_t> bytesIn{0};
+                std::atomic<std::uint64_t> bytesOut{0};
+                std::atomic<std::uint64_t> emptyReads{0};
+                std::atomic<std::uint64_t> drops{0};
+                std::atomic<std::uint64_t> skipped{0};
+                std::atomic<std::uint64_t> filtered{0};
+
+                std::array<std::atomic<std::uint64_t>, kLatencyBuckets> latency{};
+                std::array<std::atomic<std::uint64_t>, kLatencyBuckets> endToEnd{};
+        };
+
+        struct Shard {
+                std::unique_ptr<Counters[]> ports;
+                std::unique_ptr<Counters[]> conns;
+        };
+
+        static void Bump(std::atomic<std::uint64_t> &c, std::uint64_t n = 1) {
+            c.fetch_add(n, std::memory_order_relaxed);
+        }
+        static std::size_t LatencyBucket(std::uint64_t ns) {
+            return std::min<std::size_t>(std::bit_width(ns), kLatencyBuckets - 1);
+        }
+        static std::size_t ThisShard() {
+            static std::atomic<std::size_t> next{0};
+            thread_local const std::size_t  shard = next.fetch_add(1, std::memory_order_relaxed) % kShards;
+            return shard;
+        }
+        static Snapshot    Sum(const Shard *shards, std::unique_ptr<Counters[]> Shard::*which, std::uint32_t idx);
+
+        Counters *PortCounters(std::uint32_t port) {
+            return port < portNames_.size() ? &shards_[ThisShard()].ports[port] : nullptr;
+        }
+        Counters *ConnCounters(std::uint32_t conn) {
+            return conn < connNames_.size() ? &shards_[ThisShard()].conns[conn] : nullptr;
+        }
+
+        std::vector<std::string> portNames_;
+        std::vector<std::string> connNames_;
+        Shard                    shards_[kShards];
+
+        std::thread             dumper_;
+        std::mutex              dumpMutex_;
+        std::condition_variable dumpCv_;
+        bool                    dumpStop_ = false;
+};
@@ -0,0 +1,166 @@
+#include "PortRecorder.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+using namespace PortLog;
+
+namespace {
+    std::uint64_t NowNs() {
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch())
+                .count());
+    }
+
+    std::size_t RoundUpPow2(std::size_t n) {
+        std::size_t p = 1;
+        while (p < n)
+            p <<= 1;
+        return p;
+    }
+} // namespace
+
+PortRecorder::~PortRecorder() {
+    Stop();
+}
+
+bool PortRecorder::Start(const std::string &filename,
+    const std::vector<PortEntry>           &ports,
+    std::size_t                             ringBytes,
+    std::size_t                             chunkBytes) {
+    Stop();
+
+    // Header + port table
+    std::size_t tableBytes = sizeof(LogHeader);
+    for (const auto &p : ports)
+        tableBytes += Align8(sizeof(LogPortEntry) + p.addon.size() + p.port.size());
+
+    chunkBytes_ = chunkBytes;
+    if (!file_.open(filename, MappedFile::Mode::ReadWrite) || !EnsureMapped(tableBytes)) {
+        std::cerr << "[PortRecorder] Failed to open log file: " << filename << "\n";
+        return false;
+    }
+
+    auto     *base = file_.data();
+    LogHeader hdr{};
+    std::memcpy(hdr.magic, kMagic, sizeof(kMagic));
+    hdr.portCount  = static_cast<std::uint32_t>(ports.size());
+    hdr.dataOffset = tableBytes;
+    hdr.dataBytes  = 0;
+    std::memcpy(base, &hdr, sizeof(hdr));
+
+    std::size_t pos = sizeof(LogHeader);
+    for (const auto &p : ports) {
+        LogPortEntry e{};
+        e.id          = p.id;
+        e.payloadSize = p.payloadSize;
+        e.typeHash    = p.typeHash;
+        e.addonLen    = static_cast<std::uint16_t>(p.addon.size());
+        e.portLen     = static_cast<std::uint16_t>(p.port.size());
+        e.policy      = p.policy;
+        std::memcpy(base + pos, &e, sizeof(e));
+        std::memcpy(base + pos + sizeof(e), p.addon.data(), p.addon.size());
+        std::memcpy(base + pos + sizeof(e) + p.addon.size(), p.port.data(), p.port.size());
+        pos += Align8(sizeof(e) + p.addon.size() + p.port.size());
+    }
+    writePos_ = tableBytes;
+
+    ring_.assign(RoundUpPow2(ringBytes), 0);
+    ringMask_ = ring_.size() - 1;
+    head_.store(0, std::memory_order_relaxed);
+    tail_.store(0, std::memory_order_relaxed);
+    sequence_ = 0;
+    dropped_.store(0, std::memory_order_relaxed);
+
+    running_.store(true, std::memory_order_release);
+    writer_ = std::thread(&PortRecorder::WriterLoop, this);
+
+    std::cout << "[PortRecorder] Recording " << ports.size() << " ports to " << filename << "\n";
+    return true;
+}
+
+void PortRecorder::Stop() {
+    if (!running_.exchange(false))
+        return;
+    if (writer_.joinable())
+        writer_.join();
+    Drain();
+
+    std::cout << "[PortRecorder] Stopped: " << sequence_ << " records, "
+              << Dropped() << " dropped, " << writePos_ << " bytes\n";
+    file_.close(writePos_);
+}
+
+void PortRecorder::Append(std::uint32_t portId, const void *src, std::size_t bytes) {
+    const std::size_t total = Align8(sizeof(RecordHeader) + bytes);
+    const auto        head  = head_.load(std::memory_order_relaxed);
+    const auto        tail  = tail_.load(std::memory_order_acquire);
+
+    if (total > ring_.size() - (head - tail)) {
+        // Never block the addon thread: count and drop.
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    RecordHeader rh{portId, static_cast<std::uint32_t>(bytes), sequence_++, NowNs()};
+
+    auto put = [&](std::uint64_t at, const void *p, std::size_t n) {
+        const std::size_t off   = static_cast<std::size_t>(at) & ringMask_;
+        const std::size_t first = std::min(n, ring_.size() - off);
+        std::memcpy(ring_.data() + off, p, first);
+        std::memcpy(ring_.data(), static_cast<const std::uint8_t *>(p) + first, n - first);
+    };
+    put(head, &rh, sizeof(rh));
+    if (bytes)
+        put(head + sizeof(rh), src, bytes);
+
+    head_.store(head + total, std::memory_order_release);
+}
+
+void PortRecorder::MarkCycle() {
+    Append(kCycleMarker, nullptr, 0);
+}
+
+void PortRecorder::WriterLoop() {
+    while (running_.load(std::memory_order_acquire)) {
+        if (!Drain())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+// Copy everything published in the ring into the mapped log.
+bool PortRecorder::Drain() {
+    const auto tail = tail_.load(std::memory_order_relaxed);
+    const auto head = head_.load(std::memory_order_acquire);
+    if (head == tail)
+        return false;
+
+    const std::size_t n = static_cast<std::size_t>(head - tail);
+    if (!EnsureMapped(writePos_ + n)) {
+        std::cerr << "[PortRecorder] Failed to grow log, dropping " << n << " bytes\n";
+        tail_.store(head, std::memory_order_release);
+        return false;
+    }
+
+    const std::size_t off   = static_cast<std::size_t>(tail) & ringMask_;
+    const std::size_t first = std::min(n, ring_.size() - off);
+    std::memcpy(file_.data() + writePos_, ring_.data() + off, first);
+    std::memcpy(file_.data() + writePos_ + first, ring_.data(), n - first);
+    writePos_ += n;
+
+    auto *hdr      = reinterpret_cast<LogHeader *>(file_.data());
+    hdr->dataBytes = writePos_ - hdr->dataOffset;
+
+    tail_.store(head, std::memory_order_release);
+    return true;
+}
+
+// Grow the log file in whole chunks so remapping stays rare.
+bool PortRecorder::EnsureMapped(std::size_t bytes) {
+    if (bytes <= file_.size())
+        return true;
+    const std::size_t chunks = (bytes + chunkBytes_ - 1) / chunkBytes_;
+    return file_.resize(chunks * chunkBytes_);
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include "MappedFile.hpp"
+
+// ================================================================
+// Port traffic log format ("PRv1")
+//
+//   LogHeader
+//   LogPortEntry + addon name + port name     (x portCount, 8-byte aligned)
+//   RecordHeader + payload                    (8-byte aligned, until dataBytes)
+// ================================================================
+namespace PortLog {
+    inline constexpr char          kMagic[4]    = {'P', 'R', 'v', '1'};
+    inline constexpr std::uint32_t kCycleMarker = 0xFFFFFFFFu; // record with no payload, ends one host cycle
+
+    struct LogHeader {
+            char          magic[4];
+            std::uint32_t portCount;
+            std::uint64_t dataOffset; // first record
+            std::uint64_t dataBytes;  // bytes of records after dataOffset
+    };
+
+    struct LogPortEntry {
+            std::uint32_t id;
+            std::uint32_t payloadSize;
+            std::uint64_t typeHash;
+            std::uint16_t addonLen;
+            std::uint16_t portLen;
+            std::uint8_t  policy;
+            std::uint8_t  reserved[3];
+    };
+
+    struct RecordHeader {
+            std::uint32_t portId;
+            std::uint32_t bytes;
+            std::uint64_t sequence;
+            std::uint64_t timestampNs; // steady clock
+    };
+
+    constexpr std::size_t Align8(std::size_t n) {
+        return (n + 7) & ~std::size_t(7);
+    }
+} // namespace PortLog
+
+// Appends port writes into an in-memory SPSC ring (hot path: two memcpy)
+// and drains it into a chunked, memory-mapped log from a background thread.
+class PortRecorder {
+    public:
+        struct PortEntry {
+                std::uint32_t id = 0;
+                std::string   addon;
+                std::string   port;
+                std::uint32_t payloadSize = 0;
+                std::uint64_t typeHash    = 0;
+                std::uint8_t  policy      = 0;
+        };
+
+        PortRecorder() = default;
+        ~PortRecorder();
+
+        PortRecorder(const PortRecorder &)            = delete;
+        PortRecorder &operator=(const PortRecorder &) = delete;
+
+        bool Start(const std::string &filename,
+            const std::vector<PortEntry> &ports,
+            std::size_t                   ringBytes  = 8u << 20,
+            std::size_t                   chunkBytes = 16u << 20);
+        void Stop();
+
+        bool IsRecording() const {
+            return running_.load(std::memory_order_relaxed);
+        }
+
+        // Producer side: called from the thread that runs the addons.
+        void Append(std::uint32_t portId, const void *src, std::size_t bytes);
+        void MarkCycle();
+
+        std::uint64_t Recorded() const {
+            return sequence_;
+        }
+        std::uint64_t Dropped() const {
+            return dropped_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        void WriterLoop();
+        bool Drain();
+        bool EnsureMapped(std::size_t bytes);
+
+        // SPSC ring
+        std::vector<std::uint8_t>  ring_;
+        std::size_t                ringMask_ = 0;
+        std::atomic<std::uint64_t> head_{0}; // written by producer
+        std::atomic<std::uint64_t> tail_{0}; // written by writer thread
+        std::uint64_t              sequence_ = 0;
+        std::atomic<std::uint64_t> dropped_{0};
+
+        // Log file
+        MappedFile        file_;
+        std::size_t       chunkBytes_ = 0;
+        std::size_t       writePos_   = 0;
+        std::atomic<bool> running_{false};
+        std::thread       writer_;
+};
@@ -0,0 +1,199 @@
+#include "PortReplayer.hpp"
+#include "AddOnManager.hpp"
+#include "PortManager.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+using namespace PortLog;
+
+bool PortReplayer::Open(const std::string &filename) {
+    ports_.clear();
+    if (!file_.open(filename, MappedFile::Mode::ReadOnly) || file_.size() < sizeof(LogHeader)) {
+        std::cerr << "[PortReplayer] Failed to open log file: " << filename << "\n";
+        return false;
+    }
+
+    LogHeader hdr{};
+    std::memcpy(&hdr, file_.data(), sizeof(hdr));
+    if (std::memcmp(hdr.magic, kMagic, sizeof(kMagic)) != 0) {
+        std::cerr << "[PortReplayer] Unsupported log format: " << filename << "\n";
+        return false;
+    }
+    if (hdr.dataOffset > file_.size() || hdr.dataBytes > file_.size() - hdr.dataOffset) {
+        std::cerr << "[PortReplayer] Truncated log file: " << filename << "\n";
+        return false;
+    }
+    auto corrupt = [&](const char *what) {
+        std::cerr << "[PortReplayer] Corrupt log file (" << what << "): " << filename << "\n";
+        ports_.clear();
+        return false;
+    };
+
+    // The port table sits between the header and the first record
+    const std::size_t tableEnd = static_cast<std::size_t>(hdr.dataOffset);
+    std::size_t       pos      = sizeof(LogHeader);
+    for (std::uint32_t i = 0; i < hdr.portCount; ++i) {
+        LogPortEntry e{};
+        if (pos > tableEnd || tableEnd - pos < sizeof(e))
+            return corrupt("port table");
+        std::memcpy(&e, file_.data() + pos, sizeof(e));
+        if (tableEnd - pos - sizeof(e) < std::size_t(e.addonLen) + e.portLen)
+            return corrupt("port table");
+        if (e.id >= hdr.portCount)
+            return corrupt("port id");
+        const char *names = reinterpret_cast<const char *>(file_.data() + pos + sizeof(e));
+
+        if (e.id >= ports_.size())
+            ports_.resize(e.id + 1);
+        auto &p       = ports_[e.id];
+        p.addon       = std::string(names, e.addonLen);
+        p.port        = std::string(names + e.addonLen, e.portLen);
+        p.payloadSize = e.payloadSize;
+        p.typeHash    = e.typeHash;
+
+        pos += Align8(sizeof(e) + e.addonLen + e.portLen);
+    }
+
+    dataOffset_ = static_cast<std::size_t>(hdr.dataOffset);
+    dataBytes_  = static_cast<std::size_t>(hdr.dataBytes);
+
+    // Every record has to fit and name a port of the table (or end a cycle);
+    // Replay() then walks them without checks
+    const std::uint8_t *cur = file_.data() + dataOffset_;
+    const std::uint8_t *end = cur + dataBytes_;
+    while (cur != end) {
+        RecordHeader rh{};
+        if (static_cast<std::size_t>(end - cur) < sizeof(rh))
+            return corrupt("truncated record");
+        std::memcpy(&rh, cur, sizeof(rh));
+        if (static_cast<std::size_t>(end - cur) - sizeof(rh) < rh.bytes)
+            return corrupt("truncated record");
+        if (rh.portId != kCycleMarker && rh.portId >= ports_.size())
+            return corrupt("record port id");
+        cur += std::min(Align8(sizeof(rh) + rh.bytes), static_cast<std::size_t>(end - cur));
+    }
+
+    std::cout << "[PortReplayer] Opened " << filename << " (" << hdr.portCount
+              << " ports, " << dataBytes_ << " bytes)\n";
+    return true;
+}
+
+std::size_t PortReplayer::Replay(PortManager &ports,
+    AddOnManager                             &addons,
+    const std::set<std::string>              &replayAddons,
+    Timing                                    timing,
+    std::size_t                               batch) {
+    auto replayed = [&](const std::string &addon) {
+        return replayAddons.empty() || replayAddons.contains(addon);
+    };
+
+    // Resolve recorded ids to live ports once; nullptr = not injected
+    std::vector<PortManager::PortInfo *> targets(ports_.size(), nullptr);
+    for (std::size_t id = 0; id < ports_.size(); ++id) {
+        const auto &p = ports_[id];
+        if (p.addon.empty() || replayed(p.addon))
+            continue;
+
+        auto *pi = ports.FindPort({p.addon, p.port});
+        if (!pi) {
+            std::cerr << "[PortReplayer] Recorded port not present: "
+                      << p.addon << "::" << p.port << "\n";
+            continue;
+        }
+        if (pi->desc.PayloadSize != p.payloadSize || pi->desc.TypeHash != p.typeHash) {
+            std::cerr << "[PortReplayer] Payload mismatch, skipping "
+                      << p.addon << "::" << p.port << "\n";
+            continue;
+        }
+        targets[id] = pi;
+    }
+
+    // Only the replayed addons run; everything else comes from the log
+    std::vector<bool> wasEnabled;
+    for (auto &a : addons.addons()) {
+        wasEnabled.push_back(a.enabled);
+        a.enabled = replayed(a.name);
+    }
+
+    // Recorded timing follows the host clock: a virtual one skips the waits
+    HostClock     steady;
+    HostClock    &clock     = ports.clock() ? *ports.clock() : steady;
+    const auto    hostStart = clock.Now();
+    std::uint64_t firstTs   = 0;
+    bool          haveFirst = false;
+    std::size_t   cycles    = 0;
+    std::uint32_t pending   = 0; // cycles queued in the current batch
+
+    if (batch > 1) {
+        if (timing == Timing::Original)
+            std::cerr << "[PortReplayer] --batch replays as fast as possible; recorded timing ignored\n";
+        ports.BeginBatch(batch);
+    }
+
+    const std::uint8_t *cur = file_.data() + dataOffset_;
+    const std::uint8_t *end = cur + dataBytes_;
+    while (cur + sizeof(RecordHeader) <= end) {
+        RecordHeader rh{};
+        std::memcpy(&rh, cur, sizeof(rh));
+        const std::uint8_t *payload = cur + sizeof(rh);
+        cur += std::min(Align8(sizeof(rh) + rh.bytes), static_cast<std::size_t>(end - cur));
+
+        if (!haveFirst) {
+            firstTs   = rh.timestampNs;
+            haveFirst = true;
+        }
+
+        if (rh.portId != kCycleMarker) {
+            if (rh.portId < targets.size() && targets[rh.portId])
+                ports.Inject(*targets[rh.portId], payload, rh.bytes);
+            continue;
+        }
+
+        ++cycles;
+        if (batch > 1) {
+            if (++pending == batch) {
+                RunBatch(ports, addons, pending);
+                pending = 0;
+            }
+            ports.SetBatchCycle(pending);
+            continue;
+        }
+
+        if (timing == Timing::Original)
+            clock.SleepUntil(hostStart + (rh.timestampNs - firstTs));
+        addons.runCycle();
+    }
+    if (batch > 1) {
+        if (pending)
+            RunBatch(ports, addons, pending);
+        ports.EndBatch(); // records after the last cycle marker land in the slots
+    }
+
+    std::size_t i = 0;
+    for (auto &a : addons.addons())
+        a.enabled = wasEnabled[i++];
+
+    std::cout << "[PortReplayer] Replayed " << cycles << " cycles\n";
+    return cycles;
+}
+
+// One batch of `cycles` recorded cycles, addon by addon in execution order:
+// everything upstream of an addon has finished the whole batch before it runs
+void PortReplayer::RunBatch(PortManager &ports, AddOnManager &addons, std::uint32_t cycles) {
+    auto &list = addons.addons();
+    for (std::size_t i = 0; i < list.size(); ++i) {
+        if (!list[i].enabled)
+            continue;
+        ports.SetBatchCycle(PortManager::kWholeBatch);
+        if (addons.runAddonBatch(i, cycles))
+            continue;
+        for (std::uint32_t c = 0; c < cycles && list[i].enabled; ++c) {
+            ports.StepInputs(list[i].name, c);
+            ports.SetBatchCycle(c);
+            addons.runAddon(i);
+        }
+    }
+    ports.FlushBatch();
+    ports.EndCycle();
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <set>
+#include <string>
+#include <vector>
+#include "MappedFile.hpp"
+#include "PortRecorder.hpp"
+
+class PortManager;
+class AddOnManager;
+
+// Plays a PortRecorder log back into a live graph. Ports owned by the
+// replayed addons are skipped (those addons regenerate them); every other
+// recorded port is injected as if its producer had written it.
+class PortReplayer {
+    public:
+        enum class Timing {
+            AsFastAsPossible,
+            Original // cycles start at their recorded offsets on the host clock
+        };
+
+        bool Open(const std::string &filename);
+
+        // Runs the given addons (empty = all) once per recorded cycle.
+        // Expects initializeAll() to have been called. Returns cycles replayed.
+        //
+        // With batch > 1 the cycles go through in groups of `batch`: each
+        // addon in turn gets one runBatch(batch) over every frame queued for
+        // it (PortManager::BeginBatch), or is stepped through run() once per
+        // cycle if it has no batch mode. Implies Timing::AsFastAsPossible.
+        std::size_t Replay(PortManager &ports,
+            AddOnManager               &addons,
+            const std::set<std::string> &replayAddons,
+            Timing                       timing,
+            std::size_t                  batch = 1);
+
+    private:
+        static void RunBatch(PortManager &ports, AddOnManager &addons, std::uint32_t cycles);
+
+        struct Port {
+                std::string   addon;
+                std::string   port;
+                std::uint32_t payloadSize = 0;
+                std::uint64_t typeHash    = 0;
+        };
+
+        MappedFile        file_;
+        std::vector<Port> ports_; // indexed by recorded port id
+        std::size_t       dataOffset_ = 0;
+        std::size_t       dataBytes_  = 0;
+};
@@ -0,0 +1,102 @@
+#include "RcuDomain.hpp"
+
+#include <cerrno>
+#include <cstdlib>
+#include <iostream>
+
+#ifdef __linux__
+    #include <linux/membarrier.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+namespace {
+    std::atomic<std::uint64_t> gSerial{0};
+
+    struct ThreadSlot {
+            std::uint64_t               serial = 0;
+            std::atomic<std::uint64_t> *ctr    = nullptr;
+    };
+    thread_local ThreadSlot tReader;
+
+// The MEMBARRIER_CMD_* values are enumerators: only the syscall number
+// tells whether the headers know membarrier()
+#if defined(__linux__) && defined(__NR_membarrier)
+    #define RCU_HAVE_MEMBARRIER 1
+    long Membarrier(int cmd) {
+        return ::syscall(__NR_membarrier, cmd, 0, 0);
+    }
+#endif
+
+    // Registered once per process; false when the kernel (or a seccomp
+    // filter) refuses. QUERY returns the mask of supported commands.
+    bool RegisterExpedited() {
+#ifdef RCU_HAVE_MEMBARRIER
+        const long cmds = Membarrier(MEMBARRIER_CMD_QUERY);
+        return cmds > 0 && (cmds & MEMBARRIER_CMD_PRIVATE_EXPEDITED) &&
+               (cmds & MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED) &&
+               Membarrier(MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED) == 0;
+#else
+        return false;
+#endif
+    }
+} // namespace
+
+const bool RcuDomain::expedited_ = RegisterExpedited();
+
+RcuDomain::RcuDomain()
+    : serial_(gSerial.fetch_add(1, std::memory_order_relaxed) + 1) {}
+
+RcuDomain::~RcuDomain() = default;
+
+std::atomic<std::uint64_t> &RcuDomain::ThreadCounter() {
+    if (tReader.serial == serial_)
+        return *tReader.ctr;
+
+    // A thread that switched domains finds its old record again
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto                  me = std::this_thread::get_id();
+    Reader                     *r  = nullptr;
+    for (auto &rd : readers_) {
+        if (rd->owner == me)
+            r = rd.get();
+    }
+    if (!r) {
+        readers_.push_back(std::make_unique<Reader>());
+        r        = readers_.back().get();
+        r->owner = me;
+    }
+    tReader = ThreadSlot{serial_, &r->ctr};
+    return r->ctr;
+}
+
+void RcuDomain::Synchronize() {
+    // New readers register under the mutex, after the caller's publish:
+    // they can only see the new version
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Orders the caller's publish before every reader's next access, and
+    // their section entries so far before the loads below. Readers of an
+    // expedited domain only have a signal fence, so a plain fence here would
+    // order nothing: the barrier is retried, and a refusal is fatal.
+    if (expedited_) {
+#ifdef RCU_HAVE_MEMBARRIER
+        while (Membarrier(MEMBARRIER_CMD_PRIVATE_EXPEDITED) != 0) {
+            if (errno == EINTR || errno == EAGAIN)
+                continue;
+            std::cerr << "[RcuDomain] membarrier() failed (errno " << errno << ") after registration\n";
+            std::abort();
+        }
+#endif
+    } else {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    for (auto &r : readers_) {
+        const std::uint64_t seen = r->ctr.load(std::memory_order_acquire);
+        if (!(seen & 1))
+            continue;
+        while (r->ctr.load(std::memory_order_acquire) == seen)
+            std::this_thread::yield();
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Read-copy-update for structures the data path reads without locks
+// (PortManager's routes while the graph is rewired at runtime).
+//
+// Readers wrap each access in a ReadGuard: two stores to a counter owned by
+// their thread (odd = inside). A writer publishes a new version with one
+// atomic pointer store, calls Synchronize(), then frees the old version:
+// Synchronize() returns once every reader that may still hold it has left
+// its section. Readers never wait. Where the kernel offers membarrier()
+// the writer issues the memory barrier on the readers' behalf, so a guard
+// has no fence; elsewhere both sides use seq_cst fences. Guards do not
+// nest.
+class RcuDomain {
+    public:
+        RcuDomain();
+        ~RcuDomain();
+
+        RcuDomain(const RcuDomain &)            = delete;
+        RcuDomain &operator=(const RcuDomain &) = delete;
+
+        // `enabled` = false makes a no-op guard, for paths that only need
+        // one while rewiring is possible
+        class ReadGuard {
+            public:
+                explicit ReadGuard(RcuDomain &d, bool enabled = true)
+                    : ctr_(enabled ? &d.ThreadCounter() : nullptr) {
+                    if (!ctr_)
+                        return;
+                    ctr_->store(ctr_->load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                    ReaderFence();
+                }
+                ~ReadGuard() {
+                    if (!ctr_)
+                        return;
+                    ReaderFence();
+                    ctr_->store(ctr_->load(std::memory_order_relaxed) + 1, std::memory_order_release);
+                }
+
+                ReadGuard(const ReadGuard &)            = delete;
+                ReadGuard &operator=(const ReadGuard &) = delete;
+
+            private:
+                std::atomic<std::uint64_t> *ctr_;
+        };
+
+        // Waits (yielding) for every reader inside a section at the call
+        void Synchronize();
+
+        // Whether Synchronize() uses membarrier() (guards without fences)
+        static bool expedited() {
+            return expedited_;
+        }
+
+    private:
+        struct alignas(64) Reader {
+                std::atomic<std::uint64_t> ctr{0};
+                std::thread::id            owner;
+        };
+
+        static const bool expedited_; // decided once per process
+
+        static void ReaderFence() {
+            if (expedited_)
+                std::atomic_signal_fence(std::memory_order_seq_cst);
+            else
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+
+        std::atomic<std::uint64_t> &ThreadCounter();
+
+        const std::uint64_t serial_; // tells this domain's thread_local reader from another's
+
+        std::mutex                           mutex_; // guards readers_; held by Synchronize()
+        std::vector<std::unique_ptr<Reader>> readers_;
+};
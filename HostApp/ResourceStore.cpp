@@ -0,0 +1,59 @@
+#include "ResourceStore.hpp"
+#include <cstring>
+#include <filesystem>
+#include "../include/ResourcePort.hpp"
+
+namespace {
+    constexpr std::size_t kTouchStride = 4096; // no larger than any page size
+} // namespace
+
+const ResourceStore::Resource *ResourceStore::Open(const std::string &path, std::string &why) {
+    std::error_code ec;
+    const auto      canonical = std::filesystem::weakly_canonical(path, ec);
+    const auto      key       = ec ? path : canonical.string();
+
+    if (const auto it = files_.find(key); it != files_.end())
+        return &it->second->res;
+
+    auto file = std::make_unique<File>();
+    if (!file->map.open(key, MappedFile::Mode::ReadOnly) || !file->map.data()) {
+        why = "cannot map " + key;
+        return nullptr;
+    }
+    if (file->map.size() < sizeof(PluginAPI::ResourceFileHeader)) {
+        why = key + " is too small for a resource header";
+        return nullptr;
+    }
+
+    PluginAPI::ResourceFileHeader h;
+    std::memcpy(&h, file->map.data(), sizeof(h));
+    if (std::memcmp(h.magic, PluginAPI::kResourceMagic, sizeof(h.magic)) != 0) {
+        why = key + " is not a resource file";
+        return nullptr;
+    }
+    if (h.payloadSize > file->map.size() - PluginAPI::kResourceHeaderBytes) {
+        why = key + " is truncated";
+        return nullptr;
+    }
+
+    file->res.path        = key;
+    file->res.payload     = file->map.data() + PluginAPI::kResourceHeaderBytes;
+    file->res.payloadSize = static_cast<std::size_t>(h.payloadSize);
+    file->res.typeHash    = h.typeHash;
+    return &files_.emplace(key, std::move(file)).first->second->res;
+}
+
+void ResourceStore::Populate() const {
+    for (const auto &[key, file] : files_) {
+        const volatile std::uint8_t *p = file->map.data(); // reads the compiler must keep
+        for (std::size_t off = 0; off < file->map.size(); off += kTouchStride)
+            (void)p[off];
+    }
+}
+
+std::size_t ResourceStore::mappedBytes() const {
+    std::size_t bytes = 0;
+    for (const auto &[key, file] : files_)
+        bytes += file->map.size();
+    return bytes;
+}
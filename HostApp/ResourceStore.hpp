@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include "MappedFile.hpp"
+
+// Read-only resource files (include/ResourcePort.hpp) for the host's
+// resource ports.
+//
+// Each file is mapped once, read-only and MAP_SHARED, however many ports
+// bind it: the store is keyed by canonical path, so two spellings of one
+// file share a mapping. Pages come from the page cache on first touch, so
+// other host processes using the same file share the physical memory, and
+// so do isolated runners, which inherit the mapping through fork().
+// Mappings stay until the store is destroyed.
+class ResourceStore {
+    public:
+        struct Resource {
+                std::string   path;               // canonical
+                const void   *payload     = nullptr;
+                std::size_t   payloadSize = 0;
+                std::uint64_t typeHash    = 0;
+        };
+
+        ResourceStore() = default;
+
+        ResourceStore(const ResourceStore &)            = delete;
+        ResourceStore &operator=(const ResourceStore &) = delete;
+
+        // The mapping of `path`, made on first use; null with `why` set when
+        // the file cannot be mapped or its header is malformed
+        const Resource *Open(const std::string &path, std::string &why);
+
+        // Read every page of every mapping, so that later accesses take no
+        // page faults (low-jitter mode; again in a forked runner, which does
+        // not inherit page tables of shared file mappings)
+        void Populate() const;
+
+        std::size_t size() const {
+            return files_.size();
+        }
+        std::size_t mappedBytes() const;
+
+    private:
+        struct File {
+                MappedFile map;
+                Resource   res;
+        };
+
+        std::map<std::string, std::unique_ptr<File>> files_; // by canonical path
+};
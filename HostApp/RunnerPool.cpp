@@ -0,0 +1,403 @@
+#include "RunnerPool.hpp"
+#include <atomic>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <thread>
+#include "AddOnManager.hpp"
+#include "NumaTopology.hpp"
+
+#ifdef __linux__
+    #include <csignal>
+    #include <linux/futex.h>
+    #include <sys/prctl.h>
+    #include <sys/syscall.h>
+    #include <sys/wait.h>
+    #include <time.h>
+    #include <unistd.h>
+#endif
+
+// One per runner and one for the zygote, in the shared arena. The host
+// bumps `request` for every command, the runner (zygote) copies it into
+// `reply` when done; both sides sleep on the word they wait for
+// (non-private futexes: the mapping is shared). The zygote fills in the
+// runner's pid when it forks it, and `exited` / `status` when it reaps it.
+struct alignas(64) RunnerPool::Control {
+        std::uint32_t request = 0;
+        std::uint32_t reply   = 0;
+        std::uint32_t command = 0; // Command
+        std::uint32_t first   = 0; // addon index range of a Run; runner of a Spawn
+        std::uint32_t last    = 0;
+        std::uint32_t pid     = 0; // of the runner's current process
+        std::uint32_t exited  = 0; // pid the zygote reaped last
+        std::uint32_t status  = 0; // its waitpid() status
+};
+
+namespace {
+    enum Command : std::uint32_t {
+        kRun   = 0,
+        kStop  = 1,
+        kSpawn = 2 // zygote only
+    };
+
+    // Spinning first keeps the hand-off close to an in-process call when the
+    // other side answers quickly; the futex takes over for slow addons. On a
+    // single CPU the other side cannot run while we spin, so don't.
+    int SpinIterations() {
+        static const int n = std::thread::hardware_concurrency() > 1 ? 2000 : 0;
+        return n;
+    }
+
+    std::uint32_t Load(const std::uint32_t &w) {
+        return std::atomic_ref<std::uint32_t>(const_cast<std::uint32_t &>(w)).load(std::memory_order_acquire);
+    }
+    void Store(std::uint32_t &w, std::uint32_t v) {
+        std::atomic_ref<std::uint32_t>(w).store(v, std::memory_order_release);
+    }
+
+#ifdef __linux__
+    void FutexWake(std::uint32_t *w) {
+        ::syscall(SYS_futex, w, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    }
+    // Sleeps while *w == expected, at most `ns` (0 = no limit)
+    void FutexWait(std::uint32_t *w, std::uint32_t expected, long ns) {
+        timespec ts{0, ns};
+        ::syscall(SYS_futex, w, FUTEX_WAIT, expected, ns ? &ts : nullptr, nullptr, 0);
+    }
+
+    inline void CpuRelax() {
+    #if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+    #endif
+    }
+#endif
+} // namespace
+
+RunnerPool::RunnerPool(AddOnManager &mgr, std::vector<Group> groups, std::chrono::milliseconds timeout)
+    : mgr_(mgr), timeout_(timeout) {
+    runners_.reserve(groups.size());
+    for (auto &g : groups)
+        runners_.push_back(Runner{std::move(g)});
+}
+
+RunnerPool::~RunnerPool() {
+    Stop();
+}
+
+std::string RunnerPool::Describe(const Runner &r) const {
+    std::string names;
+    for (std::size_t i : r.group.addons) {
+        if (!names.empty())
+            names += ",";
+        names += mgr_.addons()[i].name;
+    }
+    return "runner " + std::to_string(&r - runners_.data()) + " (" + names + ")";
+}
+
+#ifdef __linux__
+
+bool RunnerPool::Start(PluginAPI::IHostServices &services, IHostPortServices *portSvc) {
+    services_ = &services;
+    portSvc_  = portSvc;
+
+    if (!shared_.OpenShared(sizeof(Control) * (runners_.size() + 1)))
+        return false;
+    for (auto &r : runners_)
+        r.ctl = new (shared_.Allocate(sizeof(Control), alignof(Control))) Control{};
+    zygoteCtl_ = new (shared_.Allocate(sizeof(Control), alignof(Control))) Control{};
+
+    // Whatever sits in the stdio buffers would otherwise be printed twice
+    std::cout.flush();
+    std::cerr.flush();
+    std::fflush(nullptr);
+
+    const pid_t pid = ::fork();
+    if (pid < 0) {
+        std::perror("[RunnerPool] fork");
+        return false;
+    }
+    if (pid == 0)
+        ZygoteMain();
+    zygote_ = pid;
+
+    for (auto &r : runners_) {
+        if (!Spawn(r))
+            return false;
+    }
+    std::cout << "[RunnerPool] Started " << runners_.size() << " runner processes\n";
+    return true;
+}
+
+bool RunnerPool::Spawn(Runner &r) {
+    Store(r.ctl->request, 0);
+    Store(r.ctl->reply, 0);
+    Store(r.ctl->pid, 0);
+    Store(r.ctl->exited, 0);
+
+    Control &z = *zygoteCtl_;
+    z.command  = kSpawn;
+    z.first    = static_cast<std::uint32_t>(&r - runners_.data());
+    const std::uint32_t seq = Load(z.request) + 1;
+    Store(z.request, seq);
+    FutexWake(&z.request);
+
+    const auto deadline = std::chrono::steady_clock::now() + timeout_;
+    for (std::uint32_t rep = Load(z.reply); rep != seq; rep = Load(z.reply)) {
+        int status = 0;
+        if (::waitpid(zygote_, &status, WNOHANG) == zygote_) {
+            std::cerr << "[RunnerPool] Zygote died; cannot fork " << Describe(r) << "\n";
+            zygote_ = -1;
+            return false;
+        }
+        if (std::chrono::steady_clock::now() > deadline) {
+            std::cerr << "[RunnerPool] Zygote did not fork " << Describe(r) << " in time\n";
+            return false;
+        }
+        FutexWait(&z.reply, rep, 1'000'000);
+    }
+
+    const auto pid = static_cast<int>(Load(r.ctl->pid));
+    if (pid <= 0)
+        return false; // the zygote reported why
+    r.pid = pid;
+    return true;
+}
+
+// The zygote reaped the runner's current process
+bool RunnerPool::Exited(const Runner &r, int &status) const {
+    if (Load(r.ctl->exited) != static_cast<std::uint32_t>(r.pid))
+        return false;
+    status = static_cast<int>(Load(r.ctl->status));
+    return true;
+}
+
+// SIGKILL, then wait (bounded) for the zygote to reap it, so a restart never
+// overlaps the old process
+void RunnerPool::Kill(Runner &r) {
+    ::kill(r.pid, SIGKILL);
+    int        status   = 0;
+    const auto deadline = std::chrono::steady_clock::now() + timeout_;
+    while (!Exited(r, status) && std::chrono::steady_clock::now() < deadline)
+        FutexWait(&r.ctl->reply, Load(r.ctl->reply), 1'000'000);
+    r.pid = -1;
+}
+
+void RunnerPool::ZygoteMain() {
+    ::prctl(PR_SET_PDEATHSIG, SIGKILL); // never outlive the host
+
+    // A no-op handler, so SIGCHLD interrupts the futex wait below; the
+    // timeout covers a child exiting just before the wait starts
+    struct sigaction sa{};
+    sa.sa_handler = [](int) {};
+    ::sigemptyset(&sa.sa_mask);
+    ::sigaction(SIGCHLD, &sa, nullptr);
+
+    Control      &z    = *zygoteCtl_;
+    std::uint32_t seen = 0;
+    for (;;) {
+        int   status = 0;
+        pid_t pid    = 0;
+        while ((pid = ::waitpid(-1, &status, WNOHANG)) > 0) {
+            for (auto &r : runners_) {
+                if (Load(r.ctl->pid) != static_cast<std::uint32_t>(pid))
+                    continue;
+                Store(r.ctl->status, static_cast<std::uint32_t>(status));
+                Store(r.ctl->exited, static_cast<std::uint32_t>(pid));
+                FutexWake(&r.ctl->reply);
+            }
+        }
+
+        const std::uint32_t req = Load(z.request);
+        if (req == seen) {
+            FutexWait(&z.request, seen, 100'000'000);
+            continue;
+        }
+        seen = req;
+
+        if (z.command == kStop)
+            ::_exit(0);
+
+        Runner &r = runners_[z.first];
+        pid       = ::fork();
+        if (pid < 0)
+            std::perror("[RunnerPool] fork");
+        if (pid == 0)
+            ChildMain(r);
+        Store(r.ctl->pid, pid > 0 ? static_cast<std::uint32_t>(pid) : 0);
+        Store(z.reply, seen);
+        FutexWake(&z.reply);
+    }
+}
+
+void RunnerPool::ChildMain(Runner &r) {
+    ::prctl(PR_SET_PDEATHSIG, SIGKILL); // never outlive the zygote, and so the host
+    ::signal(SIGCHLD, SIG_DFL);
+    // Before the addons initialize, so their memory is first touched on
+    // the runner's node
+    if (!r.group.cpus.empty() && !NumaTopology::BindCpus(r.group.cpus))
+        std::perror("[RunnerPool] sched_setaffinity");
+    if (portSvc_)
+        portSvc_->DetachForRunner();
+
+    for (std::size_t i : r.group.addons)
+        mgr_.initializeAddon(i, *services_);
+    std::cout.flush();
+
+    Control      &ctl  = *r.ctl;
+    std::uint32_t seen = 0;
+    for (;;) {
+        std::uint32_t req = Load(ctl.request);
+        for (int spin = 0; req == seen && spin < SpinIterations(); ++spin) {
+            CpuRelax();
+            req = Load(ctl.request);
+        }
+        while (req == seen) {
+            FutexWait(&ctl.request, seen, 0);
+            req = Load(ctl.request);
+        }
+        seen = req;
+
+        if (ctl.command == kStop) {
+            for (std::size_t i : r.group.addons)
+                mgr_.shutdownAddon(i);
+            std::cout.flush();
+            Store(ctl.reply, seen);
+            FutexWake(&ctl.reply);
+            ::_exit(0);
+        }
+
+        for (std::size_t i : r.group.addons) {
+            if (i >= ctl.first && i < ctl.last && mgr_.addons()[i].enabled)
+                mgr_.runAddon(i);
+        }
+        if (portSvc_)
+            portSvc_->EndCycle(); // origin tracking is per cycle
+        std::cout.flush();        // keep the console in cycle order
+        Store(ctl.reply, seen);
+        FutexWake(&ctl.reply);
+    }
+}
+
+bool RunnerPool::Run(std::size_t runner, std::size_t first, std::size_t last) {
+    Runner &r = runners_[runner];
+    if (r.pid <= 0)
+        return false; // gave up on it
+
+    Control &ctl = *r.ctl;
+    ctl.command  = kRun;
+    ctl.first    = static_cast<std::uint32_t>(first);
+    ctl.last     = static_cast<std::uint32_t>(last);
+    const std::uint32_t seq = Load(ctl.request) + 1;
+    Store(ctl.request, seq);
+    FutexWake(&ctl.request);
+    ++r.dispatches;
+
+    std::uint32_t rep = Load(ctl.reply);
+    for (int spin = 0; rep != seq && spin < SpinIterations(); ++spin) {
+        CpuRelax();
+        rep = Load(ctl.reply);
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + timeout_;
+    while (rep != seq) {
+        FutexWait(&ctl.reply, rep, 1'000'000); // 1 ms, then check the runner
+
+        int status = 0;
+        if (Exited(r, status)) {
+            ++r.crashes;
+            r.pid = -1;
+            Fail(r, WIFSIGNALED(status) ? "killed by signal " + std::to_string(WTERMSIG(status))
+                                        : "exited with status " + std::to_string(WEXITSTATUS(status)));
+            return false;
+        }
+        if (std::chrono::steady_clock::now() > deadline) {
+            ++r.timeouts;
+            Kill(r);
+            Fail(r, "missed the " + std::to_string(timeout_.count()) + " ms timeout");
+            return false;
+        }
+        rep = Load(ctl.reply);
+    }
+    return true;
+}
+
+void RunnerPool::Fail(Runner &r, const std::string &why) {
+    if (r.restarts >= kMaxRestarts) {
+        r.gaveUp = true;
+        std::cerr << "[RunnerPool] " << Describe(r) << " " << why << "; giving up after "
+                  << r.restarts << " restarts\n";
+        return;
+    }
+    ++r.restarts;
+    std::cerr << "[RunnerPool] " << Describe(r) << " " << why << "; restarting\n";
+    Spawn(r);
+}
+
+void RunnerPool::Stop() {
+    for (auto &r : runners_) {
+        if (r.pid <= 0)
+            continue;
+        Control &ctl = *r.ctl;
+        ctl.command  = kStop;
+        const std::uint32_t seq = Load(ctl.request) + 1;
+        Store(ctl.request, seq);
+        FutexWake(&ctl.request);
+
+        int        status   = 0;
+        const auto deadline = std::chrono::steady_clock::now() + timeout_;
+        while (r.pid > 0 && !Exited(r, status)) {
+            if (std::chrono::steady_clock::now() > deadline)
+                Kill(r);
+            else
+                FutexWait(&ctl.reply, Load(ctl.reply), 1'000'000);
+        }
+        r.pid = -1;
+    }
+
+    if (zygote_ > 0) {
+        Control &z = *zygoteCtl_;
+        z.command  = kStop;
+        Store(z.request, Load(z.request) + 1);
+        FutexWake(&z.request);
+        ::waitpid(zygote_, nullptr, 0);
+        zygote_ = -1;
+    }
+}
+
+#else // !__linux__
+
+bool RunnerPool::Start(PluginAPI::IHostServices &, IHostPortServices *) {
+    std::cerr << "[RunnerPool] Process isolation needs Linux (fork + futex)\n";
+    return false;
+}
+bool RunnerPool::Spawn(Runner &) {
+    return false;
+}
+bool RunnerPool::Exited(const Runner &, int &) const {
+    return false;
+}
+void RunnerPool::Kill(Runner &) {}
+void RunnerPool::ZygoteMain() {
+    std::abort();
+}
+void RunnerPool::ChildMain(Runner &) {
+    std::abort();
+}
+bool RunnerPool::Run(std::size_t, std::size_t, std::size_t) {
+    return false;
+}
+void RunnerPool::Fail(Runner &, const std::string &) {}
+void RunnerPool::Stop() {}
+
+#endif
+
+void RunnerPool::PrintSummary(std::ostream &os) const {
+    os << "\n[RunnerPool] Runners:\n";
+    for (const auto &r : runners_) {
+        os << "  " << Describe(r) << ": " << r.dispatches << " dispatches, "
+           << r.crashes << " crashes, " << r.timeouts << " timeouts, "
+           << r.restarts << " restarts" << (r.gaveUp ? " (gave up)" : "") << "\n";
+    }
+}
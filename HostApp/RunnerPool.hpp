@@ -0,0 +1,103 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include "../include/PluginAPI.hpp"
+#include "TransportArena.hpp"
+
+class AddOnManager;
+class IHostPortServices;
+
+// Process isolation for addons (Linux): each group of addons runs in its own
+// runner process. Ports keep working across processes because PortManager
+// allocates every transport from a MAP_SHARED arena before the fork
+// (PortManager::UseSharedTransports).
+//
+// Runners are never forked from the host itself, which may have started
+// threads (logger, metrics dumper) whose locks a child would inherit
+// half-held. Start() forks one zygote while the host is still
+// single-threaded, after the graph is wired; the zygote forks every runner
+// and every restart from its untouched copy of the addons, reaps them and
+// reports their exit through the shared control block.
+//
+// The host still drives the cycle: Run() hands one range of addon indices to
+// a runner and waits for it (futex on a shared control word, after a short
+// spin), so execution order is the same as in-process. A runner that dies or
+// misses the timeout is reaped and forked again by the zygote; the
+// transports, and with them every other addon's data, are untouched.
+class RunnerPool {
+    public:
+        struct Group {
+                std::vector<std::size_t> addons; // AddOnManager indices, ascending
+                std::vector<int>         cpus;   // affinity of the runner, empty = any CPU
+        };
+
+        RunnerPool(AddOnManager &mgr, std::vector<Group> groups, std::chrono::milliseconds timeout);
+        ~RunnerPool();
+
+        RunnerPool(const RunnerPool &)            = delete;
+        RunnerPool &operator=(const RunnerPool &) = delete;
+
+        // Fork the zygote, then every runner through it; each initializes its
+        // addons with `services`. Call while the host is single-threaded.
+        bool Start(PluginAPI::IHostServices &services, IHostPortServices *portSvc);
+        bool started() const {
+            return zygote_ > 0;
+        }
+
+        // CPUs a runner (and its restarts) may run on; before Start()
+        void SetCpus(std::size_t runner, std::vector<int> cpus) {
+            runners_[runner].group.cpus = std::move(cpus);
+        }
+
+        // Run the runner's addons with index in [first, last). False if the
+        // runner failed (it is restarted unless it ran out of restarts).
+        bool Run(std::size_t runner, std::size_t first, std::size_t last);
+
+        // Shut down and reap every runner
+        void Stop();
+
+        std::size_t size() const {
+            return runners_.size();
+        }
+        bool alive(std::size_t runner) const {
+            return runners_[runner].pid > 0;
+        }
+
+        void PrintSummary(std::ostream &os) const;
+
+        static constexpr std::uint32_t kMaxRestarts = 5;
+
+    private:
+        struct Control; // shared with the runner
+
+        struct Runner {
+                Group         group;
+                Control      *ctl        = nullptr;
+                int           pid        = -1;
+                std::uint64_t dispatches = 0;
+                std::uint32_t restarts   = 0;
+                std::uint32_t crashes    = 0;
+                std::uint32_t timeouts   = 0;
+                bool          gaveUp     = false; // kMaxRestarts reached
+        };
+
+        bool              Spawn(Runner &r); // through the zygote
+        bool              Exited(const Runner &r, int &status) const;
+        void              Kill(Runner &r);
+        [[noreturn]] void ZygoteMain();
+        [[noreturn]] void ChildMain(Runner &r);
+        void              Fail(Runner &r, const std::string &why);
+        std::string       Describe(const Runner &r) const;
+
+        AddOnManager             &mgr_;
+        PluginAPI::IHostServices *services_ = nullptr;
+        IHostPortServices        *portSvc_  = nullptr;
+        std::chrono::milliseconds timeout_;
+        TransportArena            shared_;              // control blocks
+        Control                  *zygoteCtl_ = nullptr; // spawn requests
+        int                       zygote_    = -1;
+        std::vector<Runner>       runners_;
+};
@@ -0,0 +1,135 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Fixed layout of the shared-memory stats page written by StatsPublisher and
+// mapped read-only by PortTop. Everything is 8-byte aligned POD so that both
+// sides can move it word by word with relaxed atomics.
+//
+//   [Header][AddonRow x addonCount][PortRow x portCount][ConnRow x connCount]
+//
+// Names are written once before the first publish; counters are updated under
+// a seqlock: `sequence` is odd while the writer is inside an update.
+namespace StatsPage {
+
+    inline constexpr char          kMagic[4] = {'S', 'P', 'v', '1'};
+    inline constexpr std::uint32_t kVersion  = 2;
+
+    struct Header {
+            char          magic[4];
+            std::uint32_t version;
+            std::uint32_t addonCount;
+            std::uint32_t portCount;
+            std::uint32_t connCount;
+            std::uint32_t reserved;
+            std::uint64_t addonOffset;
+            std::uint64_t portOffset;
+            std::uint64_t connOffset;
+            std::uint64_t totalBytes;
+            std::uint64_t pid;
+            std::uint64_t sequence;     // seqlock
+            std::uint64_t publishNs;    // steady clock of the last publish
+            std::uint64_t cycle;        // host cycles completed
+            std::uint64_t publishCount; // 0 = never published
+            std::uint64_t closed;       // 1 once the host stopped publishing
+    };
+
+    struct AddonRow {
+            char          name[64];
+            std::uint64_t runs;
+            std::uint64_t runNs; // total time spent in run()
+            std::uint64_t runNsMax;
+            std::uint64_t runNsP99;
+            std::uint64_t memLive; // bytes allocated through IHostServices::Memory()
+            std::uint64_t memPeak;
+    };
+
+    struct PortRow {
+            char          name[64]; // "Addon::Port"
+            std::uint64_t writes;
+            std::uint64_t reads;
+            std::uint64_t bytesIn;
+            std::uint64_t bytesOut;
+    };
+
+    struct ConnRow {
+            char          name[96]; // "Addon::Port -> Addon::Port"
+            std::uint64_t writes;
+            std::uint64_t reads;
+            std::uint64_t drops;
+            std::uint64_t skipped;
+            std::uint64_t emptyReads;
+            std::uint64_t depth; // unread messages (single-slot buffers: 0 or 1)
+            std::uint64_t latencyP99Ns;
+            std::uint64_t reserved;
+    };
+
+    static_assert(sizeof(Header) % 8 == 0 && sizeof(AddonRow) % 8 == 0 &&
+                  sizeof(PortRow) % 8 == 0 && sizeof(ConnRow) % 8 == 0);
+
+    inline std::size_t PageBytes(std::uint32_t addons, std::uint32_t ports, std::uint32_t conns) {
+        return sizeof(Header) + addons * sizeof(AddonRow) + ports * sizeof(PortRow) + conns * sizeof(ConnRow);
+    }
+
+    // Name-based location; /dev/shm keeps the page in memory on Linux
+    inline std::filesystem::path PathFor(const std::string &name) {
+        std::error_code       ec;
+        std::filesystem::path dir = "/dev/shm";
+        if (!std::filesystem::is_directory(dir, ec))
+            dir = std::filesystem::temp_directory_path(ec);
+        return dir / ("porttop." + name);
+    }
+
+    inline std::uint64_t LoadWord(const std::uint64_t &w, std::memory_order mo = std::memory_order_relaxed) {
+        return std::atomic_ref<std::uint64_t>(const_cast<std::uint64_t &>(w)).load(mo);
+    }
+    inline void StoreWord(std::uint64_t &w, std::uint64_t v, std::memory_order mo = std::memory_order_relaxed) {
+        std::atomic_ref<std::uint64_t>(w).store(v, mo);
+    }
+
+    // -------- Writer --------
+    inline void BeginUpdate(Header &h) {
+        StoreWord(h.sequence, LoadWord(h.sequence) + 1); // odd
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+    inline void EndUpdate(Header &h) {
+        StoreWord(h.sequence, LoadWord(h.sequence) + 1, std::memory_order_release); // even
+    }
+
+    // -------- Reader --------
+    // Copies the whole page into `out` as one consistent snapshot. Returns
+    // false if the layout is unknown or the writer kept it busy.
+    inline bool ReadSnapshot(const std::uint8_t *page, std::size_t bytes, std::vector<std::uint8_t> &out,
+        int retries = 1000) {
+        if (bytes < sizeof(Header))
+            return false;
+        const auto &h = *reinterpret_cast<const Header *>(page);
+        if (std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0 || h.version != kVersion ||
+            h.totalBytes > bytes)
+            return false;
+
+        const std::size_t words = h.totalBytes / sizeof(std::uint64_t);
+        out.resize(words * sizeof(std::uint64_t));
+        const auto *src = reinterpret_cast<const std::uint64_t *>(page);
+
+        for (int attempt = 0; attempt < retries; ++attempt) {
+            const std::uint64_t s1 = LoadWord(h.sequence, std::memory_order_acquire);
+            if (s1 & 1)
+                continue;
+            for (std::size_t i = 0; i < words; ++i) {
+                const std::uint64_t w = LoadWord(src[i]);
+                std::memcpy(out.data() + i * sizeof(w), &w, sizeof(w));
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (LoadWord(h.sequence) == s1)
+                return true;
+        }
+        return false;
+    }
+
+} // namespace StatsPage
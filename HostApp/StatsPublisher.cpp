@@ -0,0 +1,160 @@
+#include "StatsPublisher.hpp"
+#include <algorithm>
+#include <iostream>
+#include "AddOnManager.hpp"
+#include "PortManager.hpp"
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <unistd.h>
+#endif
+
+using namespace StatsPage;
+
+namespace {
+    template<std::size_t N>
+    void CopyName(char (&dst)[N], const std::string &src) {
+        const std::size_t n = std::min(src.size(), N - 1);
+        std::memcpy(dst, src.data(), n);
+        dst[n] = '\0';
+    }
+
+    std::uint64_t ProcessId() {
+#ifdef _WIN32
+        return GetCurrentProcessId();
+#else
+        return static_cast<std::uint64_t>(::getpid());
+#endif
+    }
+} // namespace
+
+StatsPublisher::~StatsPublisher() {
+    Close();
+}
+
+bool StatsPublisher::Open(const std::filesystem::path &file, const AddOnManager &addons, const PortManager &ports,
+    std::chrono::milliseconds interval) {
+    Close();
+
+    const auto graph      = ports.LockGraph(); // connections() stays put
+    const auto addonCount = static_cast<std::uint32_t>(addons.addons().size());
+    const auto portCount  = static_cast<std::uint32_t>(ports.ports().size());
+    const auto connCount  = static_cast<std::uint32_t>(ports.connections().size());
+    const auto bytes      = PageBytes(addonCount, portCount, connCount);
+
+    if (!file_.open(file, MappedFile::Mode::ReadWrite, bytes)) {
+        std::cerr << "[StatsPublisher] Failed to map " << file << "\n";
+        return false;
+    }
+    std::memset(file_.data(), 0, bytes);
+    intervalNs_ = static_cast<std::uint64_t>(std::chrono::nanoseconds(interval).count());
+
+    auto *h        = header();
+    h->version     = kVersion;
+    h->addonCount  = addonCount;
+    h->portCount   = portCount;
+    h->connCount   = connCount;
+    h->addonOffset = sizeof(Header);
+    h->portOffset  = h->addonOffset + addonCount * sizeof(AddonRow);
+    h->connOffset  = h->portOffset + portCount * sizeof(PortRow);
+    h->totalBytes  = bytes;
+    h->pid         = ProcessId();
+
+    auto *addonRows = reinterpret_cast<AddonRow *>(file_.data() + h->addonOffset);
+    for (std::uint32_t i = 0; i < addonCount; ++i)
+        CopyName(addonRows[i].name, addons.addons()[i].name);
+
+    auto *portRows = reinterpret_cast<PortRow *>(file_.data() + h->portOffset);
+    portIds_.clear();
+    for (const auto &[key, pi] : ports.ports()) {
+        CopyName(portRows[portIds_.size()].name, key.addon + "::" + key.port);
+        portIds_.push_back(pi.id);
+    }
+
+    auto *connRows = reinterpret_cast<ConnRow *>(file_.data() + h->connOffset);
+    for (std::uint32_t i = 0; i < connCount; ++i) {
+        const auto &c = ports.connections()[i];
+        CopyName(connRows[i].name, c.provider.addon + "::" + c.provider.port + " -> " +
+                                       c.receiver.addon + "::" + c.receiver.port);
+    }
+
+    // Magic last: readers ignore the page until the layout is complete
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(h->magic, kMagic, sizeof(kMagic));
+
+    std::cout << "[StatsPublisher] Publishing to " << file.string() << " (" << bytes << " bytes)\n";
+    return true;
+}
+
+void StatsPublisher::Publish(const AddOnManager &addons, const PortManager &ports, std::uint64_t cycle) {
+    if (!file_.data())
+        return;
+    auto *h = header();
+    BeginUpdate(*h);
+
+    if (const AddOnProfiler *prof = addons.profiler()) {
+        auto       *rows = reinterpret_cast<AddonRow *>(file_.data() + h->addonOffset);
+        const auto  n    = std::min<std::size_t>(h->addonCount, prof->AddonNames().size());
+        for (std::size_t i = 0; i < n; ++i) {
+            const auto &s = prof->Stats(i, AddOnProfiler::Phase::Run);
+            StoreWord(rows[i].runs, s.Count());
+            StoreWord(rows[i].runNs, s.Sum());
+            StoreWord(rows[i].runNsMax, s.Max());
+            StoreWord(rows[i].runNsP99, s.Percentile(0.99));
+        }
+    }
+
+    {
+        auto       *rows = reinterpret_cast<AddonRow *>(file_.data() + h->addonOffset);
+        const auto  n    = std::min<std::size_t>(h->addonCount, addons.addons().size());
+        for (std::size_t i = 0; i < n; ++i) {
+            if (const auto &mem = addons.addons()[i].memory) {
+                const auto s = mem->stats();
+                StoreWord(rows[i].memLive, s.live);
+                StoreWord(rows[i].memPeak, s.peak);
+            }
+        }
+    }
+
+    if (const PortMetrics *m = ports.metrics()) {
+        auto *portRows = reinterpret_cast<PortRow *>(file_.data() + h->portOffset);
+        for (std::size_t r = 0; r < portIds_.size(); ++r) {
+            const auto s = m->Port(portIds_[r]);
+            StoreWord(portRows[r].writes, s.writes);
+            StoreWord(portRows[r].reads, s.reads);
+            StoreWord(portRows[r].bytesIn, s.bytesIn);
+            StoreWord(portRows[r].bytesOut, s.bytesOut);
+        }
+    }
+
+    const auto  graph    = ports.LockGraph();
+    auto       *connRows = reinterpret_cast<ConnRow *>(file_.data() + h->connOffset);
+    const auto &conns    = ports.connections();
+    const auto  n        = std::min<std::size_t>(h->connCount, conns.size());
+    for (std::size_t r = 0; r < n; ++r) {
+        const auto &c = conns[r];
+        StoreWord(connRows[r].depth, c.slot && c.slot->unread ? 1 : 0);
+        if (const PortMetrics *m = ports.metrics()) {
+            const auto s = m->Connection(c.id);
+            StoreWord(connRows[r].writes, s.writes);
+            StoreWord(connRows[r].reads, s.reads);
+            StoreWord(connRows[r].drops, s.drops);
+            StoreWord(connRows[r].skipped, s.skipped);
+            StoreWord(connRows[r].emptyReads, s.emptyReads);
+            StoreWord(connRows[r].latencyP99Ns, s.LatencyPercentile(0.99));
+        }
+    }
+
+    StoreWord(h->cycle, cycle);
+    StoreWord(h->publishNs, PluginAPI::SteadyNowNs());
+    StoreWord(h->publishCount, h->publishCount + 1);
+    EndUpdate(*h);
+}
+
+void StatsPublisher::Close() {
+    if (!file_.data())
+        return;
+    StoreWord(header()->closed, 1, std::memory_order_release);
+    file_.close();
+}
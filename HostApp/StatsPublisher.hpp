@@ -0,0 +1,52 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../include/PluginAPI.hpp"
+#include "MappedFile.hpp"
+#include "StatsPage.hpp"
+
+class AddOnManager;
+class PortManager;
+
+// Publishes addon timings (AddOnProfiler) and port/connection counters
+// (PortMetrics) into a StatsPage for external monitors such as PortTop.
+//
+// Update() runs on the host's cycle thread right after runCycle() and only
+// copies anything once per interval, so readers never touch the host and the
+// pipeline pays one clock read per cycle in between.
+class StatsPublisher {
+    public:
+        StatsPublisher() = default;
+        ~StatsPublisher();
+
+        StatsPublisher(const StatsPublisher &)            = delete;
+        StatsPublisher &operator=(const StatsPublisher &) = delete;
+
+        // Sizes the page for the addons/ports/connections that exist now
+        bool Open(const std::filesystem::path &file, const AddOnManager &addons, const PortManager &ports,
+            std::chrono::milliseconds interval = std::chrono::milliseconds(250));
+
+        void Update(const AddOnManager &addons, const PortManager &ports, std::uint64_t cycle) {
+            if (!file_.data())
+                return;
+            if (PluginAPI::SteadyNowNs() - header()->publishNs >= intervalNs_)
+                Publish(addons, ports, cycle);
+        }
+
+        // Unthrottled update
+        void Publish(const AddOnManager &addons, const PortManager &ports, std::uint64_t cycle);
+
+        // Final publish is up to the caller; this marks the page closed
+        void Close();
+
+    private:
+        StatsPage::Header *header() {
+            return reinterpret_cast<StatsPage::Header *>(file_.data());
+        }
+
+        MappedFile                 file_;
+        std::uint64_t              intervalNs_ = 0;
+        std::vector<std::uint32_t> portIds_; // row -> PortInfo::id
+};
@@ -0,0 +1,267 @@
+#include "TransportArena.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+#ifndef _WIN32
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+#ifdef __linux__
+    #include <linux/mempolicy.h>
+    #include <sys/syscall.h>
+#endif
+
+namespace {
+    std::size_t PageBytes() {
+#ifdef _WIN32
+        return 4096;
+#else
+        static const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        return page;
+#endif
+    }
+
+    // Write access to every page of [p, p + bytes) without changing its
+    // contents; a runner may populate while the host already uses them
+    void TouchPages(std::uint8_t *p, std::size_t bytes) {
+        for (std::size_t off = 0; off < bytes; off += PageBytes())
+            std::atomic_ref<std::uint8_t>(p[off]).fetch_or(0, std::memory_order_relaxed);
+    }
+} // namespace
+
+TransportArena::~TransportArena() {
+    for (const auto &b : heap_)
+        ::operator delete(b.ptr, std::align_val_t{b.align});
+#ifndef _WIN32
+    for (const auto &m : nodeMaps_)
+        ::munmap(m.ptr, m.bytes);
+#endif
+    Unmap();
+}
+
+bool TransportArena::OpenShared(std::size_t capacity) {
+    if (shared())
+        return true;
+    if (!heap_.empty() || used_) {
+        std::cerr << "[TransportArena] Shared mode must be chosen before the first transport\n";
+        return false;
+    }
+#ifdef _WIN32
+    (void)capacity;
+    std::cerr << "[TransportArena] Shared transports are not supported on Windows\n";
+    return false;
+#else
+    return Map(std::max(capacity, capacity_), true);
+#endif
+}
+
+bool TransportArena::OpenLowJitter(std::size_t capacity) {
+    if (lowJitter_)
+        return true;
+    if (!heap_.empty() || used_) {
+        std::cerr << "[TransportArena] Low-jitter mode must be chosen before the first transport\n";
+        return false;
+    }
+#ifdef _WIN32
+    (void)capacity;
+    std::cerr << "[TransportArena] Low-jitter transports are not supported on Windows\n";
+    return false;
+#else
+    lowJitter_ = true;
+    if (!Map(std::max(capacity, capacity_), shared_)) {
+        lowJitter_ = false;
+        return false;
+    }
+    std::cout << "[TransportArena] Low-jitter region: " << (capacity_ >> 20) << " MiB of "
+              << (hugePages_ ? "2 MiB hugepages" : "regular pages (no hugepages reserved)") << "\n";
+    return true;
+#endif
+}
+
+#ifdef _WIN32
+bool TransportArena::Map(std::size_t, bool) {
+    return false;
+}
+void TransportArena::Unmap() {}
+void TransportArena::Pin(std::size_t) {}
+void TransportArena::Populate() {}
+bool TransportArena::Bind(void *, std::size_t, int) {
+    return false;
+}
+void *TransportArena::AllocateOn(int, std::size_t bytes, std::size_t align) {
+    return Allocate(bytes, align);
+}
+#else
+// (Re)maps the still unused region; hugepages are only tried in
+// low-jitter mode
+bool TransportArena::Map(std::size_t capacity, bool shared) {
+    Unmap();
+    const int kind = (shared ? MAP_SHARED : MAP_PRIVATE) | MAP_ANONYMOUS;
+
+    void *p = MAP_FAILED;
+    if (lowJitter_) {
+        // No MAP_NORESERVE: the mapping fails up front unless the pool can
+        // back all of it, instead of SIGBUS on a later fault
+        const std::size_t huge = (capacity + kHugePageBytes - 1) & ~(kHugePageBytes - 1);
+        p                      = ::mmap(nullptr, huge, PROT_READ | PROT_WRITE, kind | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED)
+            capacity = huge;
+    }
+    hugePages_ = p != MAP_FAILED;
+    if (p == MAP_FAILED) {
+        // Pages are only backed once touched, so a generous reservation is cheap
+        p = ::mmap(nullptr, capacity, PROT_READ | PROT_WRITE, kind | MAP_NORESERVE, -1, 0);
+    }
+    if (p == MAP_FAILED) {
+        std::cerr << "[TransportArena] mmap of " << capacity << " bytes failed\n";
+        return false;
+    }
+    base_     = static_cast<std::uint8_t *>(p);
+    capacity_ = capacity;
+    shared_   = shared;
+    used_     = 0;
+    return true;
+}
+
+void TransportArena::Unmap() {
+    if (!base_)
+        return;
+    if (lockedEnd_ && !lockFailed_)
+        ::munlock(base_, lockedEnd_);
+    ::munmap(base_, capacity_);
+    base_      = nullptr;
+    lockedEnd_ = 0;
+}
+
+void TransportArena::Pin(std::size_t end) {
+    end = std::min((end + PageBytes() - 1) & ~(PageBytes() - 1), capacity_);
+    if (end <= lockedEnd_)
+        return;
+    std::uint8_t     *from  = base_ + lockedEnd_;
+    const std::size_t bytes = end - lockedEnd_;
+
+    // mlock() of a writable private mapping faults every page in; for a
+    // shared one it maps them read-only, so touch them as well
+    if (!lockFailed_ && ::mlock(from, bytes) != 0) {
+        lockFailed_ = true;
+        std::cerr << "[TransportArena] mlock failed (raise RLIMIT_MEMLOCK); transports are pre-touched only\n";
+        if (lockedEnd_)
+            ::munlock(base_, lockedEnd_);
+    }
+    if (shared_ || lockFailed_)
+        TouchPages(from, bytes);
+    lockedEnd_ = end;
+}
+
+void TransportArena::Populate() {
+    if (!base_ || !used_)
+        return;
+    const std::size_t bytes = (used_ + PageBytes() - 1) & ~(PageBytes() - 1);
+    #ifdef MADV_POPULATE_WRITE
+    if (::madvise(base_, bytes, MADV_POPULATE_WRITE) == 0)
+        return;
+    #endif
+    TouchPages(base_, bytes); // kernels before 5.14
+}
+
+// Preferred rather than strict: a full node spills over instead of failing
+bool TransportArena::Bind(void *p, std::size_t bytes, int node) {
+    #if defined(__linux__) && defined(SYS_mbind)
+    constexpr std::size_t kBits = sizeof(unsigned long) * 8;
+    if (node >= 0) {
+        const auto                 n = static_cast<std::size_t>(node);
+        std::vector<unsigned long> mask(n / kBits + 1, 0);
+        mask[n / kBits] |= 1UL << (n % kBits);
+        if (::syscall(SYS_mbind, p, bytes, MPOL_PREFERRED, mask.data(), mask.size() * kBits + 1, 0) == 0)
+            return true;
+    }
+    #else
+    (void)p;
+    (void)bytes;
+    #endif
+    if (!bindFailed_) {
+        bindFailed_ = true;
+        std::cerr << "[TransportArena] Cannot bind memory to NUMA node " << node
+                  << "; those transports stay where they are first touched\n";
+    }
+    return false;
+}
+
+void *TransportArena::AllocateOn(int node, std::size_t bytes, std::size_t align) {
+    auto nc = std::find_if(nodes_.begin(), nodes_.end(), [&](const NodeChunks &c) { return c.node == node; });
+    if (nc == nodes_.end()) {
+        nodes_.push_back(NodeChunks{node});
+        nc = nodes_.end() - 1;
+    }
+
+    auto at = (reinterpret_cast<std::uintptr_t>(nc->cursor) + align - 1) & ~(align - 1);
+    if (!nc->cursor || at + bytes > reinterpret_cast<std::uintptr_t>(nc->end)) {
+        // A fresh chunk, bound before anything touches it; whole hugepages
+        // in hugepage mode, since those are placed as a unit
+        const std::size_t grain = hugePages_ ? kHugePageBytes : PageBytes();
+        const std::size_t chunk = (std::max(kNodeChunkBytes, bytes + align) + grain - 1) & ~(grain - 1);
+
+        std::uint8_t *p;
+        if (base_) {
+            const std::size_t start = (used_ + grain - 1) & ~(grain - 1);
+            if (start + chunk > capacity_) {
+                std::cerr << "[TransportArena] " << (shared_ ? "Shared" : "Low-jitter") << " arena exhausted ("
+                          << capacity_ << " bytes)\n";
+                return nullptr;
+            }
+            p     = base_ + start;
+            used_ = start + chunk;
+        } else {
+            void *m = ::mmap(nullptr, chunk, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (m == MAP_FAILED) {
+                std::cerr << "[TransportArena] mmap of " << chunk << " bytes failed\n";
+                return nullptr;
+            }
+            nodeMaps_.push_back({m, chunk});
+            p = static_cast<std::uint8_t *>(m);
+        }
+        if (Bind(p, chunk, node))
+            nc->bound += chunk;
+        if (lowJitter_)
+            Pin(used_);
+        nc->cursor = p;
+        nc->end    = p + chunk;
+        at         = (reinterpret_cast<std::uintptr_t>(p) + align - 1) & ~(align - 1);
+    }
+    nc->cursor = reinterpret_cast<std::uint8_t *>(at + bytes);
+    return reinterpret_cast<void *>(at);
+}
+#endif
+
+std::size_t TransportArena::nodeBytes(int node) const {
+    for (const auto &c : nodes_) {
+        if (c.node == node)
+            return c.bound;
+    }
+    return 0;
+}
+
+void *TransportArena::Allocate(std::size_t bytes, std::size_t align) {
+    if (!base_) {
+        void *p = ::operator new(bytes, std::align_val_t{align});
+        std::memset(p, 0, bytes);
+        heap_.push_back({p, align});
+        used_ += bytes;
+        return p;
+    }
+
+    // mmap memory is already zeroed
+    const std::size_t at = (used_ + align - 1) & ~(align - 1);
+    if (at + bytes > capacity_) {
+        std::cerr << "[TransportArena] " << (shared_ ? "Shared" : "Low-jitter") << " arena exhausted ("
+                  << capacity_ << " bytes)\n";
+        return nullptr;
+    }
+    used_ = at + bytes;
+    if (lowJitter_)
+        Pin(used_);
+    return base_ + at;
+}
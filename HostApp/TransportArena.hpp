@@ -0,0 +1,113 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Backing memory for port transports (Direct blocks, Buffered slots).
+//
+// Heap mode (default) hands out individual aligned allocations. Shared mode
+// reserves one anonymous MAP_SHARED region up front and bump-allocates from
+// it, so processes forked afterwards (isolated runners, see RunnerPool) see
+// the same transports at the same addresses. Memory is zeroed and stays
+// valid until the arena is destroyed; nothing is freed individually.
+//
+// Low-jitter mode also bump-allocates from one region (private, or shared
+// with OpenShared()), mapped from explicit hugepages when enough are
+// reserved (vm.nr_hugepages) and from regular pages otherwise. Every block
+// is faulted in and mlock()ed as it is handed out, so no transport access
+// takes a page fault once the graph is wired.
+//
+// AllocateOn() places a block on one NUMA node. Blocks of a node share
+// chunks that are bound to it (mbind, preferred policy) before their first
+// touch: carved from the region in shared / low-jitter mode, mapped
+// separately in heap mode.
+class TransportArena {
+    public:
+        static constexpr std::size_t kDefaultSharedBytes    = std::size_t(256) << 20;
+        static constexpr std::size_t kDefaultLowJitterBytes = std::size_t(64) << 20;
+        static constexpr std::size_t kHugePageBytes         = std::size_t(2) << 20;
+        static constexpr std::size_t kNodeChunkBytes        = std::size_t(256) << 10;
+
+        TransportArena() = default;
+        ~TransportArena();
+
+        TransportArena(const TransportArena &)            = delete;
+        TransportArena &operator=(const TransportArena &) = delete;
+
+        // Switch to shared mode; must happen before the first Allocate()
+        bool OpenShared(std::size_t capacity = kDefaultSharedBytes);
+
+        // Switch to low-jitter mode; before the first Allocate(), in either
+        // order with OpenShared() (the larger capacity wins)
+        bool OpenLowJitter(std::size_t capacity = kDefaultLowJitterBytes);
+
+        // Zeroed block of `bytes`, aligned to `align` (a power of two); null
+        // when a shared or low-jitter arena is exhausted
+        void *Allocate(std::size_t bytes, std::size_t align = 64);
+
+        // Like Allocate(), from memory on NUMA node `node` (kernel number).
+        // Where the kernel refuses the binding the block is still handed
+        // out, unbound, and nodeBytes() does not count it.
+        void *AllocateOn(int node, std::size_t bytes, std::size_t align = 64);
+
+        // Map the used part of the region into this process with write
+        // access (a forked runner: mappings are inherited, page tables and
+        // locks are not)
+        void Populate();
+
+        bool shared() const {
+            return base_ != nullptr && shared_;
+        }
+        bool lowJitter() const {
+            return lowJitter_;
+        }
+        bool hugePages() const {
+            return hugePages_;
+        }
+        std::size_t used() const {
+            return used_;
+        }
+        std::size_t capacity() const {
+            return capacity_;
+        }
+        std::size_t locked() const {
+            return lockFailed_ ? 0 : lockedEnd_;
+        }
+        // Chunk bytes bound to `node` by AllocateOn()
+        std::size_t nodeBytes(int node) const;
+
+    private:
+        struct HeapBlock {
+                void       *ptr;
+                std::size_t align;
+        };
+        struct Mapping {
+                void       *ptr;
+                std::size_t bytes;
+        };
+        struct NodeChunks {
+                int           node   = 0;
+                std::uint8_t *cursor = nullptr; // unused tail of the current chunk
+                std::uint8_t *end    = nullptr;
+                std::size_t   bound  = 0;
+        };
+
+        bool Map(std::size_t capacity, bool shared);
+        void Unmap();
+        void Pin(std::size_t end); // fault in + lock [lockedEnd_, end)
+        bool Bind(void *p, std::size_t bytes, int node);
+
+        std::uint8_t          *base_       = nullptr; // shared / low-jitter mode
+        std::size_t            capacity_   = 0;
+        std::size_t            used_       = 0;
+        std::size_t            lockedEnd_  = 0; // pinned prefix of the region
+        bool                   shared_     = false;
+        bool                   lowJitter_  = false;
+        bool                   hugePages_  = false;
+        bool                   lockFailed_ = false; // RLIMIT_MEMLOCK: pre-touched only
+        std::vector<HeapBlock> heap_;               // heap mode
+
+        std::vector<NodeChunks> nodes_;              // AllocateOn(), by first use
+        std::vector<Mapping>    nodeMaps_;           // heap mode node chunks
+        bool                    bindFailed_ = false; // mbind() refused, reported once
+};
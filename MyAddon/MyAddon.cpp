@@ -1,13 +1,14 @@
 #include "MyAddon.hpp"
 #include <iostream>
+#include <cstring>
 
-std::vector<PluginAPI::PortDescriptor> MyAddon::getPortDescriptors() const {
-    return {OutPort};
+PluginAPI::PortTable MyAddon::getPortTable() const {
+    return Ports::table();
 }
 
 void MyAddon::initialize(PluginAPI::IHostServices *svc) {
-    OutPort.Bind(svc);
-    
+    svc_ = svc;
+    ports_.Bind(svc);
 }
 
 void MyAddon::run() {
@@ -16,20 +17,33 @@ void MyAddon::run() {
     p.speed = 3.14f * p.value;
 
     // direct write into SHM
-    OutPort.data() = p;
-    //OutPort.data().ptr()->value = tick++;
-    //OutPort.data().ptr()->speed = 3.14f * p.value + tick;
+    ports_.get<OutPortT>().data() = p;
+    //ports_.get<OutPortT>().data().ptr()->value = tick++;
+    //ports_.get<OutPortT>().data().ptr()->speed = 3.14f * p.value + tick;
 
 
 
-    std::cout << "[MyAddon] Produced Packet: value=" << p.value
-              << " speed=" << p.speed << "\n";
+    PLUGIN_LOG(svc_, PluginAPI::LogLevel::Info, 0, "[MyAddon] Produced Packet: value={} speed={}", p.value, p.speed);
 }
 
 void MyAddon::shutdown() {
     std::cout << "[MyAddon] shutdown\n";
 }
 
+// Warm restart: resume counting where the last run stopped
+std::size_t MyAddon::saveState(void *dst, std::size_t capacity) const {
+    if (dst && capacity >= sizeof(tick))
+        std::memcpy(dst, &tick, sizeof(tick));
+    return sizeof(tick);
+}
+
+bool MyAddon::restoreState(const void *src, std::size_t bytes) {
+    if (bytes != sizeof(tick))
+        return false;
+    std::memcpy(&tick, src, sizeof(tick));
+    return true;
+}
+
 #ifdef _WIN32
 extern "C" __declspec(dllexport) PluginAPI::IPlugin *CreatePlugin() {
     return new MyAddon();
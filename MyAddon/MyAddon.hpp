@@ -11,13 +11,18 @@ class MyAddon: public PluginAPI::IPlugin {
             PluginAPI::PortType::InternalMemory,
             PluginAPI::DataAccessPolicy::Buffered>;
 
-        std::vector<PluginAPI::PortDescriptor> getPortDescriptors() const override;
-        void                                   initialize(PluginAPI::IHostServices *svc) override;
-        void                                   run() override;
-        void                                   shutdown() override;
+        using Ports = PluginAPI::PortSet<OutPortT>;
+
+        PluginAPI::PortTable getPortTable() const override;
+        void                 initialize(PluginAPI::IHostServices *svc) override;
+        void                 run() override;
+        void                 shutdown() override;
+        std::size_t          saveState(void *dst, std::size_t capacity) const override;
+        bool                 restoreState(const void *src, std::size_t bytes) override;
 
     private:
-        OutPortT OutPort{};
-        Packet   myValue;
-        int      tick =11;
+        Ports                     ports_{};
+        PluginAPI::IHostServices *svc_ = nullptr; // logging
+        Packet                    myValue;
+        int                       tick =11;
 };
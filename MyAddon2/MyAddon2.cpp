@@ -1,34 +1,33 @@
 #include "MyAddon2.hpp"
 #include <iostream>
 
-std::vector<PluginAPI::PortDescriptor> MyAddon2::getPortDescriptors() const {
-    return {InPort, OutPort};
+PluginAPI::PortTable MyAddon2::getPortTable() const {
+    return Ports::table();
 }
 
 void MyAddon2::initialize(PluginAPI::IHostServices *svc) {
-    InPort.Bind(svc);
-    OutPort.Bind(svc);
-    
+    svc_ = svc;
+    ports_.Bind(svc);
 }
 
 void MyAddon2::run() {
-    Packet p;
+    Packet                 p;
+    PluginAPI::MessageInfo info;
 
-    if (InPort.read(p)) {
-        std::cout << "[MyAddon2] Received: value=" << p.value
-                  << " speed=" << p.speed << "\n";
+    if (ports_.get<InPortT>().read(p, info)) {
+        PLUGIN_LOG(svc_, PluginAPI::LogLevel::Info, 0, "[MyAddon2] Received: value={} speed={} seq={} age={}ns",
+            p.value, p.speed, info.sequence, info.ageNs);
 
         // process
         p.value *= 2;
         p.speed *= 0.5f;
 
         // write processed
-        //OutPort.write(p);
+        //ports_.get<OutPortT>().write(p);
 
-        std::cout << "[MyAddon2] Sent Processed: value=" << p.value
-                  << " speed=" << p.speed << "\n";
+        PLUGIN_LOG(svc_, PluginAPI::LogLevel::Info, 0, "[MyAddon2] Sent Processed: value={} speed={}", p.value, p.speed);
     } else {
-        std::cout << "[MyAddon2] No input yet...\n";
+        PLUGIN_LOG(svc_, PluginAPI::LogLevel::Info, 1, "[MyAddon2] No input yet...");
     }
 }
 
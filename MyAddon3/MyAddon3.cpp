@@ -1,34 +1,32 @@
 #include "MyAddon3.hpp"
 #include <iostream>
 
-std::vector<PluginAPI::PortDescriptor> MyAddon3::getPortDescriptors() const {
-    return {InPort, OutPort};
+PluginAPI::PortTable MyAddon3::getPortTable() const {
+    return Ports::table();
 }
 
 void MyAddon3::initialize(PluginAPI::IHostServices *svc) {
-    InPort.Bind(svc);
-    OutPort.Bind(svc);
-    
+    svc_ = svc;
+    ports_.Bind(svc);
 }
 
 void MyAddon3::run() {
     Packet p;
 
-    if (InPort.read(p)) {
-        std::cout << "[MyAddon3] Received: value=" << p.value
-                  << " speed=" << p.speed << "\n";
+    // Skips the cycles where the producer wrote nothing new
+    if (ports_.get<InPortT>().readIfNew(p)) {
+        PLUGIN_LOG(svc_, PluginAPI::LogLevel::Info, 0, "[MyAddon3] Received: value={} speed={}", p.value, p.speed);
 
         // process
         p.value *= 2;
         p.speed *= 0.5f;
 
         // write processed
-        //OutPort.write(p);
+        //ports_.get<OutPortT>().write(p);
 
-        std::cout << "[MyAddon3] Sent Processed: value=" << p.value
-                  << " speed=" << p.speed << "\n";
+        PLUGIN_LOG(svc_, PluginAPI::LogLevel::Info, 0, "[MyAddon3] Sent Processed: value={} speed={}", p.value, p.speed);
     } else {
-        std::cout << "[MyAddon3] No input yet...\n";
+        PLUGIN_LOG(svc_, PluginAPI::LogLevel::Info, 1, "[MyAddon3] No new input...");
     }
 }
 
@@ -18,13 +18,15 @@ class MyAddon3: public PluginAPI::IPlugin {
             PluginAPI::PortType::InternalMemory,
             PluginAPI::DataAccessPolicy::Direct>;
 
-        std::vector<PluginAPI::PortDescriptor> getPortDescriptors() const override;
-        void                                   initialize(PluginAPI::IHostServices *svc) override;
-        void                                   run() override;
-        void                                   shutdown() override;
+        using Ports = PluginAPI::PortSet<InPortT, OutPortT>;
+
+        PluginAPI::PortTable getPortTable() const override;
+        void                 initialize(PluginAPI::IHostServices *svc) override;
+        void                 run() override;
+        void                 shutdown() override;
 
     private:
-        InPortT  InPort{};
-        OutPortT OutPort{};
-        Packet   myStuff;
+        Ports                     ports_{};
+        PluginAPI::IHostServices *svc_ = nullptr; // logging
+        Packet                    myStuff;
 };
@@ -0,0 +1,1622 @@
+// Microbenchmarks for the port fabric.
+//
+// Every benchmark prints one JSON line:
+//   {"bench":"fabric.write","params":"bytes=64,fanout=4","iterations":...,
+//    "ns_per_op":...,"bytes_per_sec":...}
+// so results can be collected with `PortBench --out results.jsonl` and diffed
+// over time. `--quick` shortens every run (used by ctest).
+//
+// Next to the benchmarks, checks replay the same paths with known inputs and
+// compare what comes out; a failed check is printed to stderr and makes
+// PortBench exit with 1, so each ctest group also guards its semantics.
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <unistd.h>
+#include "AddOnManager.hpp"
+#include "AddonMemory.hpp"
+#include "Checkpoint.hpp"
+#include "GraphOptimizer.hpp"
+#include "HostClock.hpp"
+#include "HostLogger.hpp"
+#include "PortManager.hpp"
+#include "PortReplayer.hpp"
+#include "../include/BatchPort.hpp"
+#include "../include/HistoryPort.hpp"
+#include "../include/Packet.hpp"
+#include "../include/ResourcePort.hpp"
+
+using namespace PluginAPI;
+
+namespace {
+
+    // ------------------------------------------------------------
+    // Harness
+    // ------------------------------------------------------------
+    template<class T>
+    inline void DoNotOptimize(T const &v) {
+#if defined(__clang__) || defined(__GNUC__)
+        asm volatile("" : : "r,m"(v) : "memory");
+#else
+        static volatile const void *sink;
+        sink = &v;
+#endif
+    }
+
+    struct Options {
+            std::string   filter;
+            bool          quick = false;
+            std::ostream *out   = &std::cout;
+    };
+
+    struct Result {
+            std::string   bench;
+            std::string   params;
+            std::uint64_t iterations  = 0;
+            double        nsPerOp     = 0;
+            double        bytesPerSec = 0;
+    };
+
+    class Runner {
+        public:
+            explicit Runner(const Options &opt)
+                : opt_(opt) {}
+
+            bool Enabled(const std::string &bench) const {
+                return opt_.filter.empty() || bench.find(opt_.filter) != std::string::npos;
+            }
+
+            // Runs `op(iters)` with growing iteration counts until it takes
+            // at least the minimum time, then reports the per-op cost.
+            void Run(const std::string &bench, const std::string &params, std::size_t bytesPerOp,
+                const std::function<void(std::uint64_t)> &op) {
+                if (!Enabled(bench))
+                    return;
+
+                const auto    minTime = opt_.quick ? std::chrono::milliseconds(5)
+                                                   : std::chrono::milliseconds(250);
+                std::uint64_t iters   = 1;
+                double        elapsed = 0;
+                for (;;) {
+                    const auto t0 = std::chrono::steady_clock::now();
+                    op(iters);
+                    const auto t1 = std::chrono::steady_clock::now();
+                    elapsed       = std::chrono::duration<double, std::nano>(t1 - t0).count();
+                    if (elapsed >= std::chrono::duration<double, std::nano>(minTime).count() ||
+                        iters >= (std::uint64_t(1) << 32))
+                        break;
+                    iters *= 2;
+                }
+
+                Result r{bench, params, iters, elapsed / static_cast<double>(iters), 0};
+                if (bytesPerOp)
+                    r.bytesPerSec = static_cast<double>(bytesPerOp) * 1e9 / r.nsPerOp;
+                Report(r);
+            }
+
+            // For expensive one-shot operations (Connect at scale, file I/O)
+            void RunOnce(const std::string &bench, const std::string &params, std::uint64_t ops,
+                const std::function<void()> &op) {
+                if (!Enabled(bench))
+                    return;
+                const auto t0 = std::chrono::steady_clock::now();
+                op();
+                const auto t1 = std::chrono::steady_clock::now();
+                const double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+                Report(Result{bench, params, ops, ns / static_cast<double>(ops ? ops : 1), 0});
+            }
+
+            // Counts as a run for the filter; `detail` says what was expected.
+            // Straight to stderr: checks may run with std::cerr silenced.
+            bool Check(const std::string &name, bool ok, const std::string &detail = {}) {
+                ++count_;
+                if (!ok) {
+                    std::fprintf(stderr, "[PortBench] Check failed: %s%s%s\n", name.c_str(),
+                        detail.empty() ? "" : ": ", detail.c_str());
+                    ++failures_;
+                }
+                return ok;
+            }
+
+            int Count() const {
+                return count_;
+            }
+            int Failures() const {
+                return failures_;
+            }
+
+        private:
+            void Report(const Result &r) {
+                char line[512];
+                std::snprintf(line, sizeof(line),
+                    "{\"bench\":\"%s\",\"params\":\"%s\",\"iterations\":%llu,"
+                    "\"ns_per_op\":%.3f,\"bytes_per_sec\":%.0f}\n",
+                    r.bench.c_str(), r.params.c_str(),
+                    static_cast<unsigned long long>(r.iterations), r.nsPerOp, r.bytesPerSec);
+                *opt_.out << line << std::flush;
+                ++count_;
+            }
+
+            const Options &opt_;
+            int            count_    = 0;
+            int            failures_ = 0;
+    };
+
+    // Keeps PortManager/AddOnManager chatter off the results stream, or
+    // off stderr where a check expects a complaint
+    class QuietCout {
+        public:
+            explicit QuietCout(std::ostream &os = std::cout)
+                : os_(os), old_(os.rdbuf(null_.rdbuf())) {}
+            ~QuietCout() {
+                os_.rdbuf(old_);
+            }
+
+        private:
+            std::ostringstream null_;
+            std::ostream      &os_;
+            std::streambuf    *old_;
+    };
+
+    PortDescriptor RawDescriptor(const std::string &name, PortDirection dir,
+        DataAccessPolicy policy, std::size_t bytes) {
+        PortDescriptor d;
+        d.Name         = name;
+        d.Direction    = dir;
+        d.Type         = PortType::InternalMemory;
+        d.AccessPolicy = policy;
+        d.PayloadSize  = bytes;
+        d.TypeHash     = 0xB0A7B0A7ull ^ bytes;
+        return d;
+    }
+
+    // ------------------------------------------------------------
+    // port.*: typed AddOnPort access as an addon sees it
+    // ------------------------------------------------------------
+    template<DataAccessPolicy Policy>
+    struct TypedPair {
+            using Out = AddOnPort<Packet, "Out", PortDirection::Output, PortType::InternalMemory, Policy>;
+            using In  = AddOnPort<Packet, "In", PortDirection::Input, PortType::InternalMemory, Policy>;
+
+            PortManager pm;
+            Out         out;
+            In          in;
+
+            // `link`: the single-reader write path GraphOptimizer picks
+            explicit TypedPair(bool link = false) {
+                QuietCout quiet;
+                pm.BeginAddon("Producer");
+                pm.CreatePort(out);
+                pm.BeginAddon("Consumer");
+                pm.CreatePort(in);
+                pm.Connect("Producer", "Out", "Consumer", "In");
+                pm.FindPort({"Producer", "Out"})->link = link;
+                pm.BeginAddon("Producer");
+                out.Bind(&pm);
+                pm.BeginAddon("Consumer");
+                in.Bind(&pm);
+            }
+    };
+
+    template<DataAccessPolicy Policy>
+    void BenchTypedPort(Runner &r, const char *policyName) {
+        const std::string writeName = std::string("port.") + policyName + ".write";
+        const std::string readName  = std::string("port.") + policyName + ".read";
+        const std::string newName   = std::string("port.") + policyName + ".read_if_new";
+        if (!r.Enabled(writeName) && !r.Enabled(readName) && !r.Enabled(newName))
+            return;
+
+        TypedPair<Policy> p;
+        r.Run(writeName, "payload=Packet", sizeof(Packet), [&](std::uint64_t n) {
+            Packet pkt{0, 1.0f};
+            for (std::uint64_t i = 0; i < n; ++i) {
+                pkt.value = static_cast<int>(i);
+                p.out.write(pkt);
+            }
+            DoNotOptimize(pkt);
+        });
+        if constexpr (Policy == DataAccessPolicy::Buffered) {
+            TypedPair<Policy> lp(true);
+            r.Run(writeName + "_link", "payload=Packet", sizeof(Packet), [&](std::uint64_t n) {
+                Packet pkt{0, 1.0f};
+                for (std::uint64_t i = 0; i < n; ++i) {
+                    pkt.value = static_cast<int>(i);
+                    lp.out.write(pkt);
+                }
+                DoNotOptimize(pkt);
+            });
+        }
+        r.Run(readName, "payload=Packet", sizeof(Packet), [&](std::uint64_t n) {
+            Packet pkt{};
+            for (std::uint64_t i = 0; i < n; ++i) {
+                p.in.read(pkt);
+                DoNotOptimize(pkt);
+            }
+        });
+        // Nothing new after the first call: only the version is loaded
+        r.Run(newName, "payload=Packet,unchanged", 0, [&](std::uint64_t n) {
+            Packet pkt{};
+            for (std::uint64_t i = 0; i < n; ++i) {
+                p.in.readIfNew(pkt);
+                DoNotOptimize(pkt);
+            }
+        });
+    }
+
+    // port.batch.*: 10k records per tick as one SoA batch vs one port op each
+    constexpr std::size_t kBatchRecords = 10000;
+    using PacketBatch                   = SoABatch<kBatchRecords, int, float>; // value, speed
+
+    template<DataAccessPolicy Policy>
+    struct BatchPair {
+            using Out = AddOnBatchPort<PacketBatch, "Out", PortDirection::Output, PortType::InternalMemory, Policy>;
+            using In  = AddOnBatchPort<PacketBatch, "In", PortDirection::Input, PortType::InternalMemory, Policy>;
+
+            PortManager pm;
+            Out         out;
+            In          in;
+
+            BatchPair() {
+                QuietCout quiet;
+                pm.BeginAddon("Producer");
+                pm.CreatePort(out);
+                pm.BeginAddon("Consumer");
+                pm.CreatePort(in);
+                pm.Connect("Producer", "Out", "Consumer", "In");
+                pm.BeginAddon("Producer");
+                out.Bind(&pm);
+                pm.BeginAddon("Consumer");
+                in.Bind(&pm);
+            }
+    };
+
+    template<DataAccessPolicy Policy>
+    void BenchBatchPort(Runner &r, const char *policyName) {
+        const std::string bench  = std::string("port.batch.") + policyName;
+        const std::string params = "records=" + std::to_string(kBatchRecords);
+        if (!r.Enabled(bench))
+            return;
+
+        // Producer scales a column, consumer reduces another: one tick per op
+        BatchPair<Policy> p;
+        r.Run(bench, params, kBatchRecords * sizeof(Packet), [&](std::uint64_t n) {
+            float sum = 0;
+            for (std::uint64_t i = 0; i < n; ++i) {
+                PacketBatch *b = p.out.batch();
+                b->count       = kBatchRecords;
+                for (float &s : b->template field<1>())
+                    s = static_cast<float>(i) * 0.5f;
+                p.out.publish();
+
+                if (const PacketBatch *in = p.in.read())
+                    for (float s : in->template field<1>())
+                        sum += s;
+            }
+            DoNotOptimize(sum);
+        });
+    }
+
+    // Same tick with one Packet per port operation
+    void BenchPerRecordPort(Runner &r) {
+        const std::string params = "records=" + std::to_string(kBatchRecords);
+        if (!r.Enabled("port.records.direct"))
+            return;
+
+        TypedPair<DataAccessPolicy::Direct> p;
+        r.Run("port.records.direct", params, kBatchRecords * sizeof(Packet), [&](std::uint64_t n) {
+            float sum = 0;
+            for (std::uint64_t i = 0; i < n; ++i) {
+                for (std::size_t k = 0; k < kBatchRecords; ++k) {
+                    p.out.write(Packet{static_cast<int>(k), static_cast<float>(i) * 0.5f});
+                    Packet pkt{};
+                    p.in.read(pkt);
+                    sum += pkt.speed;
+                }
+            }
+            DoNotOptimize(sum);
+        });
+    }
+
+    // port.history.*: timestamped ring shared by every reader
+    constexpr std::size_t kHistorySamples = 4096;
+
+    struct HistoryPair {
+            using Out = AddOnHistoryPort<float, kHistorySamples, "Out", PortDirection::Output, PortType::InternalMemory>;
+            using In  = AddOnHistoryPort<float, kHistorySamples, "In", PortDirection::Input, PortType::InternalMemory>;
+
+            PortManager pm;
+            Out         out;
+            In          in;
+
+            HistoryPair() {
+                QuietCout quiet;
+                pm.BeginAddon("Producer");
+                pm.CreatePort(out);
+                pm.BeginAddon("Consumer");
+                pm.CreatePort(in);
+                pm.Connect("Producer", "Out", "Consumer", "In");
+                pm.BeginAddon("Producer");
+                out.Bind(&pm);
+                pm.BeginAddon("Consumer");
+                in.Bind(&pm);
+            }
+    };
+
+    void BenchHistoryPort(Runner &r) {
+        const std::string params = "samples=" + std::to_string(kHistorySamples);
+        if (!r.Enabled("port.history"))
+            return;
+
+        // Timestamps 10 apart, so queries land between samples
+        HistoryPair   p;
+        std::uint64_t t = 0;
+        r.Run("port.history.push", params, sizeof(float), [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i < n; ++i) {
+                t += 10;
+                p.out.push(t, static_cast<float>(i));
+            }
+        });
+
+        const std::uint64_t first = t - 10 * (kHistorySamples - 2);
+        r.Run("port.history.interpolate", params, 0, [&](std::uint64_t n) {
+            float         v   = 0;
+            std::uint64_t q   = first;
+            float         sum = 0;
+            for (std::uint64_t i = 0; i < n; ++i) {
+                q = first + (q * 2654435761ull) % (t - first);
+                if (p.in.interpolate(q, v))
+                    sum += v;
+            }
+            DoNotOptimize(sum);
+        });
+        r.Run("port.history.range", params + ",window=64", 0, [&](std::uint64_t n) {
+            std::size_t got = 0;
+            for (std::uint64_t i = 0; i < n; ++i) {
+                const std::uint64_t t0 = first + (i * 7919) % (t - first - 640);
+                got += p.in.range(t0, t0 + 630).size();
+            }
+            DoNotOptimize(got);
+        });
+    }
+
+    // port.resource.*: a dataset every addon needs, mapped once and bound to
+    // each addon's resource port, against each addon reading its own copy
+    template<std::size_t Bytes>
+    struct ResourceTable {
+            std::uint8_t bytes[Bytes];
+    };
+
+    template<std::size_t Bytes>
+    void BenchResourceLoad(Runner &r) {
+        using Table = ResourceTable<Bytes>;
+        using Port  = AddOnResourcePort<Table, "Table">;
+
+        constexpr std::size_t kAddons = 8;
+        const auto            file    = (std::filesystem::temp_directory_path() / "PortBench.res").string();
+        {
+            const std::vector<std::uint8_t> data(Bytes, 0x5A);
+            WriteResourceFile(file.c_str(), TypeHashOf<Table>(), data.data(), data.size());
+        }
+        // What an addon does with the table: one read per page
+        auto use = [](const std::uint8_t *p) {
+            std::size_t sum = 0;
+            for (std::size_t off = 0; off < Bytes; off += 4096)
+                sum += p[off];
+            return sum;
+        };
+
+        const std::string params = "bytes=" + std::to_string(Bytes >> 20) + "MiB,addons=" + std::to_string(kAddons);
+        r.Run("port.resource.load", params + ",mode=mmap", Bytes * kAddons, [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i < n; ++i) {
+                QuietCout   quiet;
+                PortManager pm;
+                Port        ports[kAddons];
+                std::size_t sum = 0;
+                for (std::size_t a = 0; a < kAddons; ++a) {
+                    const std::string addon = "Addon" + std::to_string(a);
+                    pm.BeginAddon(addon);
+                    pm.CreatePort(ports[a]);
+                    pm.BindResource({addon, "Table"}, file);
+                    ports[a].Bind(&pm);
+                    sum += ports[a] ? use(ports[a]->bytes) : 0;
+                }
+                DoNotOptimize(sum);
+            }
+        });
+        r.Run("port.resource.load", params + ",mode=copy", Bytes * kAddons, [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i < n; ++i) {
+                std::vector<std::uint8_t> copies[kAddons];
+                std::size_t               sum = 0;
+                for (auto &copy : copies) {
+                    std::ifstream in(file, std::ios::binary);
+                    copy.resize(Bytes);
+                    in.seekg(kResourceHeaderBytes);
+                    in.read(reinterpret_cast<char *>(copy.data()), Bytes);
+                    sum += use(copy.data());
+                }
+                DoNotOptimize(sum);
+            }
+        });
+        std::filesystem::remove(file);
+    }
+
+    void BenchResourcePort(Runner &r, bool quick) {
+        if (!r.Enabled("port.resource"))
+            return;
+        if (quick)
+            BenchResourceLoad<std::size_t(1) << 20>(r);
+        else
+            BenchResourceLoad<std::size_t(64) << 20>(r);
+    }
+
+    // ------------------------------------------------------------
+    // fabric.*: raw PortManager::Read/Write over payload sizes and fan-outs,
+    // the write cost under each delivery policy and with rewiring enabled
+    // ------------------------------------------------------------
+    void ConnectFanout(PortManager &pm, std::size_t bytes, std::size_t fanout, const DeliveryPolicy &policy) {
+        QuietCout quiet;
+        pm.BeginAddon("Src");
+        pm.CreatePort(RawDescriptor("Out", PortDirection::Output, DataAccessPolicy::Buffered, bytes));
+        for (std::size_t i = 0; i < fanout; ++i) {
+            const std::string sink = "Sink" + std::to_string(i);
+            pm.BeginAddon(sink);
+            pm.CreatePort(RawDescriptor("In", PortDirection::Input, DataAccessPolicy::Buffered, bytes));
+            pm.Connect("Src", "Out", sink, "In", policy);
+        }
+    }
+
+    void BenchFabric(Runner &r) {
+        if (!r.Enabled("fabric.write") && !r.Enabled("fabric.read"))
+            return;
+
+        for (std::size_t bytes : {8u, 64u, 1024u, 65536u}) {
+            for (std::size_t fanout : {1u, 4u, 16u}) {
+                PortManager pm;
+                ConnectFanout(pm, bytes, fanout, {});
+                pm.BeginAddon("Src");
+                const PortHandle out = pm.OpenPort("Out");
+                pm.BeginAddon("Sink0");
+                const PortHandle in = pm.OpenPort("In");
+
+                std::vector<std::uint8_t> src(bytes, 0x5A), dst(bytes);
+                const std::string         params = "bytes=" + std::to_string(bytes) +
+                                           ",fanout=" + std::to_string(fanout);
+
+                r.Run("fabric.write", params, bytes * fanout, [&](std::uint64_t n) {
+                    std::size_t wrote = 0;
+                    for (std::uint64_t i = 0; i < n; ++i)
+                        pm.Write(out, src.data(), bytes, wrote);
+                    DoNotOptimize(wrote);
+                });
+                r.Run("fabric.read", params, bytes, [&](std::uint64_t n) {
+                    std::size_t got = 0;
+                    for (std::uint64_t i = 0; i < n; ++i) {
+                        pm.Read(in, dst.data(), bytes, got);
+                        DoNotOptimize(dst.data());
+                    }
+                });
+            }
+        }
+
+        // A fast writer feeding 16 slow readers
+        const std::pair<const char *, DeliveryPolicy> policies[] = {
+            {"every=100", DeliveryPolicy::EveryNth(100)},
+            {"rate=10Hz", DeliveryPolicy::MaxRate(10)},
+            {"conflate", DeliveryPolicy::Conflate()}};
+        for (std::size_t bytes : {1024u, 65536u}) {
+            for (const auto &[name, policy] : policies) {
+                PortManager pm;
+                ConnectFanout(pm, bytes, 16, policy);
+                pm.BeginAddon("Src");
+                const PortHandle out = pm.OpenPort("Out");
+
+                std::vector<std::uint8_t> src(bytes, 0x5A);
+                const std::string         params = "bytes=" + std::to_string(bytes) + ",fanout=16,policy=" + name;
+                r.Run("fabric.write", params, bytes, [&](std::uint64_t n) {
+                    std::size_t wrote = 0;
+                    for (std::uint64_t i = 0; i < n; ++i)
+                        pm.Write(out, src.data(), bytes, wrote);
+                    DoNotOptimize(wrote);
+                });
+            }
+        }
+
+        // The read-side cost of runtime rewiring (RCU guard around the routes)
+        for (std::size_t fanout : {1u, 4u}) {
+            PortManager pm;
+            ConnectFanout(pm, 64, fanout, {});
+            pm.EnableRewiring();
+            pm.BeginAddon("Src");
+            const PortHandle out = pm.OpenPort("Out");
+
+            std::vector<std::uint8_t> src(64, 0x5A);
+            const std::string         params = "bytes=64,fanout=" + std::to_string(fanout) + ",rewiring=on";
+            r.Run("fabric.write", params, 64 * fanout, [&](std::uint64_t n) {
+                std::size_t wrote = 0;
+                for (std::uint64_t i = 0; i < n; ++i)
+                    pm.Write(out, src.data(), 64, wrote);
+                DoNotOptimize(wrote);
+            });
+        }
+    }
+
+    // fabric.policy: which writes each delivery policy lets through. The
+    // writes carry 1, 2, ... and land at the given host times (a virtual
+    // clock); the result is every value the reader saw, read after each write
+    std::vector<std::uint64_t> Deliveries(const DeliveryPolicy &policy, const std::vector<std::uint64_t> &atMs) {
+        HostClock   clock(HostClock::Mode::Virtual);
+        PortManager pm;
+        pm.UseClock(&clock);
+        ConnectFanout(pm, sizeof(std::uint64_t), 2, policy);
+        pm.BeginAddon("Src");
+        const PortHandle out = pm.OpenPort("Out");
+        pm.BeginAddon("Sink1");
+        const PortHandle in = pm.OpenPort("In");
+
+        const std::uint64_t        start = clock.Now();
+        std::vector<std::uint64_t> seen;
+        for (std::size_t i = 0; i < atMs.size(); ++i) {
+            clock.SleepUntil(start + atMs[i] * 1000000);
+            const std::uint64_t v   = i + 1;
+            std::uint64_t       got = 0;
+            std::size_t         n   = 0;
+            pm.Write(out, &v, sizeof(v), n);
+            if (pm.Read(in, &got, sizeof(got), n) && (seen.empty() || seen.back() != got))
+                seen.push_back(got);
+        }
+        return seen;
+    }
+
+    std::string Join(const std::vector<std::uint64_t> &v) {
+        std::string s;
+        for (std::uint64_t x : v)
+            s += (s.empty() ? "" : ",") + std::to_string(x);
+        return s;
+    }
+
+    // fabric.metrics: Direct writes are counted from their stamps, and
+    // re-reading an unchanged Buffered slot is a read but no latency sample
+    void CheckMetrics(Runner &r) {
+        if (!r.Enabled("fabric.metrics"))
+            return;
+
+        PortManager pm;
+        {
+            QuietCout quiet;
+            pm.BeginAddon("Src");
+            pm.CreatePort(RawDescriptor("Direct", PortDirection::Output, DataAccessPolicy::Direct, 64));
+            pm.CreatePort(RawDescriptor("Out", PortDirection::Output, DataAccessPolicy::Buffered, 64));
+            pm.BeginAddon("Dst");
+            pm.CreatePort(RawDescriptor("DirectIn", PortDirection::Input, DataAccessPolicy::Direct, 64));
+            pm.CreatePort(RawDescriptor("In", PortDirection::Input, DataAccessPolicy::Buffered, 64));
+            pm.Connect("Src", "Direct", "Dst", "DirectIn");
+            pm.Connect("Src", "Out", "Dst", "In");
+        }
+        pm.EnableMetrics();
+        pm.BeginAddon("Src");
+        const PortHandle direct = pm.OpenPort("Direct");
+        const PortHandle out    = pm.OpenPort("Out");
+        pm.BeginAddon("Dst");
+        const PortHandle in = pm.OpenPort("In");
+
+        for (int i = 0; i < 3; ++i)
+            StampDirectWrite(direct.impl);
+        pm.EndCycle();
+        const auto writes = pm.metrics()->Port(pm.FindPort({"Src", "Direct"})->id).writes;
+        r.Check("fabric.metrics", writes == 3, "Direct writes counted: " + std::to_string(writes) + ", expected 3");
+
+        std::uint8_t buf[64] = {};
+        std::size_t  n       = 0;
+        pm.Write(out, buf, sizeof(buf), n);
+        for (int i = 0; i < 3; ++i)
+            pm.Read(in, buf, sizeof(buf), n);
+        std::uint32_t conn = 0;
+        for (const auto &c : pm.connections()) {
+            if (c.receiver.port == "In")
+                conn = c.id;
+        }
+        const auto s = pm.metrics()->Connection(conn);
+        r.Check("fabric.metrics", s.reads == 3 && s.LatencySamples() == 1,
+            std::to_string(s.reads) + " reads, " + std::to_string(s.LatencySamples()) +
+                " latency samples, expected 3 and 1");
+    }
+
+    void CheckPolicies(Runner &r) {
+        if (!r.Enabled("fabric.policy"))
+            return;
+        using Values = std::vector<std::uint64_t>;
+
+        const Values every = Deliveries(DeliveryPolicy::EveryNth(3), {0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
+        r.Check("fabric.policy", every == Values{1, 4, 7, 10}, "every=3 delivered " + Join(every));
+
+        // 10 Hz: one write per 100 ms of host time, however fast the writer
+        const Values rate = Deliveries(DeliveryPolicy::MaxRate(10), {0, 50, 99, 100, 150, 250, 260, 349, 350});
+        r.Check("fabric.policy", rate == Values{1, 4, 6, 9}, "rate=10Hz delivered " + Join(rate));
+
+        const Values all = Deliveries(DeliveryPolicy::Conflate(), {0, 0, 0, 0});
+        r.Check("fabric.policy", all == Values{1, 2, 3, 4}, "conflate delivered " + Join(all));
+
+        // Conflate readers share one copy: each sees the latest write
+        {
+            PortManager pm;
+            ConnectFanout(pm, sizeof(std::uint64_t), 2, DeliveryPolicy::Conflate());
+            pm.BeginAddon("Src");
+            const PortHandle out = pm.OpenPort("Out");
+            std::size_t      n   = 0;
+            for (std::uint64_t v = 1; v <= 5; ++v)
+                pm.Write(out, &v, sizeof(v), n);
+            for (const char *sink : {"Sink0", "Sink1"}) {
+                pm.BeginAddon(sink);
+                std::uint64_t got = 0;
+                pm.Read(pm.OpenPort("In"), &got, sizeof(got), n);
+                r.Check("fabric.policy", got == 5, std::string(sink) + " read " + std::to_string(got) + ", expected 5");
+            }
+        }
+
+        // Values Admit() cannot honour, and policies on Direct connections
+        QuietCout   quiet, quietErr(std::cerr);
+        PortManager pm;
+        pm.BeginAddon("Src");
+        pm.CreatePort(RawDescriptor("Out", PortDirection::Output, DataAccessPolicy::Buffered, 8));
+        pm.CreatePort(RawDescriptor("Direct", PortDirection::Output, DataAccessPolicy::Direct, 8));
+        pm.BeginAddon("Sink");
+        pm.CreatePort(RawDescriptor("In", PortDirection::Input, DataAccessPolicy::Buffered, 8));
+        pm.CreatePort(RawDescriptor("DirectIn", PortDirection::Input, DataAccessPolicy::Direct, 8));
+        const std::pair<const char *, DeliveryPolicy> invalid[] = {
+            {"every=0", DeliveryPolicy::EveryNth(0)},
+            {"rate=0", DeliveryPolicy::MaxRate(0)},
+            {"rate=-1", DeliveryPolicy::MaxRate(-1)}};
+        for (const auto &[name, policy] : invalid)
+            r.Check("fabric.policy", !pm.Connect("Src", "Out", "Sink", "In", policy), std::string(name) + " accepted");
+        r.Check("fabric.policy", !pm.Connect("Src", "Direct", "Sink", "DirectIn", DeliveryPolicy::EveryNth(2)),
+            "policy on a Direct connection accepted");
+    }
+
+    // fabric.rewire: Disconnect()/Connect() on a control thread while the
+    // writer runs. The untouched reader never sees a value go back, a
+    // reconnected reader gets the next write and continues its sequence.
+    void CheckRewiring(Runner &r) {
+        if (!r.Enabled("fabric.rewire"))
+            return;
+
+        QuietCout   quiet;
+        PortManager pm;
+        ConnectFanout(pm, sizeof(std::uint64_t), 2, {});
+        pm.EnableRewiring();
+        pm.BeginAddon("Src");
+        const PortHandle out = pm.OpenPort("Out");
+        pm.BeginAddon("Sink0");
+        const PortHandle in0 = pm.OpenPort("In");
+        pm.BeginAddon("Sink1");
+        const PortHandle in1 = pm.OpenPort("In");
+
+        const PortManager::PortKey src{"Src", "Out"}, sink1{"Sink1", "In"};
+        std::uint64_t              v = 0;
+        std::size_t                n = 0;
+
+        auto write = [&] {
+            ++v;
+            pm.Write(out, &v, sizeof(v), n);
+        };
+        auto read = [&](PortHandle in) {
+            std::uint64_t got = 0;
+            pm.Read(in, &got, sizeof(got), n);
+            return got;
+        };
+
+        write();
+        MessageHeader before{};
+        pm.ReadHeader(in1, before);
+        r.Check("fabric.rewire", pm.Disconnect(src, sink1), "Disconnect failed");
+        write();
+        r.Check("fabric.rewire", pm.Connect(src, sink1), "Connect failed");
+        write();
+        MessageHeader after{};
+        pm.ReadHeader(in1, after);
+        r.Check("fabric.rewire", read(in0) == v && read(in1) == v,
+            "after reconnecting, the readers hold " + std::to_string(read(in0)) + " and " +
+                std::to_string(read(in1)) + ", expected " + std::to_string(v));
+        r.Check("fabric.rewire", after.sequence > before.sequence,
+            "reconnected sequence " + std::to_string(after.sequence) + " after " + std::to_string(before.sequence));
+
+        // Concurrent: the writer also checks the reader it never loses
+        std::atomic<bool> stop{false};
+        bool              ordered = true;
+        std::thread       writer([&] {
+            std::uint64_t last = read(in0);
+            while (!stop.load(std::memory_order_relaxed)) {
+                write();
+                const std::uint64_t got = read(in0);
+                ordered                 = ordered && got == v && got > last;
+                last                    = got;
+            }
+        });
+        for (int i = 0; i < 200; ++i) {
+            pm.Disconnect(src, sink1);
+            pm.Connect(src, sink1);
+        }
+        stop.store(true, std::memory_order_relaxed);
+        writer.join();
+        write();
+        r.Check("fabric.rewire", ordered, "Sink0 missed a write or went back while Sink1 was rewired");
+        r.Check("fabric.rewire", read(in1) == v,
+            "Sink1 holds " + std::to_string(read(in1)) + " after rewiring, expected " + std::to_string(v));
+    }
+
+    // ------------------------------------------------------------
+    // graph.*: Connect / OpenPort at scale, port discovery
+    // ------------------------------------------------------------
+    // Port-heavy addon for discovery: 32 ports "p00".."p31" in one PortSet
+    template<std::size_t I>
+    struct BenchPortName {
+            static constexpr char value[4] = {'p', char('0' + I / 10), char('0' + I % 10), '\0'};
+    };
+    template<std::size_t I>
+    using BenchPortT = AddOnPort<Packet, fixed_string<4>(BenchPortName<I>::value),
+        PortDirection::Output, PortType::InternalMemory, DataAccessPolicy::Buffered>;
+
+    template<std::size_t... I>
+    PortSet<BenchPortT<I>...> MakeBenchPorts(std::index_sequence<I...>);
+    using BenchPorts = decltype(MakeBenchPorts(std::make_index_sequence<32>{}));
+
+    void BenchDiscovery(Runner &r) {
+        const std::string ports = "ports=" + std::to_string(BenchPorts::descriptors.size());
+
+        // What getPortDescriptors() costs: one vector plus one string per port
+        r.Run("graph.discover", ports + ",api=vector", 0, [](std::uint64_t n) {
+            for (std::uint64_t i = 0; i < n; ++i) {
+                const PortTable             t = BenchPorts::table();
+                std::vector<PortDescriptor> v(t.begin(), t.end());
+                DoNotOptimize(v.data());
+            }
+        });
+        r.Run("graph.discover", ports + ",api=table", 0, [](std::uint64_t n) {
+            for (std::uint64_t i = 0; i < n; ++i) {
+                std::size_t bytes = 0;
+                for (const auto &d : BenchPorts::table())
+                    bytes += d.PayloadSize;
+                DoNotOptimize(bytes);
+            }
+        });
+    }
+
+    void BuildChains(PortManager &pm, std::size_t pairs) {
+        QuietCout quiet;
+        for (std::size_t i = 0; i < pairs; ++i) {
+            pm.BeginAddon("P" + std::to_string(i));
+            pm.CreatePort(RawDescriptor("Out", PortDirection::Output, DataAccessPolicy::Buffered, 64));
+            pm.BeginAddon("C" + std::to_string(i));
+            pm.CreatePort(RawDescriptor("In", PortDirection::Input, DataAccessPolicy::Buffered, 64));
+        }
+    }
+
+    void BenchGraph(Runner &r, bool quick) {
+        if (!r.Enabled("graph."))
+            return;
+
+        const std::size_t pairs  = quick ? 200 : 2000;
+        const std::string params = "pairs=" + std::to_string(pairs);
+
+        PortManager pm;
+        BuildChains(pm, pairs);
+
+        r.RunOnce("graph.connect", params, pairs, [&] {
+            QuietCout quiet;
+            for (std::size_t i = 0; i < pairs; ++i)
+                pm.Connect("P" + std::to_string(i), "Out", "C" + std::to_string(i), "In");
+        });
+
+        std::vector<std::string> names;
+        for (std::size_t i = 0; i < pairs; ++i)
+            names.push_back("C" + std::to_string(i));
+        r.RunOnce("graph.openport", params, pairs, [&] {
+            for (const auto &n : names) {
+                pm.BeginAddon(n);
+                DoNotOptimize(pm.OpenPort("In"));
+            }
+        });
+    
+        BenchDiscovery(r);
+    }
+
+    // ------------------------------------------------------------
+    // project.*: SaveToFile / LoadFromFile
+    // ------------------------------------------------------------
+    void BenchProject(Runner &r, bool quick) {
+        if (!r.Enabled("project."))
+            return;
+
+        const std::size_t pairs  = quick ? 200 : 2000;
+        const std::string params = "ports=" + std::to_string(pairs * 2);
+        const auto        file   = (std::filesystem::temp_directory_path() / "PortBench.pmproj").string();
+
+        PortManager pm;
+        BuildChains(pm, pairs);
+        {
+            QuietCout quiet;
+            for (std::size_t i = 0; i < pairs; ++i)
+                pm.Connect("P" + std::to_string(i), "Out", "C" + std::to_string(i), "In");
+        }
+
+        r.RunOnce("project.save", params, 1, [&] { pm.SaveToFile(file); });
+        r.RunOnce("project.load", params, 1, [&] {
+            PortManager loaded;
+            loaded.LoadFromFile(file);
+            DoNotOptimize(loaded.ports().size());
+        });
+        std::filesystem::remove(file);
+    }
+
+    // project.roundtrip: delivery policies survive a save and load (PMv2),
+    // PMv1 files load with every connection on All, and a PMv2 policy that
+    // Connect() would refuse is refused on load too
+    void CheckProjectRoundTrip(Runner &r) {
+        if (!r.Enabled("project.roundtrip"))
+            return;
+        using Mode = DeliveryPolicy::Mode;
+
+        const auto           file       = (std::filesystem::temp_directory_path() / "PortBench.pmproj").string();
+        const DeliveryPolicy policies[] = {
+            {}, DeliveryPolicy::EveryNth(3), DeliveryPolicy::MaxRate(2.5), DeliveryPolicy::Conflate()};
+        constexpr std::size_t kPairs = std::size(policies);
+
+        QuietCout   quiet, quietErr(std::cerr);
+        PortManager pm;
+        BuildChains(pm, kPairs);
+        for (std::size_t i = 0; i < kPairs; ++i)
+            pm.Connect("P" + std::to_string(i), "Out", "C" + std::to_string(i), "In", policies[i]);
+        if (!r.Check("project.roundtrip", pm.SaveToFile(file), "cannot save " + file))
+            return;
+
+        auto policyOf = [](const PortManager &m, std::size_t i) {
+            for (const auto &c : m.connections()) {
+                if (c.provider.addon == "P" + std::to_string(i))
+                    return c.policy;
+            }
+            return DeliveryPolicy{Mode::All, -1};
+        };
+        {
+            PortManager loaded;
+            const bool  ok = loaded.LoadFromFile(file);
+            for (std::size_t i = 0; ok && i < kPairs; ++i) {
+                const DeliveryPolicy got = policyOf(loaded, i);
+                r.Check("project.roundtrip", got.mode == policies[i].mode && got.value == policies[i].value,
+                    "PMv2 connection " + std::to_string(i) + " came back as mode " +
+                        std::to_string(static_cast<int>(got.mode)) + ", value " + std::to_string(got.value));
+            }
+            r.Check("project.roundtrip", ok && loaded.connections().size() == kPairs, "PMv2 load failed");
+        }
+
+        // Same graph as PMv1: no policy line after each connection's four name lines
+        std::vector<std::string> lines;
+        {
+            std::ifstream in(file);
+            for (std::string line; std::getline(in, line);)
+                lines.push_back(line);
+        }
+        const std::size_t connStart = 2 + 3 * 2 * kPairs; // magic, counts, three lines per port
+        auto              writeFile = [&](const std::vector<std::string> &out) {
+            std::ofstream f(file, std::ios::trunc);
+            for (const auto &line : out)
+                f << line << "\n";
+        };
+        {
+            std::vector<std::string> v1(lines.begin(), lines.begin() + connStart);
+            v1[0] = "PMv1";
+            for (std::size_t i = connStart; i + 5 <= lines.size(); i += 5)
+                v1.insert(v1.end(), lines.begin() + i, lines.begin() + i + 4);
+            writeFile(v1);
+
+            PortManager loaded;
+            const bool  ok  = loaded.LoadFromFile(file);
+            bool        all = ok && loaded.connections().size() == kPairs;
+            for (std::size_t i = 0; all && i < kPairs; ++i)
+                all = policyOf(loaded, i).mode == Mode::All;
+            r.Check("project.roundtrip", all, "PMv1 graph did not load with every connection on All");
+        }
+
+        // A countdown of 0 and a rate of 0 Hz, written by hand
+        for (const char *bad : {"1 0", "2 0", "2 -1"}) {
+            std::vector<std::string> v2 = lines;
+            for (std::size_t i = connStart + 4; i < v2.size(); i += 5) {
+                if (v2[i] != "0 0" && v2[i][0] != '3')
+                    v2[i] = bad;
+            }
+            writeFile(v2);
+            PortManager loaded;
+            r.Check("project.roundtrip", !loaded.LoadFromFile(file), std::string("PMv2 policy '") + bad + "' accepted");
+        }
+        std::filesystem::remove(file);
+    }
+
+    // ------------------------------------------------------------
+    // cycle.*: full runCycle() over in-process addons
+    // ------------------------------------------------------------
+    class BenchProducer: public IPlugin {
+        public:
+            using OutT = AddOnPort<Packet, "Out", PortDirection::Output, PortType::InternalMemory,
+                DataAccessPolicy::Buffered>;
+
+            std::vector<PortDescriptor> getPortDescriptors() const override {
+                return {Out};
+            }
+            void initialize(IHostServices *svc) override {
+                Out.Bind(svc);
+            }
+            void run() override {
+                Out.write(Packet{tick_++, 0.5f});
+            }
+            void shutdown() override {}
+
+        private:
+            OutT Out{};
+            int  tick_ = 0;
+    };
+
+    class BenchRelay: public IPlugin {
+        public:
+            using InT  = AddOnPort<Packet, "In", PortDirection::Input, PortType::InternalMemory,
+                 DataAccessPolicy::Buffered>;
+            using OutT = AddOnPort<Packet, "Out", PortDirection::Output, PortType::InternalMemory,
+                DataAccessPolicy::Buffered>;
+
+            std::vector<PortDescriptor> getPortDescriptors() const override {
+                return {In, Out};
+            }
+            void initialize(IHostServices *svc) override {
+                In.Bind(svc);
+                Out.Bind(svc);
+            }
+            void run() override {
+                Packet p{};
+                if (In.read(p)) {
+                    p.value += 1;
+                    Out.write(p);
+                }
+            }
+            void shutdown() override {}
+
+        private:
+            InT  In{};
+            OutT Out{};
+    };
+
+    // Keeps every value it receives, for the checks
+    class BenchSink: public IPlugin {
+        public:
+            using InT = AddOnPort<Packet, "In", PortDirection::Input, PortType::InternalMemory,
+                DataAccessPolicy::Buffered>;
+
+            std::vector<PortDescriptor> getPortDescriptors() const override {
+                return {In};
+            }
+            void initialize(IHostServices *svc) override {
+                In.Bind(svc);
+            }
+            void run() override {
+                Packet p{};
+                if (In.readIfNew(p))
+                    seen.push_back(p.value);
+            }
+            void shutdown() override {}
+
+            std::vector<int> seen;
+
+        private:
+            InT In{};
+    };
+
+    // A0 -> A1 -> ... -> A<chain-1> in-process, plus an optional sink at the end
+    struct BenchChain {
+            AddOnManager                          mgr;
+            PortManager                           pm;
+            std::vector<std::unique_ptr<IPlugin>> owned;
+            BenchSink                            *sink = nullptr;
+
+            BenchChain(std::size_t chain, bool withSink) {
+                add("A0", std::make_unique<BenchProducer>());
+                for (std::size_t i = 1; i < chain; ++i)
+                    add("A" + std::to_string(i), std::make_unique<BenchRelay>());
+                if (withSink) {
+                    auto s = std::make_unique<BenchSink>();
+                    sink   = s.get();
+                    add("Sink", std::move(s));
+                }
+
+                QuietCout quiet;
+                mgr.discoverPortsForAll(pm);
+                for (std::size_t i = 1; i < chain; ++i)
+                    pm.Connect("A" + std::to_string(i - 1), "Out", "A" + std::to_string(i), "In");
+                if (withSink)
+                    pm.Connect("A" + std::to_string(chain - 1), "Out", "Sink", "In");
+            }
+
+            void add(std::string name, std::unique_ptr<IPlugin> p) {
+                AddOnManager::AddOn a;
+                a.path   = name;
+                a.name   = std::move(name);
+                a.plugin = p.get();
+                mgr.addons().push_back(std::move(a)); // no destroyFn: owned here
+                owned.push_back(std::move(p));
+            }
+    };
+
+    // Declares itself light, so the GraphOptimizer may fuse it with its neighbours
+    template<class Base>
+    class BenchLight: public Base {
+        public:
+            ExecutionHints getExecutionHints() const override {
+                return {ThreadingModel::CycleThread, true};
+            }
+    };
+
+    // graph.prune / graph.link / graph.fuse: what GraphOptimizer::Run() does
+    // to a small in-process graph
+    void CheckOptimizer(Runner &r) {
+        if (r.Enabled("graph.prune")) {
+            // A0 -> A1 -> Sink, A0 -> Dead (whose Out leads nowhere), Idle alone
+            BenchChain g(2, true);
+            QuietCout  quiet;
+            g.add("Dead", std::make_unique<BenchRelay>());
+            g.add("Idle", std::make_unique<BenchProducer>());
+            for (std::size_t i = g.mgr.addons().size() - 2; i < g.mgr.addons().size(); ++i)
+                AddOnManager::discoverPorts(g.mgr.addons()[i], g.pm);
+            g.pm.Connect("A0", "Out", "Dead", "In");
+
+            const auto rep = GraphOptimizer::Run(g.mgr, g.pm);
+            r.Check("graph.prune", rep.prunedAddons == std::vector<std::string>{"Idle"} && !g.mgr.find("Idle")->enabled,
+                std::to_string(rep.prunedAddons.size()) + " addons pruned, expected only Idle");
+            r.Check("graph.prune", g.pm.FindPort({"Dead", "Out"})->pruned && !g.pm.FindPort({"A0", "Out"})->pruned &&
+                                       !g.pm.FindPort({"Dead", "In"})->pruned,
+                "expected exactly the dead-end Dead::Out among these ports to be pruned");
+            g.mgr.initializeAll(g.pm);
+            g.mgr.runCycle(); // a pruned port's handle is a no-op, not a crash
+            g.mgr.shutdownAll();
+        }
+
+        if (r.Enabled("graph.link")) {
+            BenchChain g(2, true);
+            QuietCout  quiet, quietErr(std::cerr);
+            g.add("Extra", std::make_unique<BenchSink>());
+            AddOnManager::discoverPorts(g.mgr.addons().back(), g.pm);
+
+            GraphOptimizer::Run(g.mgr, g.pm);
+            const bool link = g.pm.FindPort({"A1", "Out"})->link;
+            r.Check("graph.link", link, "A1::Out (one reader) was not specialized");
+            r.Check("graph.link", !link || !g.pm.Connect("A1", "Out", "Extra", "In"),
+                "a specialized link accepted a second reader");
+        }
+
+        if (r.Enabled("graph.fuse")) {
+            // Declared backwards: L2 (sink), L0 (producer), L1 (relay)
+            AddOnManager                          mgr;
+            PortManager                           pm;
+            std::vector<std::unique_ptr<IPlugin>> owned;
+            auto                                  add = [&](std::string name, std::unique_ptr<IPlugin> p) {
+                AddOnManager::AddOn a;
+                a.path   = name;
+                a.name   = std::move(name);
+                a.plugin = p.get();
+                mgr.addons().push_back(std::move(a));
+                owned.push_back(std::move(p));
+            };
+            auto  sink = std::make_unique<BenchLight<BenchSink>>();
+            auto *seen = &sink->seen;
+            add("L2", std::move(sink));
+            add("L0", std::make_unique<BenchLight<BenchProducer>>());
+            add("L1", std::make_unique<BenchLight<BenchRelay>>());
+
+            QuietCout quiet;
+            mgr.discoverPortsForAll(pm);
+            pm.Connect("L0", "Out", "L1", "In");
+            pm.Connect("L1", "Out", "L2", "In");
+            const auto rep = GraphOptimizer::Run(mgr, pm);
+
+            std::string order;
+            for (const auto &a : mgr.addons())
+                order += (order.empty() ? "" : ",") + a.name + "@" + std::to_string(a.unit);
+            r.Check("graph.fuse", rep.fusedChains.size() == 1 && order == "L0@0,L1@0,L2@0",
+                "order " + order + ", expected L0@0,L1@0,L2@0");
+
+            // In topological order the value crosses the whole chain in one cycle
+            mgr.initializeAll(pm);
+            mgr.runCycle();
+            r.Check("graph.fuse", seen->size() == 1 && seen->front() == 1, "the fused chain lagged behind");
+            mgr.shutdownAll();
+        }
+    }
+
+    // cycle.clock: on a virtual clock every CycleScheduler cycle sees Now()
+    // exactly one period later, and a 10 Hz MaxRate connection admits one
+    // write per 100 ms of that time, however little wall time passes
+    void CheckVirtualClock(Runner &r) {
+        if (!r.Enabled("cycle.clock"))
+            return;
+
+        constexpr std::uint64_t kPeriodNs = 10'000'000; // 100 cycles = 1 s
+        HostClock               clock(HostClock::Mode::Virtual);
+        PortManager             pm;
+        pm.UseClock(&clock);
+        ConnectFanout(pm, sizeof(std::uint64_t), 1, DeliveryPolicy::MaxRate(10));
+        pm.BeginAddon("Src");
+        const PortHandle out = pm.OpenPort("Out");
+        pm.BeginAddon("Sink0");
+        const PortHandle in = pm.OpenPort("In");
+
+        CycleScheduler scheduler(clock, kPeriodNs);
+        std::uint64_t  prev = 0, admitted = 0, last = 0, badSteps = 0;
+        for (std::uint64_t i = 1; i <= 100; ++i) {
+            scheduler.WaitNext();
+            const std::uint64_t now = clock.Now();
+            if (i > 1 && now - prev != kPeriodNs)
+                ++badSteps;
+            prev = now;
+
+            std::uint64_t got = 0;
+            std::size_t   n   = 0;
+            pm.Write(out, &i, sizeof(i), n);
+            if (pm.Read(in, &got, sizeof(got), n) && got != last) {
+                ++admitted;
+                last = got;
+            }
+        }
+        r.Check("cycle.clock", badSteps == 0 && scheduler.stats().cycles == 100 && scheduler.stats().late == 0,
+            std::to_string(badSteps) + " cycles did not advance Now() by exactly one period");
+        r.Check("cycle.clock", admitted == 10, "rate=10Hz admitted " + std::to_string(admitted) + " writes in 1 s, expected 10");
+    }
+
+    void BenchCycle(Runner &r) {
+        if (!r.Enabled("cycle.run"))
+            return;
+
+        for (std::size_t chain : {2u, 8u, 32u}) {
+            BenchChain g(chain, false);
+            {
+                QuietCout quiet;
+                g.mgr.initializeAll(g.pm);
+            }
+
+            r.Run("cycle.run", "addons=" + std::to_string(chain), sizeof(Packet) * (chain - 1),
+                [&](std::uint64_t n) {
+                    for (std::uint64_t i = 0; i < n; ++i)
+                        g.mgr.runCycle();
+                });
+
+            QuietCout quiet;
+            g.mgr.shutdownAll();
+        }
+    }
+
+    // cycle.replay: a recorded run played back, with every addon regenerating
+    // its ports and with the producer's writes injected from the log, has to
+    // hand the sink the same values as the live run
+    void CheckReplay(Runner &r) {
+        if (!r.Enabled("cycle.replay"))
+            return;
+
+        constexpr std::size_t kCycles = 20;
+        const auto            file    = (std::filesystem::temp_directory_path() / "PortBench.prlog").string();
+
+        std::vector<int> live;
+        {
+            BenchChain g(2, true);
+            QuietCout  quiet;
+            if (!r.Check("cycle.replay", g.pm.StartRecording(file), "cannot record to " + file))
+                return;
+            g.mgr.initializeAll(g.pm);
+            for (std::size_t i = 0; i < kCycles; ++i)
+                g.mgr.runCycle();
+            g.pm.StopRecording();
+            g.mgr.shutdownAll();
+            live = g.sink->seen;
+        }
+        r.Check("cycle.replay", live.size() == kCycles, "live run delivered " + std::to_string(live.size()));
+
+        const std::pair<const char *, std::set<std::string>> runs[] = {
+            {"all addons", {}},
+            {"A1,Sink", {"A1", "Sink"}}};
+        for (const auto &[name, addons] : runs) {
+            BenchChain   g(2, true);
+            PortReplayer replayer;
+            std::size_t  cycles = 0;
+            {
+                QuietCout quiet;
+                if (replayer.Open(file)) {
+                    g.mgr.initializeAll(g.pm);
+                    cycles = replayer.Replay(g.pm, g.mgr, addons, PortReplayer::Timing::AsFastAsPossible);
+                    g.mgr.shutdownAll();
+                }
+            }
+            r.Check("cycle.replay", cycles == kCycles && g.sink->seen == live,
+                std::string(name) + ": " + std::to_string(cycles) + " cycles, " + std::to_string(g.sink->seen.size()) +
+                    " values, expected the live run's " + std::to_string(kCycles));
+        }
+
+        // A log cut inside its last record is refused instead of read past the end
+        {
+            std::fstream      f(file, std::ios::in | std::ios::out | std::ios::binary);
+            PortLog::LogHeader hdr{};
+            f.read(reinterpret_cast<char *>(&hdr), sizeof(hdr));
+            hdr.dataBytes -= 4;
+            f.seekp(0);
+            f.write(reinterpret_cast<const char *>(&hdr), sizeof(hdr));
+        }
+        {
+            QuietCout    quiet, quietErr(std::cerr);
+            PortReplayer replayer;
+            r.Check("cycle.replay", !replayer.Open(file), "truncated log accepted");
+        }
+        std::filesystem::remove(file);
+    }
+
+    // cycle.restore: a checkpoint taken after a run puts the last value of
+    // every connection back into a fresh graph
+    void CheckRestore(Runner &r) {
+        if (!r.Enabled("cycle.restore"))
+            return;
+
+        const auto file = (std::filesystem::temp_directory_path() / "PortBench.ckpt").string();
+        int        last = 0;
+        {
+            BenchChain g(2, true);
+            QuietCout  quiet;
+            g.mgr.initializeAll(g.pm);
+            for (int i = 0; i < 10; ++i)
+                g.mgr.runCycle();
+            last = g.sink->seen.empty() ? -1 : g.sink->seen.back();
+            if (!r.Check("cycle.restore", Checkpoint::Save(file, g.pm, g.mgr), "cannot save " + file))
+                return;
+            g.mgr.shutdownAll();
+        }
+        {
+            BenchChain        g(2, true);
+            Checkpoint::Stats st;
+            bool              restored = false;
+            {
+                QuietCout quiet;
+                g.mgr.initializeAll(g.pm);
+                restored = Checkpoint::Restore(file, g.pm, g.mgr, &st);
+            }
+            r.Check("cycle.restore", restored && st.buffers == 2 && st.skipped == 0,
+                "restored " + std::to_string(st.buffers) + " of 2 buffers, " + std::to_string(st.skipped) + " skipped");
+
+            Packet got{-1, 0};
+            for (const auto &c : g.pm.connections()) {
+                if (c.receiver.addon == "Sink" && c.slot && c.slot->hasData)
+                    std::memcpy(&got, c.data, sizeof(got));
+            }
+            r.Check("cycle.restore", got.value == last,
+                "sink buffer holds " + std::to_string(got.value) + ", expected " + std::to_string(last));
+
+            // The restored value is new to readIfNew(), before any producer runs
+            g.sink->run();
+            r.Check("cycle.restore", g.sink->seen.size() == 1 && g.sink->seen.back() == last,
+                "readIfNew() did not report the restored value");
+            QuietCout quiet;
+            g.mgr.shutdownAll();
+        }
+
+        // A section claiming more bytes than the file holds is refused
+        {
+            std::fstream f(file, std::ios::in | std::ios::out | std::ios::binary);
+            const std::uint64_t huge = ~std::uint64_t(0) >> 1;
+            f.seekp(16 + 16); // FileHeader, then SectionHeader::bytes of the first section
+            f.write(reinterpret_cast<const char *>(&huge), sizeof(huge));
+        }
+        {
+            QuietCout  quiet, quietErr(std::cerr);
+            BenchChain g(2, true);
+            r.Check("cycle.restore", !Checkpoint::Restore(file, g.pm, g.mgr), "corrupt checkpoint accepted");
+        }
+        std::filesystem::remove(file);
+    }
+
+    // Takes its runner down on every run()
+    class BenchKiller: public IPlugin {
+        public:
+            std::vector<PortDescriptor> getPortDescriptors() const override {
+                return {};
+            }
+            void initialize(IHostServices *) override {}
+            void run() override {
+                ::raise(SIGKILL);
+            }
+            void shutdown() override {}
+    };
+
+    // cycle.isolate: a runner killed mid-cycle is forked again, up to
+    // RunnerPool::kMaxRestarts times; then its addons are disabled
+    void CheckIsolation(Runner &r) {
+        if (!r.Enabled("cycle.isolate"))
+            return;
+
+        AddOnManager mgr;
+        PortManager  pm;
+        BenchKiller  killer;
+        QuietCout    quiet, quietErr(std::cerr);
+        if (!r.Check("cycle.isolate", pm.UseSharedTransports(), "no shared transports"))
+            return;
+        AddOnManager::AddOn a;
+        a.path = a.name = "Killer";
+        a.plugin        = &killer;
+        mgr.addons().push_back(std::move(a));
+        mgr.discoverPortsForAll(pm);
+        if (!r.Check("cycle.isolate", mgr.isolate({{"Killer"}}), "isolate() failed"))
+            return;
+        mgr.initializeAll(pm);
+
+        mgr.runCycle();
+        r.Check("cycle.isolate", mgr.runners()->alive(0) && mgr.find("Killer")->enabled,
+            "killed runner was not restarted");
+
+        for (std::uint32_t i = 0; i < RunnerPool::kMaxRestarts; ++i)
+            mgr.runCycle();
+        r.Check("cycle.isolate", !mgr.runners()->alive(0) && !mgr.find("Killer")->enabled,
+            "runner killed " + std::to_string(RunnerPool::kMaxRestarts + 1) + " times was not given up");
+        mgr.shutdownAll();
+    }
+
+    // ------------------------------------------------------------
+    // memory.*: addon allocations, global heap vs the host's AddonMemory
+    // ------------------------------------------------------------
+    void BenchMemory(Runner &r) {
+        if (!r.Enabled("memory.alloc"))
+            return;
+
+        // Sliding window of 64 live blocks of 16..512 bytes; one op is one
+        // allocate plus the deallocate of the block it replaces
+        constexpr std::size_t kWindow = 64;
+        auto churn = [](std::pmr::memory_resource *mr, std::uint64_t n) {
+            void       *live[kWindow] = {};
+            std::size_t size[kWindow] = {};
+            for (std::uint64_t i = 0; i < n; ++i) {
+                const std::size_t slot = i % kWindow;
+                if (live[slot])
+                    mr->deallocate(live[slot], size[slot]);
+                size[slot] = 16u << (i * 2654435761u >> 7) % 6;
+                live[slot] = mr->allocate(size[slot]);
+                DoNotOptimize(live[slot]);
+            }
+            for (std::size_t slot = 0; slot < kWindow; ++slot) {
+                if (live[slot])
+                    mr->deallocate(live[slot], size[slot]);
+            }
+        };
+
+        AddonMemory addon;
+        r.Run("memory.alloc.new_delete", "window=64", 0, [&](std::uint64_t n) { churn(std::pmr::new_delete_resource(), n); });
+        r.Run("memory.alloc.addon", "window=64", 0, [&](std::uint64_t n) { churn(&addon, n); });
+    }
+
+    // Keeps one more KiB of the host's per-addon resource on every run()
+    class BenchHog: public IPlugin {
+        public:
+            static constexpr std::size_t kBlock = 1024;
+
+            std::vector<PortDescriptor> getPortDescriptors() const override {
+                return {};
+            }
+            void initialize(IHostServices *svc) override {
+                memory_ = svc->Memory();
+            }
+            void run() override {
+                blocks_.push_back(memory_->allocate(kBlock));
+            }
+            void shutdown() override {
+                for (void *p : blocks_)
+                    memory_->deallocate(p, kBlock);
+                blocks_.clear();
+            }
+
+        private:
+            std::pmr::memory_resource *memory_ = nullptr;
+            std::vector<void *>        blocks_;
+    };
+
+    // memory.budget / memory.shutdown: the allocation past an addon's budget
+    // disables it (OverBudget); shutdown gives every byte back.
+    // memory.cross_thread: a block freed by another thread is reused by the owner.
+    void CheckMemory(Runner &r) {
+        if (r.Enabled("memory.budget") || r.Enabled("memory.shutdown")) {
+            AddOnManager mgr;
+            PortManager  pm;
+            BenchHog     hog;
+            QuietCout    quiet, quietErr(std::cerr);
+            AddOnManager::AddOn a;
+            a.path = a.name = "Hog";
+            a.plugin        = &hog;
+            mgr.addons().push_back(std::move(a));
+            mgr.setMemoryBudget("Hog", 4 * BenchHog::kBlock);
+            mgr.initializeAll(pm);
+            for (int i = 0; i < 8; ++i)
+                mgr.runCycle();
+
+            const AddOnManager::AddOn &h = *mgr.find("Hog");
+            const auto                 m = h.memory->stats();
+            r.Check("memory.budget", !h.enabled && m.rejected == 1 && m.live == 4 * BenchHog::kBlock,
+                "enabled=" + std::to_string(h.enabled) + ", " + std::to_string(m.rejected) + " rejected, " +
+                    std::to_string(m.live) + " B live; expected disabled, 1 and " +
+                    std::to_string(4 * BenchHog::kBlock));
+            mgr.shutdownAll();
+            r.Check("memory.shutdown", h.memory->stats().live == 0,
+                std::to_string(h.memory->stats().live) + " B still live after shutdown");
+        }
+
+        if (r.Enabled("memory.cross_thread")) {
+            // 32 blocks use up the owner's first refill, so its next
+            // allocation has to come from the shared free list
+            AddonMemory         mem;
+            std::vector<void *> blocks;
+            for (int i = 0; i < 32; ++i)
+                blocks.push_back(mem.allocate(64));
+            void *freed = blocks.back();
+            blocks.pop_back();
+            std::thread([&] { mem.deallocate(freed, 64); }).join();
+            blocks.push_back(mem.allocate(64));
+            r.Check("memory.cross_thread", blocks.back() == freed, "owner did not reuse the block freed elsewhere");
+            r.Check("memory.cross_thread", mem.stats().live == 32 * 64,
+                std::to_string(mem.stats().live) + " B live, expected " + std::to_string(32 * 64));
+            for (void *p : blocks)
+                mem.deallocate(p, 64);
+            r.Check("memory.cross_thread", mem.stats().live == 0,
+                std::to_string(mem.stats().live) + " B live after freeing everything");
+        }
+    }
+
+    // ------------------------------------------------------------
+    // log.*: a per-tick log line, ostream formatting vs a HostLogger record
+    // ------------------------------------------------------------
+    void BenchLog(Runner &r) {
+        if (!r.Enabled("log.ostream") && !r.Enabled("log.async") && !r.Enabled("log.rate_limited"))
+            return;
+        constexpr std::uint64_t kRecords = 50000;
+
+        std::ostringstream os;
+        r.RunOnce("log.ostream", "args=3", kRecords, [&] {
+            for (std::uint64_t i = 0; i < kRecords; ++i) {
+                os << "[Bench] value=" << i << " speed=" << 3.14f * static_cast<float>(i) << " seq=" << i << "\n";
+                if ((i & 1023) == 1023)
+                    os.str({});
+            }
+        });
+
+        std::FILE *sink = std::tmpfile();
+        if (!sink)
+            return;
+        {
+            // Ring large enough for the whole burst: times the record, not drops
+            HostLogger          log(std::size_t(4) << 20, sink, sink);
+            const std::uint32_t site = HostLogger::RegisterSite(LogLevel::Info, "[Bench] value={} speed={} seq={}", 0);
+            auto                record = [&](std::uint64_t i) {
+                const LogArg args[] = {i, 3.14f * static_cast<float>(i), i};
+                log.Log(site, args, 3);
+            };
+            auto burst = [&] {
+                for (std::uint64_t i = 0; i < kRecords; ++i)
+                    record(i);
+            };
+            for (int warm = 0; warm < 2; ++warm) { // creates this thread's ring and faults it in
+                burst();
+                log.Flush();
+            }
+            r.RunOnce("log.async", "args=3", kRecords, burst);
+            log.Flush();
+
+            const std::uint32_t limited = HostLogger::RegisterSite(LogLevel::Info, "[Bench] limited {}", 1);
+            r.Run("log.rate_limited", "max=1/s", 0, [&](std::uint64_t n) {
+                for (std::uint64_t i = 0; i < n; ++i) {
+                    const LogArg args[] = {i};
+                    log.Log(limited, args, 1);
+                }
+            });
+        }
+        std::fclose(sink);
+    }
+
+    // log.fallback: one PLUGIN_LOG site, first through a host, then without
+    // one; the second call must still print, synchronously to stderr
+    void LogThrough(IHostServices *svc, int call) {
+        PLUGIN_LOG(svc, LogLevel::Warn, 0, "[PortBench] log.fallback call {} (expected)", call);
+    }
+
+    void CheckLogFallback(Runner &r) {
+        if (!r.Enabled("log.fallback"))
+            return;
+        PortManager pm;
+        LogThrough(&pm, 1);
+
+        // fd 2 into a temporary file around the call without a host
+        std::FILE *capture = std::tmpfile();
+        if (!r.Check("log.fallback", capture != nullptr, "no temporary file"))
+            return;
+        std::fflush(stderr);
+        const int saved = ::dup(2);
+        ::dup2(::fileno(capture), 2);
+        LogThrough(nullptr, 2); // the site id is cached by now
+        std::fflush(stderr);
+        ::dup2(saved, 2);
+        ::close(saved);
+
+        std::string text(4096, '\0');
+        std::rewind(capture);
+        text.resize(std::fread(text.data(), 1, text.size(), capture));
+        std::fclose(capture);
+        r.Check("log.fallback", text.find("log.fallback call 2") != std::string::npos,
+            "nothing written without a host, got '" + text + "'");
+    }
+
+    void PrintUsage() {
+        std::cout << "Usage: PortBench [--filter <substring>] [--quick] [--out <results.jsonl>]\n";
+    }
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options       opt;
+    std::ofstream outFile;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc) {
+            opt.filter = argv[++i];
+        } else if (arg == "--quick") {
+            opt.quick = true;
+        } else if (arg == "--out" && i + 1 < argc) {
+            outFile.open(argv[++i], std::ios::out | std::ios::app);
+            if (!outFile) {
+                std::cerr << "[PortBench] Failed to open " << argv[i] << "\n";
+                return 1;
+            }
+            opt.out = &outFile;
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    Runner r(opt);
+    BenchTypedPort<DataAccessPolicy::Direct>(r, "direct");
+    BenchTypedPort<DataAccessPolicy::Buffered>(r, "buffered");
+    BenchBatchPort<DataAccessPolicy::Direct>(r, "direct");
+    BenchBatchPort<DataAccessPolicy::Buffered>(r, "buffered");
+    BenchPerRecordPort(r);
+    BenchHistoryPort(r);
+    BenchResourcePort(r, opt.quick);
+    BenchFabric(r);
+    CheckMetrics(r);
+    CheckPolicies(r);
+    CheckRewiring(r);
+    BenchGraph(r, opt.quick);
+    CheckOptimizer(r);
+    BenchProject(r, opt.quick);
+    CheckProjectRoundTrip(r);
+    BenchCycle(r);
+    CheckReplay(r);
+    CheckRestore(r);
+    CheckIsolation(r);
+    CheckVirtualClock(r);
+    BenchMemory(r);
+    CheckMemory(r);
+    BenchLog(r);
+    CheckLogFallback(r);
+
+    if (r.Count() == 0) {
+        std::cerr << "[PortBench] No benchmark matches filter '" << opt.filter << "'\n";
+        return 1;
+    }
+    return r.Failures() ? 1 : 0;
+}
@@ -0,0 +1,176 @@
+// PortTop: live view of a host's StatsPage ("top" for the plugin graph).
+// Maps the page read-only and never talks to the host process.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "MappedFile.hpp"
+#include "StatsPage.hpp"
+
+using namespace StatsPage;
+
+namespace {
+    struct Options {
+            std::filesystem::path     file     = PathFor("host");
+            std::chrono::milliseconds interval = std::chrono::milliseconds(1000);
+            std::size_t               top      = 20;
+            bool                      once     = false;
+    };
+
+    // Typed view over one consistent copy of the page
+    struct View {
+            std::vector<std::uint8_t> bytes;
+
+            const Header &header() const {
+                return *reinterpret_cast<const Header *>(bytes.data());
+            }
+            const AddonRow *addons() const {
+                return reinterpret_cast<const AddonRow *>(bytes.data() + header().addonOffset);
+            }
+            const PortRow *ports() const {
+                return reinterpret_cast<const PortRow *>(bytes.data() + header().portOffset);
+            }
+            const ConnRow *conns() const {
+                return reinterpret_cast<const ConnRow *>(bytes.data() + header().connOffset);
+            }
+    };
+
+    bool Sample(const std::filesystem::path &file, View &out) {
+        MappedFile page;
+        if (!page.open(file, MappedFile::Mode::ReadOnly) || !page.data())
+            return false;
+        return ReadSnapshot(page.data(), page.size(), out.bytes);
+    }
+
+    double PerSec(std::uint64_t now, std::uint64_t before, double seconds) {
+        return seconds > 0 && now >= before ? static_cast<double>(now - before) / seconds : 0.0;
+    }
+
+    // Row indices sorted by `key` descending, at most n
+    template<class Key>
+    std::vector<std::uint32_t> TopRows(std::uint32_t count, std::size_t n, Key key) {
+        std::vector<std::uint32_t> idx(count);
+        for (std::uint32_t i = 0; i < count; ++i)
+            idx[i] = i;
+        const std::size_t keep = std::min<std::size_t>(n, idx.size());
+        std::partial_sort(idx.begin(), idx.begin() + static_cast<std::ptrdiff_t>(keep), idx.end(),
+            [&](std::uint32_t a, std::uint32_t b) { return key(a) > key(b); });
+        idx.resize(keep);
+        return idx;
+    }
+
+    void Render(const View &prev, const View &cur, const Options &opt, bool clear) {
+        const Header &h  = cur.header();
+        const Header &p  = prev.header();
+        const double  dt = static_cast<double>(h.publishNs - p.publishNs) / 1e9;
+
+        if (clear)
+            std::printf("\x1b[H\x1b[2J");
+        std::printf("PortTop  pid %llu  cycle %llu  %.0f cycles/s  %u addons  %u ports  %u links%s\n\n",
+            static_cast<unsigned long long>(h.pid), static_cast<unsigned long long>(h.cycle),
+            PerSec(h.cycle, p.cycle, dt), h.addonCount, h.portCount, h.connCount,
+            h.closed ? "  [host stopped]" : "");
+
+        // Addons by share of wall time spent in run()
+        const auto *a0 = prev.addons();
+        const auto *a1 = cur.addons();
+        std::printf("%-32s %10s %10s %10s %10s %7s %10s\n", "ADDON", "runs/s", "avg ns", "p99 ns", "max ns", "cpu%",
+            "mem KiB");
+        for (auto i : TopRows(h.addonCount, opt.top, [&](std::uint32_t r) { return a1[r].runNs - a0[r].runNs; })) {
+            const auto runs = a1[i].runs - a0[i].runs;
+            const auto ns   = a1[i].runNs - a0[i].runNs;
+            std::printf("%-32.32s %10.0f %10llu %10llu %10llu %6.1f%% %10llu\n", a1[i].name,
+                PerSec(a1[i].runs, a0[i].runs, dt),
+                static_cast<unsigned long long>(runs ? ns / runs : 0),
+                static_cast<unsigned long long>(a1[i].runNsP99),
+                static_cast<unsigned long long>(a1[i].runNsMax),
+                dt > 0 ? 100.0 * static_cast<double>(ns) / (dt * 1e9) : 0.0,
+                static_cast<unsigned long long>(a1[i].memLive >> 10));
+        }
+
+        // Ports by bandwidth
+        const auto *p0 = prev.ports();
+        const auto *p1 = cur.ports();
+        std::printf("\n%-40s %10s %10s %12s %12s\n", "PORT", "writes/s", "reads/s", "in MB/s", "out MB/s");
+        for (auto i : TopRows(h.portCount, opt.top, [&](std::uint32_t r) {
+                 return (p1[r].bytesIn - p0[r].bytesIn) + (p1[r].bytesOut - p0[r].bytesOut);
+             })) {
+            std::printf("%-40.40s %10.0f %10.0f %12.2f %12.2f\n", p1[i].name,
+                PerSec(p1[i].writes, p0[i].writes, dt), PerSec(p1[i].reads, p0[i].reads, dt),
+                PerSec(p1[i].bytesIn, p0[i].bytesIn, dt) / 1e6, PerSec(p1[i].bytesOut, p0[i].bytesOut, dt) / 1e6);
+        }
+
+        // Connections: lossy ones first, then the busiest
+        const auto *c0 = prev.conns();
+        const auto *c1 = cur.conns();
+        std::printf("\n%-56s %10s %9s %9s %6s %10s\n", "LINK", "writes/s", "drops/s", "skip/s", "depth", "p99 ns");
+        for (auto i : TopRows(h.connCount, opt.top, [&](std::uint32_t r) {
+                 const auto drops = (c1[r].drops - c0[r].drops) + (c1[r].skipped - c0[r].skipped);
+                 return (drops << 20) + (c1[r].writes - c0[r].writes);
+             })) {
+            std::printf("%-56.56s %10.0f %9.0f %9.0f %6llu %10llu\n", c1[i].name,
+                PerSec(c1[i].writes, c0[i].writes, dt), PerSec(c1[i].drops, c0[i].drops, dt),
+                PerSec(c1[i].skipped, c0[i].skipped, dt),
+                static_cast<unsigned long long>(c1[i].depth),
+                static_cast<unsigned long long>(c1[i].latencyP99Ns));
+        }
+        std::fflush(stdout);
+    }
+
+    void PrintUsage() {
+        std::cout << "Usage: PortTop [<name> | --file <page>] [--interval <ms>] [--top <n>] [--once]\n"
+                  << "  <name> matches HostApp --stats <name> (default: host)\n";
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--file" && i + 1 < argc) {
+            opt.file = argv[++i];
+        } else if (arg == "--interval" && i + 1 < argc) {
+            opt.interval = std::chrono::milliseconds(std::stoi(argv[++i]));
+        } else if (arg == "--top" && i + 1 < argc) {
+            opt.top = static_cast<std::size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--once") {
+            opt.once = true;
+        } else if (!arg.empty() && arg[0] != '-') {
+            opt.file = PathFor(arg);
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    View prev;
+    while (!Sample(opt.file, prev)) {
+        if (opt.once) {
+            std::cerr << "[PortTop] No stats page at " << opt.file.string() << "\n";
+            return 1;
+        }
+        std::cerr << "[PortTop] Waiting for " << opt.file.string() << " ...\n";
+        std::this_thread::sleep_for(opt.interval);
+    }
+
+    for (;;) {
+        std::this_thread::sleep_for(opt.interval);
+        View cur;
+        if (!Sample(opt.file, cur))
+            continue;
+
+        // Host restarted with another graph: start over from the new page
+        if (cur.header().pid != prev.header().pid || cur.header().totalBytes != prev.header().totalBytes) {
+            prev = std::move(cur);
+            continue;
+        }
+
+        Render(prev, cur, opt, !opt.once);
+        if (opt.once || cur.header().closed)
+            return 0;
+        prev = std::move(cur);
+    }
+}
@@ -0,0 +1,276 @@
+#include "SynthAddon.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+using namespace PluginAPI;
+
+SynthAddon::SynthAddon(const SynthConfig &cfg)
+    : cfg_(cfg) {
+    cfg_.payloadBytes = std::max<std::uint32_t>(cfg_.payloadBytes, 1);
+    cfg_.emitEvery    = std::max<std::uint32_t>(cfg_.emitEvery, 1);
+    if (cfg_.role == SynthConfig::Role::Producer)
+        cfg_.inputs = 0;
+    if (cfg_.role == SynthConfig::Role::Sink)
+        cfg_.outputs = 0;
+
+    auto make = [&](const std::string &name, PortDirection dir) {
+        Port p;
+        p.desc = PortDescriptor{name, dir, PortType::InternalMemory, cfg_.policy,
+            cfg_.payloadBytes, SynthPayloadHash(cfg_.payloadBytes)};
+        return p;
+    };
+    for (std::uint32_t i = 0; i < cfg_.inputs; ++i)
+        inputs_.push_back(make("in" + std::to_string(i), PortDirection::Input));
+    for (std::uint32_t i = 0; i < cfg_.outputs; ++i)
+        outputs_.push_back(make("out" + std::to_string(i), PortDirection::Output));
+
+    for (const auto &p : inputs_)
+        joinNames_.push_back(p.desc.Name.c_str());
+}
+
+SynthAddon::~SynthAddon() {
+    FreeBuffers();
+}
+
+void SynthAddon::FreeBuffers() {
+    if (scratch_)
+        memory_->deallocate(scratch_, cfg_.payloadBytes);
+    if (batch_)
+        memory_->deallocate(batch_, batchFrames_ * cfg_.payloadBytes);
+    scratch_     = nullptr;
+    batch_       = nullptr;
+    batchFrames_ = 0;
+}
+
+std::vector<PortDescriptor> SynthAddon::getPortDescriptors() const {
+    std::vector<PortDescriptor> out;
+    out.reserve(inputs_.size() + outputs_.size());
+    for (const auto &p : inputs_)
+        out.push_back(p.desc);
+    for (const auto &p : outputs_)
+        out.push_back(p.desc);
+    return out;
+}
+
+void SynthAddon::initialize(IHostServices *svc) {
+    svc_ = svc;
+
+    // Scratch comes from the host's per-addon resource, so it is accounted to us
+    FreeBuffers();
+    memory_  = svc ? svc->Memory() : std::pmr::get_default_resource();
+    scratch_ = static_cast<std::uint8_t *>(memory_->allocate(cfg_.payloadBytes));
+    for (std::size_t i = 0; i < cfg_.payloadBytes; ++i)
+        scratch_[i] = static_cast<std::uint8_t>(i * 131u);
+    for (auto *ports : {&inputs_, &outputs_}) {
+        for (auto &p : *ports) {
+            p.handle = svc ? svc->OpenPort(p.desc.Name.c_str()) : PortHandle{};
+            p.direct = cfg_.policy == DataAccessPolicy::Direct ? p.handle.impl : nullptr;
+            p.fast   = p.direct ? nullptr : FastPathOf(svc, p.handle);
+        }
+    }
+}
+
+void SynthAddon::run() {
+    ++tick_;
+    if (tick_ == cfg_.abortAtTick)
+        std::abort(); // see SynthConfig::abortAtTick (isolation tests)
+    ConsumeInputs();
+    Spin(cfg_.workIterations);
+    if (tick_ % cfg_.emitEvery == 0)
+        PublishOutputs();
+}
+
+PluginAPI::JoinSpec SynthAddon::getJoinSpec() const {
+    if (!cfg_.join || joinNames_.empty())
+        return {};
+    return JoinSpec{joinNames_.data(), joinNames_.size(), cfg_.joinPolicy, cfg_.joinToleranceNs};
+}
+
+// Up to this much work per tick (well under a microsecond) an instance may
+// share a scheduling unit with its neighbours
+constexpr std::uint32_t kLightWork = 1000;
+
+PluginAPI::ExecutionHints SynthAddon::getExecutionHints() const {
+    return ExecutionHints{ThreadingModel::CycleThread, cfg_.workIterations <= kLightWork};
+}
+
+// Host-aligned inputs: fold the views in place, no copy into scratch_
+void SynthAddon::runJoined(const JoinView *views, std::size_t count) {
+    ++tick_;
+    if (tick_ == cfg_.abortAtTick)
+        std::abort();
+    for (std::size_t i = 0; i < count; ++i) {
+        if (views[i].bytes < cfg_.payloadBytes)
+            continue;
+        ++received_;
+        Fold(views[i].data);
+    }
+    Spin(cfg_.workIterations);
+    if (tick_ % cfg_.emitEvery == 0)
+        PublishOutputs();
+}
+
+// Copy every new input into scratch_ and fold it into the checksum, so the
+// whole payload really crosses the memory hierarchy.
+void SynthAddon::ConsumeInputs() {
+    for (auto &in : inputs_) {
+        // Unchanged since the last tick: nothing to copy or fold
+        const std::uint64_t *seq = in.direct ? &DirectHeaderOf(in.direct)->sequence
+                                   : in.fast ? in.fast->version
+                                             : nullptr;
+        if (seq) {
+            const std::uint64_t v = LoadSequence(seq);
+            if (v == in.seen)
+                continue;
+            in.seen = v;
+        }
+
+        bool got = false;
+        if (in.direct) {
+            std::memcpy(scratch_, in.direct, cfg_.payloadBytes);
+            got = true;
+        } else if (in.fast) {
+            got = in.fast->ops->read(in.fast->ctx, scratch_, cfg_.payloadBytes);
+        } else if (svc_ && in.handle.impl) {
+            std::size_t n = 0;
+            got           = svc_->Read(in.handle, scratch_, cfg_.payloadBytes, n) && n == cfg_.payloadBytes;
+        }
+        if (!got)
+            continue;
+
+        ++received_;
+        Fold(scratch_);
+    }
+}
+
+// Checksum over whole 64-bit words (a partial last word is zero-padded)
+void SynthAddon::Fold(const void *payload) {
+    const auto   *bytes = static_cast<const std::uint8_t *>(payload);
+    std::uint64_t word  = 0;
+    for (std::size_t off = 0; off < cfg_.payloadBytes; off += sizeof(word)) {
+        word = 0;
+        std::memcpy(&word, bytes + off, std::min<std::size_t>(sizeof(word), cfg_.payloadBytes - off));
+        checksum_ = (checksum_ ^ word) * 1099511628211ULL;
+    }
+}
+
+// Fixed CPU cost per tick (LCG steps the compiler cannot fold away)
+void SynthAddon::Spin(std::uint32_t iterations) {
+    std::uint64_t x = checksum_ | 1;
+    for (std::uint32_t i = 0; i < iterations; ++i) {
+        x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+#if defined(__GNUC__) || defined(__clang__)
+        __asm__ volatile("" : "+r"(x));
+#endif
+    }
+    checksum_ ^= x;
+}
+
+// Offline batch (PortReplayer --batch): fold every queued input frame, run
+// `frames` ticks of work, then hand each output all of its frames at once
+bool SynthAddon::runBatch(std::size_t frames) {
+    if (!svc_ || cfg_.policy != DataAccessPolicy::Buffered)
+        return false; // a Direct port holds one value: run() per cycle is the same
+    const std::size_t bytes = cfg_.payloadBytes;
+    if (frames > batchFrames_) {
+        if (batch_)
+            memory_->deallocate(batch_, batchFrames_ * bytes);
+        batch_       = nullptr;
+        batchFrames_ = 0;
+        batch_       = static_cast<std::uint8_t *>(memory_->allocate(frames * bytes));
+        batchFrames_ = frames;
+    }
+
+    for (auto &in : inputs_) {
+        if (!in.handle.impl)
+            continue;
+        const std::size_t got = svc_->ReadBatch(in.handle, batch_, bytes, frames);
+        for (std::size_t k = 0; k < got; ++k)
+            Fold(batch_ + k * bytes);
+        if (got) // what run() would have left in scratch_
+            std::memcpy(scratch_, batch_ + (got - 1) * bytes, bytes);
+        received_ += got;
+    }
+
+    std::size_t emitted = 0;
+    for (std::size_t k = 0; k < frames; ++k) {
+        ++tick_;
+        if (tick_ == cfg_.abortAtTick)
+            std::abort();
+        Spin(cfg_.workIterations);
+        if (tick_ % cfg_.emitEvery == 0) {
+            std::uint8_t *frame = batch_ + emitted++ * bytes;
+            std::memcpy(frame, scratch_, bytes);
+            Stamp(frame);
+        }
+    }
+    if (emitted)
+        std::memcpy(scratch_, batch_ + (emitted - 1) * bytes, bytes);
+    for (auto &out : outputs_) {
+        if (out.handle.impl)
+            svc_->WriteBatch(out.handle, batch_, bytes, emitted);
+    }
+    return true;
+}
+
+// Tick + checksum into the head of the payload
+void SynthAddon::Stamp(std::uint8_t *payload) const {
+    std::memcpy(payload, &tick_, std::min<std::size_t>(sizeof(tick_), cfg_.payloadBytes));
+    if (cfg_.payloadBytes >= 2 * sizeof(checksum_))
+        std::memcpy(payload + sizeof(tick_), &checksum_, sizeof(checksum_));
+}
+
+void SynthAddon::PublishOutputs() {
+    Stamp(scratch_);
+
+    for (auto &out : outputs_) {
+        if (out.direct) {
+            std::memcpy(out.direct, scratch_, cfg_.payloadBytes);
+            StampDirectWrite(out.direct);
+        } else if (out.fast) {
+            out.fast->ops->write(out.fast->ctx, scratch_, cfg_.payloadBytes);
+        } else if (svc_ && out.handle.impl) {
+            std::size_t n = 0;
+            svc_->Write(out.handle, scratch_, cfg_.payloadBytes, n);
+        }
+    }
+}
+
+void SynthAddon::shutdown() {
+    // Only sinks report, a generated graph has hundreds of instances
+    if (cfg_.role == SynthConfig::Role::Sink && tick_ > 0 && received_ == 0)
+        std::cerr << "[SynthAddon] Sink received nothing in " << tick_ << " ticks\n";
+}
+
+std::size_t SynthAddon::saveState(void *dst, std::size_t capacity) const {
+    if (dst && capacity >= sizeof(tick_))
+        std::memcpy(dst, &tick_, sizeof(tick_));
+    return sizeof(tick_);
+}
+
+bool SynthAddon::restoreState(const void *src, std::size_t bytes) {
+    if (bytes != sizeof(tick_))
+        return false;
+    std::memcpy(&tick_, src, sizeof(tick_));
+    return true;
+}
+
+#ifdef _WIN32
+#define SYNTH_EXPORT extern "C" __declspec(dllexport)
+#else
+#define SYNTH_EXPORT extern "C" __attribute__((visibility("default")))
+#endif
+
+// Default instance (one 64-byte Buffered output) for plain CreatePlugin() loaders
+SYNTH_EXPORT PluginAPI::IPlugin *CreatePlugin() {
+    return new SynthAddon(SynthConfig{});
+}
+// `config` points to a SynthConfig
+SYNTH_EXPORT PluginAPI::IPlugin *CreateSynthPlugin(const void *config) {
+    return config ? new SynthAddon(*static_cast<const SynthConfig *>(config)) : nullptr;
+}
+SYNTH_EXPORT void DestroyPlugin(PluginAPI::IPlugin *p) {
+    delete p;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <memory_resource>
+#include <string>
+#include <vector>
+#include "../include/PluginAPI.hpp"
+#include "../include/SynthConfig.hpp"
+
+// Synthetic producer/filter/sink whose ports are described at runtime from a
+// SynthConfig, so one library can stand in for hundreds of real addons.
+class SynthAddon: public PluginAPI::IPlugin {
+    public:
+        explicit SynthAddon(const SynthConfig &cfg);
+        ~SynthAddon() override;
+
+        SynthAddon(const SynthAddon &)            = delete;
+        SynthAddon &operator=(const SynthAddon &) = delete;
+
+        std::vector<PluginAPI::PortDescriptor> getPortDescriptors() const override;
+        void                                   initialize(PluginAPI::IHostServices *svc) override;
+        void                                   run() override;
+        PluginAPI::JoinSpec                    getJoinSpec() const override;
+        void                                   runJoined(const PluginAPI::JoinView *views, std::size_t count) override;
+        bool                                   runBatch(std::size_t frames) override;
+        PluginAPI::ExecutionHints              getExecutionHints() const override;
+        void                                   shutdown() override;
+        std::size_t                            saveState(void *dst, std::size_t capacity) const override;
+        bool                                   restoreState(const void *src, std::size_t bytes) override;
+
+    private:
+        struct Port {
+                PluginAPI::PortDescriptor      desc;
+                PluginAPI::PortHandle          handle{};
+                void                          *direct = nullptr; // Direct transport, if connected
+                const PluginAPI::PortFastPath *fast   = nullptr; // Buffered ops, if the host has them
+                std::uint64_t                  seen   = 0;       // input version last consumed
+        };
+
+        void ConsumeInputs();
+        void Fold(const void *payload);
+        void Spin(std::uint32_t iterations);
+        void PublishOutputs();
+        void Stamp(std::uint8_t *payload) const;
+        void FreeBuffers();
+
+        SynthConfig                cfg_;
+        std::vector<Port>          inputs_;
+        std::vector<Port>          outputs_;
+        std::vector<const char *>  joinNames_;             // input names, for getJoinSpec()
+        std::pmr::memory_resource *memory_      = nullptr; // IHostServices::Memory()
+        std::uint8_t              *scratch_     = nullptr; // payloadBytes, from memory_
+        std::uint8_t              *batch_       = nullptr; // batchFrames_ payloads, runBatch()
+        std::size_t                batchFrames_ = 0;
+        PluginAPI::IHostServices  *svc_         = nullptr;
+        std::uint64_t              tick_        = 0;
+        std::uint64_t              checksum_    = 0;
+        std::uint64_t              received_    = 0;
+};
@@ -0,0 +1,212 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include "PluginAPI.hpp"
+
+namespace PluginAPI {
+
+    // ================================================================
+    // SoABatch<N, Fields...> - columnar payload of up to N records
+    // ================================================================
+    // One 64-byte line with the record count, then one 64-byte aligned column
+    // per field. The offsets are computed here (not left to std::tuple), so
+    // every compiler agrees on the layout, and the whole thing is a plain
+    // trivially copyable payload: TypeHashOf<SoABatch<...>> covers N and the
+    // field types, and the Direct path shares it zero-copy.
+    //
+    //   using Tracks = SoABatch<10000, int, float>;  // value, speed
+    //   for (float &s : batch.field<1>()) s *= 0.5f;
+    template<std::size_t N, class... Fields>
+    struct alignas(64) SoABatch {
+            static_assert(sizeof...(Fields) > 0, "SoABatch needs at least one field");
+            static_assert((std::is_trivially_copyable_v<Fields> && ...), "SoABatch fields must be trivially copyable");
+            static_assert(((alignof(Fields) <= 64) && ...), "SoABatch fields must not need more than 64-byte alignment");
+
+            static constexpr std::size_t kAlign    = 64;
+            static constexpr std::size_t kCapacity = N;
+            static constexpr std::size_t kColumns  = sizeof...(Fields);
+
+            template<std::size_t I>
+            using FieldT = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+            static constexpr std::size_t RoundUp(std::size_t v) {
+                return (v + kAlign - 1) / kAlign * kAlign;
+            }
+
+            // Byte offset of every column inside `columns`
+            static constexpr std::array<std::size_t, kColumns> kOffsets = [] {
+                std::array<std::size_t, kColumns>           out{};
+                constexpr std::array<std::size_t, kColumns> sizes{sizeof(Fields)...};
+                std::size_t                                 at = 0;
+                for (std::size_t i = 0; i < kColumns; ++i) {
+                    out[i] = at;
+                    at += RoundUp(sizes[i] * N);
+                }
+                return out;
+            }();
+            static constexpr std::size_t kColumnBytes = (RoundUp(sizeof(Fields) * N) + ...);
+
+            std::uint32_t count = 0; // valid records in every column
+            alignas(kAlign) std::byte columns[kColumnBytes];
+
+            // -------- Column access --------
+            template<std::size_t I>
+            FieldT<I> *column() {
+                return reinterpret_cast<FieldT<I> *>(columns + kOffsets[I]);
+            }
+            template<std::size_t I>
+            const FieldT<I> *column() const {
+                return reinterpret_cast<const FieldT<I> *>(columns + kOffsets[I]);
+            }
+            // The `count` valid values of field I
+            template<std::size_t I>
+            std::span<FieldT<I>> field() {
+                return {column<I>(), count};
+            }
+            template<std::size_t I>
+            std::span<const FieldT<I>> field() const {
+                return {column<I>(), count};
+            }
+
+            // -------- Row helpers --------
+            std::size_t size() const {
+                return count;
+            }
+            static constexpr std::size_t capacity() {
+                return N;
+            }
+            void clear() {
+                count = 0;
+            }
+            bool push(const Fields &...values) {
+                if (count >= N)
+                    return false;
+                PushAt(std::index_sequence_for<Fields...>{}, values...);
+                ++count;
+                return true;
+            }
+
+        private:
+            template<std::size_t... I>
+            void PushAt(std::index_sequence<I...>, const Fields &...values) {
+                ((column<I>()[count] = values), ...);
+            }
+    };
+
+    // ================================================================
+    // AddOnBatchPort<Batch, …> - port carrying one SoABatch per write
+    // ================================================================
+    // Same descriptor/Bind surface as AddOnPort (usable in a PortSet). Direct
+    // ports hand out the shared block itself: producers fill it in place and
+    // publish(), consumers get a const view with no copy. Buffered ports work
+    // on a port-owned, aligned batch that is copied (at full capacity)
+    // through the host.
+    template<
+        class Batch,
+        fixed_string     Name,
+        PortDirection    Direction,
+        PortType         Type,
+        DataAccessPolicy AccessPolicy>
+    class AddOnBatchPort {
+        public:
+            using Port = AddOnPort<Batch, Name, Direction, Type, AccessPolicy>;
+            using T    = Batch;
+
+            static constexpr auto                 name         = Name;
+            static constexpr auto                 direction    = Direction;
+            static constexpr auto                 type         = Type;
+            static constexpr auto                 accessPolicy = AccessPolicy;
+            static constexpr StaticPortDescriptor descriptor   = Port::descriptor;
+
+            operator PortDescriptor() const {
+                return descriptor;
+            }
+
+            void Bind(IHostServices *svc) {
+                port_.Bind(svc);
+                if constexpr (accessPolicy == DataAccessPolicy::Buffered) {
+                    if (!local_)
+                        local_ = std::make_unique<Batch>();
+                }
+            }
+
+            // -------- Output --------
+            // Batch to fill for the next publish(); null if unbound/unconnected
+            Batch *batch()
+                requires(Direction == PortDirection::Output)
+            {
+                if constexpr (accessPolicy == DataAccessPolicy::Direct)
+                    return port_.direct();
+                else
+                    return local_.get();
+            }
+
+            bool publish()
+                requires(Direction == PortDirection::Output)
+            {
+                if constexpr (accessPolicy == DataAccessPolicy::Direct) {
+                    if (!port_.direct())
+                        return false;
+                    StampDirectWrite(port_.direct());
+                    return true;
+                } else {
+                    return local_ && port_.write(*local_);
+                }
+            }
+
+            // -------- Input --------
+            // Latest batch, or null if nothing is available
+            const Batch *read()
+                requires(Direction == PortDirection::Input)
+            {
+                if constexpr (accessPolicy == DataAccessPolicy::Direct) {
+                    return port_.direct();
+                } else {
+                    return local_ && port_.read(*local_) ? local_.get() : nullptr;
+                }
+            }
+
+            // Same, plus sequence/age of the batch
+            const Batch *read(MessageInfo &info)
+                requires(Direction == PortDirection::Input)
+            {
+                if constexpr (accessPolicy == DataAccessPolicy::Direct) {
+                    port_.messageInfo(info);
+                    return port_.direct();
+                } else {
+                    return local_ && port_.read(*local_, info) ? local_.get() : nullptr;
+                }
+            }
+
+            // A batch newer than the last readIfNew() arrived
+            bool changed() const
+                requires(Direction == PortDirection::Input)
+            {
+                return port_.version() > lastSeq_;
+            }
+
+            // Like read(), but null unless changed(); Direct costs one atomic load
+            const Batch *readIfNew()
+                requires(Direction == PortDirection::Input)
+            {
+                const std::uint64_t v = port_.version();
+                if (v <= lastSeq_)
+                    return nullptr;
+                const Batch *b = read();
+                if (b)
+                    lastSeq_ = v;
+                return b;
+            }
+
+        private:
+            Port                   port_{};
+            std::unique_ptr<Batch> local_;       // Buffered only
+            std::uint64_t          lastSeq_ = 0; // version at the last readIfNew()
+    };
+
+} // namespace PluginAPI
@@ -0,0 +1,324 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include "PluginAPI.hpp"
+
+namespace PluginAPI {
+
+    // ================================================================
+    // HistoryRing<T, N> - timestamped samples, last N writes
+    // ================================================================
+    // Single writer, any number of readers, no locks. Samples are addressed
+    // by a logical index (0 = first sample ever written); sample i lives in
+    // slot i % N. `head` counts the samples written and is published last
+    // (release), so a reader that sees head == H also sees samples < H.
+    // Timestamps and values are separate columns so the O(log n) search only
+    // touches the timestamps.
+    //
+    // While the writer stores sample H it overwrites sample H - N, so
+    // readers only ever use the newest N - 1 samples. A view taken at head H
+    // stays intact while the writer has not started sample H + 1 (see
+    // intact()); hosts that run addons one after another never break it.
+    template<class T>
+    struct HistorySample {
+            std::uint64_t t     = 0;
+            const T      *value = nullptr;
+    };
+
+    // Contiguous piece of the ring, oldest sample first
+    template<class T>
+    struct HistorySpan {
+            std::span<const std::uint64_t> times;
+            std::span<const T>             values;
+    };
+
+    // Chronological run of samples; `second` is empty unless it wraps
+    template<class T>
+    struct HistoryView {
+            HistorySpan<T> first;
+            HistorySpan<T> second;
+            std::uint64_t  index = 0; // logical index of the oldest sample
+
+            std::size_t size() const {
+                return first.times.size() + second.times.size();
+            }
+            bool empty() const {
+                return size() == 0;
+            }
+    };
+
+    template<class T, std::size_t N>
+    struct alignas(64) HistoryRing {
+            static_assert(N >= 2 && (N & (N - 1)) == 0, "HistoryRing capacity must be a power of two >= 2");
+            static_assert(std::is_trivially_copyable_v<T>, "HistoryRing samples must be trivially copyable");
+            static_assert(alignof(T) <= 64, "HistoryRing samples must not need more than 64-byte alignment");
+
+            static constexpr std::size_t   kCapacity = N;
+            static constexpr std::uint64_t kMask     = N - 1;
+
+            std::uint64_t head = 0; // samples ever written
+            alignas(64) std::uint64_t stamps[N];
+            alignas(64) T values[N];
+
+            // -------- Writer --------
+            // Timestamps must not go backwards (the search relies on it)
+            bool push(std::uint64_t t, const T &v) {
+                const std::uint64_t h = head; // single writer: plain load
+                if (h && t < stamps[(h - 1) & kMask])
+                    return false;
+                stamps[h & kMask] = t;
+                values[h & kMask] = v;
+                std::atomic_ref<std::uint64_t>(head).store(h + 1, std::memory_order_release);
+                return true;
+            }
+
+            // -------- Reader --------
+            std::uint64_t published() const {
+                return std::atomic_ref<std::uint64_t>(const_cast<std::uint64_t &>(head)).load(std::memory_order_acquire);
+            }
+
+            // False once the writer may have started overwriting `v`
+            bool intact(const HistoryView<T> &v) const {
+                return v.empty() || v.index + N > published();
+            }
+
+            // Every readable sample
+            HistoryView<T> all() const {
+                std::uint64_t lo = 0, hi = 0;
+                Window(lo, hi);
+                return View(lo, hi);
+            }
+
+            // The newest `n` samples (fewer if the ring holds fewer)
+            HistoryView<T> latest(std::size_t n) const {
+                std::uint64_t lo = 0, hi = 0;
+                Window(lo, hi);
+                if (hi - lo > n)
+                    lo = hi - n;
+                return View(lo, hi);
+            }
+
+            // Samples with t0 <= t <= t1
+            HistoryView<T> range(std::uint64_t t0, std::uint64_t t1) const {
+                std::uint64_t lo = 0, hi = 0;
+                Window(lo, hi);
+                if (t1 < t0)
+                    return View(hi, hi);
+                const std::uint64_t a = LowerBound(lo, hi, t0);
+                const std::uint64_t b = UpperBound(a, hi, t1);
+                return View(a, b);
+            }
+
+            // Sample closest to t (ties go to the older one)
+            bool nearest(std::uint64_t t, HistorySample<T> &out) const {
+                HistorySample<T> before, after;
+                const int        found = Bracket(t, before, after);
+                if (found == 0)
+                    return false;
+                if (!before.value)
+                    out = after;
+                else if (!after.value)
+                    out = before;
+                else
+                    out = (t - before.t <= after.t - t) ? before : after;
+                return true;
+            }
+
+            // Newest sample at or before t and oldest at or after t; false
+            // unless t lies inside the stored history (both exist)
+            bool bracket(std::uint64_t t, HistorySample<T> &before, HistorySample<T> &after) const {
+                return Bracket(t, before, after) == 2;
+            }
+
+            // Value at t, linear between the bracketing samples. `lerp(a, b,
+            // alpha)` defaults to a + (b - a) * alpha for arithmetic types.
+            template<class Lerp>
+            bool interpolate(std::uint64_t t, T &out, Lerp lerp) const {
+                HistorySample<T> before, after;
+                if (!bracket(t, before, after))
+                    return false;
+                const double alpha = after.t == before.t
+                                         ? 0.0
+                                         : static_cast<double>(t - before.t) / static_cast<double>(after.t - before.t);
+                out = lerp(*before.value, *after.value, alpha);
+                return true;
+            }
+            bool interpolate(std::uint64_t t, T &out) const
+                requires std::is_arithmetic_v<T>
+            {
+                return interpolate(t, out, [](T a, T b, double alpha) {
+                    return static_cast<T>(a + (b - a) * alpha);
+                });
+            }
+
+        private:
+            std::uint64_t StampAt(std::uint64_t i) const {
+                return stamps[i & kMask];
+            }
+
+            // Readable logical indices [lo, hi)
+            void Window(std::uint64_t &lo, std::uint64_t &hi) const {
+                hi = published();
+                lo = hi > N - 1 ? hi - (N - 1) : 0;
+            }
+
+            // First index in [lo, hi) with stamp >= t
+            std::uint64_t LowerBound(std::uint64_t lo, std::uint64_t hi, std::uint64_t t) const {
+                while (lo < hi) {
+                    const std::uint64_t mid = lo + (hi - lo) / 2;
+                    if (StampAt(mid) < t)
+                        lo = mid + 1;
+                    else
+                        hi = mid;
+                }
+                return lo;
+            }
+            // First index in [lo, hi) with stamp > t
+            std::uint64_t UpperBound(std::uint64_t lo, std::uint64_t hi, std::uint64_t t) const {
+                while (lo < hi) {
+                    const std::uint64_t mid = lo + (hi - lo) / 2;
+                    if (StampAt(mid) <= t)
+                        lo = mid + 1;
+                    else
+                        hi = mid;
+                }
+                return lo;
+            }
+
+            // Number of sides found (0, 1 or 2); missing sides have a null value
+            int Bracket(std::uint64_t t, HistorySample<T> &before, HistorySample<T> &after) const {
+                std::uint64_t lo = 0, hi = 0;
+                Window(lo, hi);
+                before = after = HistorySample<T>{};
+                if (lo == hi)
+                    return 0;
+
+                const std::uint64_t up = UpperBound(lo, hi, t); // first stamp > t
+                int                 n  = 0;
+                if (up > lo) {
+                    before = Sample(up - 1);
+                    ++n;
+                }
+                if (before.value && before.t == t) {
+                    after = before;
+                    ++n;
+                } else if (up < hi) {
+                    after = Sample(up);
+                    ++n;
+                }
+                return n;
+            }
+
+            HistorySample<T> Sample(std::uint64_t i) const {
+                return HistorySample<T>{StampAt(i), &values[i & kMask]};
+            }
+
+            // Logical [lo, hi) as at most two contiguous spans
+            HistoryView<T> View(std::uint64_t lo, std::uint64_t hi) const {
+                HistoryView<T>    v;
+                const std::size_t n     = static_cast<std::size_t>(hi - lo);
+                const std::size_t start = static_cast<std::size_t>(lo & kMask);
+                const std::size_t head1 = n < N - start ? n : N - start;
+                v.index                 = lo;
+                v.first                 = {{stamps + start, head1}, {values + start, head1}};
+                v.second                = {{stamps, n - head1}, {values, n - head1}};
+                return v;
+            }
+    };
+
+    // ================================================================
+    // AddOnHistoryPort<T, N, …> - port carrying a HistoryRing
+    // ================================================================
+    // The ring is an ordinary Direct payload: every reader connected to the
+    // output queries the same block, nobody keeps a private copy. TypeHash
+    // covers T and N, so Connect() rejects mismatched capacities.
+    //
+    //   AddOnHistoryPort<float, 1024, "Speed", PortDirection::Output, ...> out;
+    //   out.push(speed);                          // stamped with SteadyNowNs()
+    //   in.interpolate(t, speedAtT);              // reader side
+    template<
+        class T,
+        std::size_t   N,
+        fixed_string  Name,
+        PortDirection Direction,
+        PortType      Type>
+    class AddOnHistoryPort {
+        public:
+            using Ring = HistoryRing<T, N>;
+            using Port = AddOnPort<Ring, Name, Direction, Type, DataAccessPolicy::Direct>;
+
+            static constexpr auto                 name         = Name;
+            static constexpr auto                 direction    = Direction;
+            static constexpr auto                 type         = Type;
+            static constexpr auto                 accessPolicy = DataAccessPolicy::Direct;
+            static constexpr StaticPortDescriptor descriptor   = Port::descriptor;
+
+            operator PortDescriptor() const {
+                return descriptor;
+            }
+
+            void Bind(IHostServices *svc) {
+                port_.Bind(svc);
+            }
+
+            // Shared ring, null if unbound/unconnected
+            const Ring *history() const {
+                return port_.direct();
+            }
+
+            // -------- Output --------
+            bool push(std::uint64_t t, const T &v)
+                requires(Direction == PortDirection::Output)
+            {
+                Ring *r = port_.direct();
+                if (!r || !r->push(t, v))
+                    return false;
+                StampDirectWrite(r);
+                return true;
+            }
+            bool push(const T &v)
+                requires(Direction == PortDirection::Output)
+            {
+                return push(SteadyNowNs(), v);
+            }
+
+            // -------- Input --------
+            HistoryView<T> all() const {
+                const Ring *r = history();
+                return r ? r->all() : HistoryView<T>{};
+            }
+            HistoryView<T> latest(std::size_t n) const {
+                const Ring *r = history();
+                return r ? r->latest(n) : HistoryView<T>{};
+            }
+            HistoryView<T> range(std::uint64_t t0, std::uint64_t t1) const {
+                const Ring *r = history();
+                return r ? r->range(t0, t1) : HistoryView<T>{};
+            }
+            bool nearest(std::uint64_t t, HistorySample<T> &out) const {
+                const Ring *r = history();
+                return r && r->nearest(t, out);
+            }
+            bool bracket(std::uint64_t t, HistorySample<T> &before, HistorySample<T> &after) const {
+                const Ring *r = history();
+                return r && r->bracket(t, before, after);
+            }
+            template<class... Lerp>
+            bool interpolate(std::uint64_t t, T &out, Lerp &&...lerp) const {
+                const Ring *r = history();
+                return r && r->interpolate(t, out, std::forward<Lerp>(lerp)...);
+            }
+            bool intact(const HistoryView<T> &v) const {
+                const Ring *r = history();
+                return r && r->intact(v);
+            }
+
+        private:
+            Port port_{};
+    };
+
+} // namespace PluginAPI
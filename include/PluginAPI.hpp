@@ -1,9 +1,19 @@
 ﻿#pragma once
+#include <algorithm>
+#include <array>
 #include <string>
+#include <tuple>
 #include <vector>
+#include <atomic>
+#include <charconv>
+#include <chrono>
 #include <cstdint>
 #include <cstddef>
+#include <cstdio>
 #include <cstring>
+#include <memory_resource>
+#include <string_view>
+#include <type_traits>
 
 namespace PluginAPI {
 
@@ -19,7 +29,8 @@ namespace PluginAPI {
         SharedMemory   = 0,
         InternalMemory = 1,
         Socket         = 2,
-        Function       = 3
+        Function       = 3,
+        MappedFile     = 4 // read-only resource file (ResourcePort.hpp)
     };
 
     enum struct DataAccessPolicy : std::uint8_t {
@@ -27,6 +38,13 @@ namespace PluginAPI {
         Buffered = 1
     };
 
+    // How the host aligns the inputs of a join (see JoinSpec)
+    enum struct JoinPolicy : std::uint8_t {
+        ExactSequence   = 0, // every input new, all with the same sequence number
+        ApproximateTime = 1, // every input new, write times within toleranceNs
+        LatestOfEach    = 2  // every input written at least once, any one new
+    };
+
     inline const char *to_string(PortDirection d) {
         switch (d) {
         case PortDirection::Input: return "Input";
@@ -40,6 +58,7 @@ namespace PluginAPI {
         case PortType::InternalMemory: return "InternalMemory";
         case PortType::Socket: return "Socket";
         case PortType::Function: return "Function";
+        case PortType::MappedFile: return "MappedFile";
         default: return "Unknown";
         }
     }
@@ -50,6 +69,14 @@ namespace PluginAPI {
         default: return "Unknown";
         }
     }
+    inline const char *to_string(JoinPolicy p) {
+        switch (p) {
+        case JoinPolicy::ExactSequence: return "ExactSequence";
+        case JoinPolicy::ApproximateTime: return "ApproximateTime";
+        case JoinPolicy::LatestOfEach: return "LatestOfEach";
+        default: return "Unknown";
+        }
+    }
 
     // ================================================================
     // PORT DESCRIPTOR
@@ -65,6 +92,34 @@ namespace PluginAPI {
             std::uint64_t TypeHash    = 0;
     };
 
+    // Allocation-free form of PortDescriptor; Name points to static storage
+    // (the AddOnPort's fixed_string), so tables of these can be constexpr.
+    struct StaticPortDescriptor {
+            const char      *Name = "";
+            PortDirection    Direction{};
+            PortType         Type{};
+            DataAccessPolicy AccessPolicy{};
+            std::size_t      PayloadSize = 0;
+            std::uint64_t    TypeHash    = 0;
+
+            operator PortDescriptor() const {
+                return PortDescriptor{Name, Direction, Type, AccessPolicy, PayloadSize, TypeHash};
+            }
+    };
+
+    // View of a plugin's static descriptor array (see PortSet)
+    struct PortTable {
+            const StaticPortDescriptor *data = nullptr;
+            std::size_t                 size = 0;
+
+            constexpr const StaticPortDescriptor *begin() const {
+                return data;
+            }
+            constexpr const StaticPortDescriptor *end() const {
+                return data + size;
+            }
+    };
+
     // ================================================================
     // fixed_string for NTTP
     // ================================================================
@@ -85,28 +140,182 @@ namespace PluginAPI {
     // ================================================================
     template<class T>
     consteval std::uint64_t TypeHashOf() {
+        // constexpr FNV-1a over the compiler's signature string for T
 #if defined(__clang__) || defined(__GNUC__)
-        // Can use __builtin_crc32c safely
-        return __builtin_crc32c(
-            0,
-            (const unsigned char *)__PRETTY_FUNCTION__,
-            sizeof(__PRETTY_FUNCTION__) - 1);
+        constexpr const char *sig = __PRETTY_FUNCTION__;
 #else
-        // MSVC: no builtin CRC — use a simple constexpr FNV-1a based on __FUNCSIG__
-        constexpr const char *sig  = __FUNCSIG__;
-        std::uint64_t         hash = 1469598103934665603ULL; // FNV offset basis
+        constexpr const char *sig = __FUNCSIG__;
+#endif
+        std::uint64_t hash = 1469598103934665603ULL; // FNV offset basis
         for (size_t i = 0; sig[i] != 0; i++) {
             hash ^= (unsigned char)sig[i];
             hash *= 1099511628211ULL; // FNV prime
         }
         return hash;
-#endif
+    }
+
+    // ================================================================
+    // Message header (end-to-end latency / sequence tracking)
+    // ================================================================
+    // Hidden header carried by every transport. Buffered connections keep it
+    // on the host side; Direct blocks have it kDirectHeaderBytes in front of
+    // the payload and the writing AddOnPort stamps it.
+    struct MessageHeader {
+            std::uint64_t sequence   = 0; // number of writes, 0 = never written
+            std::uint64_t writeNs    = 0; // steady clock at the last write
+            std::uint64_t originNs   = 0; // write time at the start of the chain
+            std::uint32_t port       = 0; // host port id of the writer
+            std::uint32_t originPort = 0; // host port id where the chain started
+    };
+
+    inline constexpr std::size_t kDirectHeaderBytes = 64; // keeps payloads cache-line aligned
+
+    inline MessageHeader *DirectHeaderOf(void *payload) {
+        return reinterpret_cast<MessageHeader *>(static_cast<std::uint8_t *>(payload) - kDirectHeaderBytes);
+    }
+    inline const MessageHeader *DirectHeaderOf(const void *payload) {
+        return reinterpret_cast<const MessageHeader *>(static_cast<const std::uint8_t *>(payload) - kDirectHeaderBytes);
+    }
+
+    inline std::uint64_t SteadyNowNs() {
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch())
+                .count());
+    }
+
+    // Sequence is published last (release) so a reader that sees it also sees the data
+    inline void PublishSequence(MessageHeader &h, std::uint64_t seq) {
+        std::atomic_ref<std::uint64_t>(h.sequence).store(seq, std::memory_order_release);
+    }
+    inline std::uint64_t LoadSequence(const MessageHeader &h) {
+        return std::atomic_ref<std::uint64_t>(const_cast<std::uint64_t &>(h.sequence)).load(std::memory_order_acquire);
+    }
+    inline std::uint64_t LoadSequence(const std::uint64_t *sequence) {
+        return std::atomic_ref<std::uint64_t>(const_cast<std::uint64_t &>(*sequence)).load(std::memory_order_acquire);
+    }
+
+    // Direct writers: stamp the header after the payload store
+    inline void StampDirectWrite(void *payload) {
+        MessageHeader *h = DirectHeaderOf(payload);
+        h->writeNs       = SteadyNowNs();
+        h->originNs      = h->writeNs;
+        PublishSequence(*h, h->sequence + 1);
+    }
+
+    // What a consumer learns about the value it read
+    struct MessageInfo {
+            std::uint64_t sequence    = 0;
+            std::uint64_t ageNs       = 0; // now - last write
+            std::uint64_t originAgeNs = 0; // now - start of the chain (end-to-end)
+            std::uint64_t skipped     = 0; // sequence numbers missed since this port's last read
+            std::uint32_t originPort  = 0;
+    };
+
+    // ================================================================
+    // Logging (IHostServices::LogRecord / PLUGIN_LOG)
+    // ================================================================
+    enum struct LogLevel : std::uint8_t {
+        Debug = 0,
+        Info  = 1,
+        Warn  = 2,
+        Error = 3
+    };
+
+    inline constexpr std::size_t kMaxLogArgs   = 8;
+    inline constexpr std::size_t kMaxLogString = 256; // longer string arguments are cut
+
+    // One argument of a log record. Strings are copied by the host before
+    // LogRecord() returns; everything else is stored as its 8 raw bytes.
+    struct LogArg {
+            enum struct Type : std::uint8_t {
+                Int,
+                UInt,
+                Float,
+                Str
+            };
+
+            Type          type = Type::UInt;
+            std::uint32_t len  = 0; // Str only
+            union {
+                    std::int64_t  i;
+                    std::uint64_t u = 0;
+                    double        f;
+                    const char   *s;
+            };
+
+            LogArg() = default;
+            template<class T>
+                requires std::is_arithmetic_v<T>
+            LogArg(T v) {
+                if constexpr (std::is_floating_point_v<T>) {
+                    type = Type::Float;
+                    f    = static_cast<double>(v);
+                } else if constexpr (std::is_signed_v<T>) {
+                    type = Type::Int;
+                    i    = static_cast<std::int64_t>(v);
+                } else {
+                    type = Type::UInt;
+                    u    = static_cast<std::uint64_t>(v);
+                }
+            }
+            LogArg(std::string_view v)
+                : type(Type::Str), len(static_cast<std::uint32_t>(std::min(v.size(), kMaxLogString))) {
+                s = v.data();
+            }
+            LogArg(const char *v)
+                : LogArg(std::string_view(v ? v : "")) {}
+            LogArg(const std::string &v)
+                : LogArg(std::string_view(v)) {}
+    };
+
+    // Expands every "{}" in `format` with the next argument, like
+    // std::format without specs; numbers print like std::ostream's defaults.
+    // Used by the host's log thread and by the synchronous fallback.
+    inline void FormatLog(std::string &out, const char *format, const LogArg *args, std::size_t count) {
+        std::size_t next = 0;
+        for (const char *p = format; *p; ++p) {
+            if (p[0] != '{' || p[1] != '}' || next == count) {
+                out += *p;
+                continue;
+            }
+            const LogArg &a = args[next++];
+            char          buf[32];
+            char         *end = buf;
+            switch (a.type) {
+                case LogArg::Type::Int: end = std::to_chars(buf, buf + sizeof(buf), a.i).ptr; break;
+                case LogArg::Type::UInt: end = std::to_chars(buf, buf + sizeof(buf), a.u).ptr; break;
+                case LogArg::Type::Float:
+                    end = std::to_chars(buf, buf + sizeof(buf), a.f, std::chars_format::general, 6).ptr;
+                    break;
+                case LogArg::Type::Str: out.append(a.s, a.len); break;
+            }
+            out.append(buf, end);
+            ++p;
+        }
     }
 
     // ================================================================
     // Host→Plugin service interface
     // (Binding, read/write, transport abstraction)
     // ================================================================
+    // Buffered transport entry points the host resolves once at OpenPort().
+    // `ctx` is host state for that one port; sizes were validated at Connect(),
+    // so `bytes` is always the port's payload size.
+    struct TransportOps {
+            bool (*read)(void *ctx, void *dst, std::size_t bytes)        = nullptr;
+            bool (*write)(void *ctx, const void *src, std::size_t bytes) = nullptr;
+            bool (*readHeader)(void *ctx, MessageHeader &out)            = nullptr;
+    };
+
+    // What a Buffered handle's impl points to when the host has fast paths
+    // (IHostServices::FastPaths()): host memory, valid as long as the port.
+    struct PortFastPath {
+            const TransportOps  *ops     = nullptr;
+            void                *ctx     = nullptr; // first argument for ops
+            const std::uint64_t *version = nullptr; // MessageHeader::sequence of what an input reads
+    };
+
     struct PortHandle {
             void *impl = nullptr; // host-defined transport pointer
     };
@@ -121,27 +330,118 @@ namespace PluginAPI {
             // For buffered ports, raw byte I/O
             virtual bool Read(PortHandle h, void *dst, size_t bytes, size_t &outBytes)        = 0;
             virtual bool Write(PortHandle h, const void *src, size_t bytes, size_t &outBytes) = 0;
+
+            // For buffered ports: header of the data Read() would return
+            virtual bool ReadHeader(PortHandle /*h*/, MessageHeader & /*out*/) {
+                return false;
+            }
+
+            // Allocator for the calling addon's own data (std::pmr containers
+            // or allocate()/deallocate()). Ask for it in initialize(); it stays
+            // valid until the addon is destroyed. Hosts that account memory per
+            // addon return a resource of its own, others the default resource.
+            virtual std::pmr::memory_resource *Memory() {
+                return std::pmr::get_default_resource();
+            }
+
+            // Offline batch mode (IPlugin::runBatch): every frame queued on a
+            // Buffered input since the batch began, oldest first; several
+            // output frames in one call. Outside batch mode an input holds
+            // one frame and each output frame overwrites the last.
+            virtual std::size_t ReadBatch(PortHandle h, void *dst, size_t frameBytes, size_t maxFrames) {
+                size_t got = 0;
+                return maxFrames && Read(h, dst, frameBytes, got) && got == frameBytes ? 1 : 0;
+            }
+            virtual std::size_t WriteBatch(PortHandle h, const void *src, size_t frameBytes, size_t frames) {
+                const auto *bytes = static_cast<const std::uint8_t *>(src);
+                size_t      n     = 0;
+                for (size_t wrote = 0; n < frames && Write(h, bytes + n * frameBytes, frameBytes, wrote); ++n) {}
+                return n;
+            }
+
+            // Host time in ns. Real time: the steady clock (SteadyNowNs()).
+            // Simulation: a virtual clock the host jumps straight to the next
+            // due cycle, so addons that take their time from here behave the
+            // same as in real time, only faster. Message header timestamps
+            // stay on the steady clock either way.
+            virtual std::uint64_t Now() {
+                return SteadyNowNs();
+            }
+
+            // Logging, normally through PLUGIN_LOG. A call site registers
+            // once and gets an id (0 = this host does not log, the caller
+            // prints synchronously). LogRecord() only copies the arguments
+            // into a per-thread ring; a host thread formats and writes them.
+            // It never blocks: a full ring, or more than `maxPerSecond`
+            // records of one site (0 = no limit), drops the record and
+            // counts it.
+            virtual std::uint32_t RegisterLogSite(LogLevel /*level*/, const char * /*format*/,
+                std::uint32_t /*maxPerSecond*/) {
+                return 0;
+            }
+            virtual void LogRecord(std::uint32_t /*site*/, const LogArg * /*args*/, std::size_t /*count*/) {}
+
+            // Whether OpenPort() hands out Buffered handles whose impl points
+            // to a PortFastPath; otherwise impl is opaque to the addon
+            virtual bool FastPaths() {
+                return false;
+            }
+    };
+
+    // The fast path behind a Buffered handle, null when the host has none
+    inline const PortFastPath *FastPathOf(IHostServices *svc, PortHandle h) {
+        return svc && h.impl && svc->FastPaths() ? static_cast<const PortFastPath *>(h.impl) : nullptr;
+    }
+
+    // Static per call site (PLUGIN_LOG declares one)
+    struct LogSite {
+            LogLevel                   level;
+            const char                *format;
+            std::uint32_t              maxPerSecond = 0;
+            std::atomic<std::uint32_t> id{0};
     };
 
+    template<class... Args>
+    void Log(IHostServices *svc, LogSite &site, const Args &...args) {
+        static_assert(sizeof...(Args) <= kMaxLogArgs, "too many log arguments");
+        const LogArg  argv[sizeof...(Args) + 1] = {LogArg(args)...};
+        std::uint32_t id                        = site.id.load(std::memory_order_acquire);
+        if (!id && svc) {
+            id = svc->RegisterLogSite(site.level, site.format, site.maxPerSecond);
+            site.id.store(id, std::memory_order_release);
+        }
+        if (id && svc) {
+            svc->LogRecord(id, argv, sizeof...(Args));
+            return;
+        }
+        std::string line; // no host logger (or no svc here): format and print right here
+        FormatLog(line, site.format, argv, sizeof...(Args));
+        line += '\n';
+        std::fwrite(line.data(), 1, line.size(), site.level >= LogLevel::Warn ? stderr : stdout);
+    }
+
     // ================================================================
     // DataProxy<T> - sugar for typed access
     // ================================================================
     template<class T>
     class DataProxy {
         public:
-            DataProxy(T       *directPtr,
-                IHostServices *svc,
-                PortHandle     h,
-                bool           isOutput,
-                bool           isDirect)
-                : ptr_(directPtr), svc_(svc), handle_(h), isOutput_(isOutput), isDirect_(isDirect) {}
+            DataProxy(T            *directPtr,
+                IHostServices      *svc,
+                PortHandle          h,
+                const PortFastPath *fast,
+                bool                isOutput,
+                bool                isDirect)
+                : ptr_(directPtr), svc_(svc), handle_(h), fast_(fast), isOutput_(isOutput), isDirect_(isDirect) {}
 
             // Read as value
             operator T() const {
                 if (isDirect_ && ptr_)
                     return *ptr_;
 
-                T      tmp{};
+                std::remove_const_t<T> tmp{};
+                if (fast_)
+                    return fast_->ops->read(fast_->ctx, &tmp, sizeof(T)) ? tmp : std::remove_const_t<T>{};
                 size_t got = 0;
                 if (svc_ && svc_->Read(handle_, &tmp, sizeof(T), got) &&
                     got == sizeof(T))
@@ -157,9 +457,14 @@ namespace PluginAPI {
 
                 if (isDirect_ && ptr_) {
                     *ptr_ = v;
+                    StampDirectWrite(ptr_);
                     return *this;
                 }
 
+                if (fast_) {
+                    fast_->ops->write(fast_->ctx, &v, sizeof(T));
+                    return *this;
+                }
                 size_t wrote = 0;
                 if (svc_)
                     svc_->Write(handle_, &v, sizeof(T), wrote);
@@ -175,11 +480,12 @@ namespace PluginAPI {
             }
 
         private:
-            T             *ptr_ = nullptr;
-            IHostServices *svc_ = nullptr;
-            PortHandle     handle_{};
-            bool           isOutput_ = false;
-            bool           isDirect_ = false;
+            T                  *ptr_ = nullptr;
+            IHostServices      *svc_ = nullptr;
+            PortHandle          handle_{};
+            const PortFastPath *fast_     = nullptr;
+            bool                isOutput_ = false;
+            bool                isDirect_ = false;
     };
 
     // ================================================================
@@ -200,9 +506,21 @@ namespace PluginAPI {
             static constexpr auto type         = Type;
             static constexpr auto accessPolicy = AccessPolicy;
 
+            // Direct blocks are kDirectHeaderBytes-aligned (see PortManager::Connect)
+            static_assert(AccessPolicy != DataAccessPolicy::Direct || alignof(PayloadT) <= kDirectHeaderBytes,
+                "Direct payloads must not need more than kDirectHeaderBytes alignment");
+
             AddOnPort() = default;
 
             // -------- Descriptor for discovery --------
+            static constexpr StaticPortDescriptor descriptor{
+                name.c_str(),
+                direction,
+                type,
+                accessPolicy,
+                sizeof(T),
+                TypeHashOf<T>()};
+
             operator PortDescriptor() const {
                 return PortDescriptor{
                     name.c_str(),
@@ -223,9 +541,10 @@ namespace PluginAPI {
                 }
                 //handle_ = svc ? svc->OpenPort(name.c_str()) : PortHandle{};
 
-                if (accessPolicy == DataAccessPolicy::Direct &&
-                    handle_.impl != nullptr) {
+                if constexpr (accessPolicy == DataAccessPolicy::Direct) {
                     directPtr_ = static_cast<T *>(handle_.impl);
+                } else {
+                    fast_ = FastPathOf(svc, handle_);
                 }
             }
 
@@ -235,6 +554,7 @@ namespace PluginAPI {
                     directPtr_,
                     svc_,
                     handle_,
+                    fast_,
                     Direction == PortDirection::Output,
                     AccessPolicy == DataAccessPolicy::Direct);
             }
@@ -244,53 +564,327 @@ namespace PluginAPI {
                     directPtr_,
                     svc_,
                     handle_,
+                    fast_,
                     false,
                     AccessPolicy == DataAccessPolicy::Direct);
             }
 
-            // Explicit read/write
+            // Explicit read/write, specialized per policy at compile time:
+            // Direct is a plain load/store, Buffered calls the resolved
+            // transport ops (virtual IHostServices only for hosts without ops).
             bool read(T &out) const {
-                if (accessPolicy == DataAccessPolicy::Direct && directPtr_) {
+                if constexpr (accessPolicy == DataAccessPolicy::Direct) {
+                    if (!directPtr_)
+                        return false;
                     out = *directPtr_;
                     return true;
+                } else {
+                    if (fast_)
+                        return fast_->ops->read(fast_->ctx, &out, sizeof(T));
+                    size_t got = 0;
+                    return svc_ &&
+                           svc_->Read(handle_, &out, sizeof(T), got) &&
+                           got == sizeof(T);
                 }
-                size_t got = 0;
-                return svc_ &&
-                       svc_->Read(handle_, &out, sizeof(T), got) &&
-                       got == sizeof(T);
+            }
+
+            // Read plus header: age, end-to-end age and skipped sequence numbers
+            bool read(T &out, MessageInfo &info) const {
+                if (!read(out))
+                    return false;
+                messageInfo(info);
+                return true;
+            }
+
+            // Header of the current value, without copying it (zeroed if the
+            // host keeps no header); counts as a read for `skipped`.
+            void messageInfo(MessageInfo &info) const {
+                MessageHeader h{};
+                if constexpr (accessPolicy == DataAccessPolicy::Direct) {
+                    if (!directPtr_) {
+                        info = MessageInfo{};
+                        return;
+                    }
+                    const MessageHeader *dh = DirectHeaderOf(directPtr_);
+                    h                       = *dh;
+                    h.sequence              = LoadSequence(*dh);
+                } else {
+                    const bool ok = fast_ ? fast_->ops->readHeader(fast_->ctx, h)
+                                          : (svc_ && svc_->ReadHeader(handle_, h));
+                    if (!ok) {
+                        info = MessageInfo{};
+                        return;
+                    }
+                }
+
+                const std::uint64_t now = SteadyNowNs();
+                info.sequence           = h.sequence;
+                info.ageNs              = now - h.writeNs;
+                info.originAgeNs        = now - h.originNs;
+                info.originPort         = h.originPort;
+                info.skipped            = (lastSeq_ && h.sequence > lastSeq_ + 1) ? h.sequence - lastSeq_ - 1 : 0;
+                lastSeq_                = h.sequence;
+            }
+
+            // -------- Versioned reads --------
+            // Sequence number of the value read() would return (0 = never
+            // written): one atomic load of the transport's header.
+            std::uint64_t version() const {
+                if constexpr (accessPolicy == DataAccessPolicy::Direct) {
+                    return directPtr_ ? LoadSequence(*DirectHeaderOf(directPtr_)) : 0;
+                } else {
+                    if (fast_ && fast_->version)
+                        return LoadSequence(fast_->version);
+                    MessageHeader h{};
+                    if (fast_ ? fast_->ops->readHeader(fast_->ctx, h)
+                              : (svc_ && svc_->ReadHeader(handle_, h)))
+                        return h.sequence;
+                    return 0;
+                }
+            }
+
+            // A value newer than the last readIfNew() / read(out, info) arrived
+            bool changed() const {
+                return version() > lastSeq_;
+            }
+
+            // read() only if changed(); otherwise nothing is copied
+            bool readIfNew(T &out) const {
+                const std::uint64_t v = version();
+                if (v <= lastSeq_ || !read(out))
+                    return false;
+                lastSeq_ = v;
+                return true;
+            }
+
+            // Offline batch mode, inside IPlugin::runBatch(): up to `max`
+            // queued input frames, oldest first, and `n` output frames in one
+            // call. Direct ports only ever hold the latest frame.
+            std::size_t readBatch(T *out, std::size_t max) const {
+                if constexpr (accessPolicy == DataAccessPolicy::Direct) {
+                    return max && read(out[0]) ? 1 : 0;
+                } else {
+                    return svc_ ? svc_->ReadBatch(handle_, out, sizeof(T), max) : 0;
+                }
+            }
+            std::size_t writeBatch(const T *in, std::size_t n) {
+                if constexpr (accessPolicy == DataAccessPolicy::Direct) {
+                    return n && write(in[n - 1]) ? n : 0;
+                } else {
+                    return svc_ ? svc_->WriteBatch(handle_, in, sizeof(T), n) : 0;
+                }
+            }
+
+            // Direct transport (shared block), null when unbound/unconnected
+            T *direct() const {
+                return directPtr_;
             }
 
             bool write(const T &v) {
-                if (accessPolicy == DataAccessPolicy::Direct && directPtr_) {
+                if constexpr (accessPolicy == DataAccessPolicy::Direct) {
+                    if (!directPtr_)
+                        return false;
                     *directPtr_ = v;
+                    StampDirectWrite(directPtr_);
                     return true;
+                } else {
+                    if (fast_)
+                        return fast_->ops->write(fast_->ctx, &v, sizeof(T));
+                    size_t wrote = 0;
+                    return svc_ &&
+                           svc_->Write(handle_, &v, sizeof(T), wrote) &&
+                           wrote == sizeof(T);
                 }
-                size_t wrote = 0;
-                return svc_ &&
-                       svc_->Write(handle_, &v, sizeof(T), wrote) &&
-                       wrote == sizeof(T);
             }
 
         private:
-            IHostServices *svc_ = nullptr;
-            PortHandle     handle_{};
-            T             *directPtr_ = nullptr;
+            IHostServices        *svc_ = nullptr;
+            PortHandle            handle_{};
+            const PortFastPath   *fast_      = nullptr; // Buffered: resolved at Bind()
+            T                    *directPtr_ = nullptr;
+            mutable std::uint64_t lastSeq_   = 0; // last sequence seen by read(out, info) / readIfNew()
+    };
+
+    // ================================================================
+    // PortSet<Ports...> - compile-time port table
+    // ================================================================
+    // Owns one instance of every port, exposes their descriptors as a
+    // constexpr array and binds them all at once:
+    //
+    //   using Ports = PortSet<InPortT, OutPortT>;
+    //   PortTable getPortTable() const override { return Ports::table(); }
+    //   void initialize(IHostServices *svc) override { ports_.Bind(svc); }
+    //   ... ports_.get<InPortT>().read(v);
+    constexpr bool UniquePortNames(const StaticPortDescriptor *d, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            for (std::size_t j = i + 1; j < n; ++j) {
+                const char *a = d[i].Name;
+                const char *b = d[j].Name;
+                while (*a && *a == *b) {
+                    ++a;
+                    ++b;
+                }
+                if (*a == *b)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    template<class... Ports>
+    class PortSet {
+        public:
+            static constexpr std::array<StaticPortDescriptor, sizeof...(Ports)> descriptors{Ports::descriptor...};
+
+            static constexpr PortTable table() {
+                return PortTable{descriptors.data(), descriptors.size()};
+            }
+
+            void Bind(IHostServices *svc) {
+                std::apply([svc](auto &...p) { (p.Bind(svc), ...); }, ports_);
+            }
+
+            template<class Port>
+            Port &get() {
+                return std::get<Port>(ports_);
+            }
+            template<class Port>
+            const Port &get() const {
+                return std::get<Port>(ports_);
+            }
+
+        private:
+            static_assert(UniquePortNames(descriptors.data(), descriptors.size()),
+                "PortSet: duplicate port name");
+
+            std::tuple<Ports...> ports_;
+    };
+
+    // ================================================================
+    // Joins - host-side alignment of several inputs
+    // ================================================================
+    // An addon that returns a non-empty JoinSpec is not run() by the host.
+    // Instead the host checks the listed inputs every cycle and calls
+    // runJoined() once they match the policy, with one view per input in
+    // spec order. Views point at the transports themselves (the Direct
+    // block or the host's Buffered slot) and are valid during the call.
+    struct JoinSpec {
+            const char *const *ports       = nullptr; // input port names
+            std::size_t        count       = 0;       // 0 = no join, plain run()
+            JoinPolicy         policy      = JoinPolicy::LatestOfEach;
+            std::uint64_t      toleranceNs = 0;       // ApproximateTime only
+    };
+
+    struct JoinView {
+            const void   *data  = nullptr;
+            std::size_t   bytes = 0;
+            MessageHeader header;
+
+            template<class T>
+            const T &as() const {
+                return *static_cast<const T *>(data);
+            }
+    };
+
+    // Typed JoinSpec over AddOnPort inputs:
+    //
+    //   using Fused = JoinSet<InPoseT, InScanT>;
+    //   JoinSpec getJoinSpec() const override { return Fused::spec(JoinPolicy::ApproximateTime, 2'000'000); }
+    //   void runJoined(const JoinView *v, std::size_t) override { use(Fused::get<0>(v), Fused::get<1>(v)); }
+    template<class... Ports>
+    struct JoinSet {
+            static_assert(sizeof...(Ports) > 0, "JoinSet needs at least one port");
+            static_assert(((Ports::direction == PortDirection::Input) && ...), "JoinSet ports must be inputs");
+
+            static constexpr std::array<const char *, sizeof...(Ports)> names{Ports::name.c_str()...};
+
+            static constexpr JoinSpec spec(JoinPolicy policy, std::uint64_t toleranceNs = 0) {
+                return JoinSpec{names.data(), names.size(), policy, toleranceNs};
+            }
+
+            template<std::size_t I>
+            static const typename std::tuple_element_t<I, std::tuple<Ports...>>::T &get(const JoinView *views) {
+                return views[I].template as<typename std::tuple_element_t<I, std::tuple<Ports...>>::T>();
+            }
+    };
+
+    // ================================================================
+    // Execution hints - what the host's graph optimizer may assume
+    // ================================================================
+    enum struct ThreadingModel : std::uint8_t {
+        CycleThread = 0, // ports used only from initialize()/run()/shutdown()
+        AnyThread   = 1  // ports also used from threads the addon starts
+    };
+
+    struct ExecutionHints {
+            ThreadingModel threading = ThreadingModel::CycleThread;
+            bool           light     = false; // run() is cheap: may share a scheduling unit with its neighbours
     };
 
     // ================================================================
     // IPlugin
     // ================================================================
+    // Plugins are loaded without a version check, so the vtable layouts
+    // (here and in IHostServices) and PortHandle are the ABI: new virtuals
+    // are appended, never inserted, and PortHandle stays one pointer.
     class IPlugin {
         public:
             virtual ~IPlugin() = default;
 
-            virtual std::vector<PortDescriptor> getPortDescriptors() const = 0;
+            // Heap-allocated descriptors; defaults to a copy of getPortTable()
+            virtual std::vector<PortDescriptor> getPortDescriptors() const {
+                const PortTable t = getPortTable();
+                return std::vector<PortDescriptor>(t.begin(), t.end());
+            }
 
             // Called once host created transports + connections
             virtual void initialize(IHostServices *services) = 0;
 
             virtual void run()      = 0;
             virtual void shutdown() = 0;
+
+            // Optional warm-restart state, opaque to the host.
+            // saveState returns the bytes needed and writes only if they fit
+            // in `capacity` (call with nullptr/0 to query the size).
+            virtual std::size_t saveState(void * /*dst*/, std::size_t /*capacity*/) const {
+                return 0;
+            }
+            virtual bool restoreState(const void * /*src*/, std::size_t /*bytes*/) {
+                return false;
+            }
+
+            // Static descriptor table (PortSet::table()); hosts prefer it and
+            // fall back to getPortDescriptors() when it is empty.
+            virtual PortTable getPortTable() const {
+                return {};
+            }
+
+            // Host-side join (see JoinSpec); replaces run() when count > 0
+            virtual JoinSpec getJoinSpec() const {
+                return {};
+            }
+            virtual void runJoined(const JoinView * /*views*/, std::size_t /*count*/) {}
+
+            // Threading and cost hints for the host's graph optimizer
+            virtual ExecutionHints getExecutionHints() const {
+                return {};
+            }
+
+            // Offline batch mode (PortReplayer with a batch size): handle
+            // `frames` cycles of input in one call, through readBatch() and
+            // writeBatch(). Return false if not supported; the host then
+            // calls run() once per frame instead.
+            virtual bool runBatch(std::size_t /*frames*/) {
+                return false;
+            }
     };
 
 } // namespace PluginAPI
+
+// PLUGIN_LOG(svc, PluginAPI::LogLevel::Info, 0, "[MyAddon] value={}", v);
+// `maxPerSecond` limits this call site (0 = unlimited); "{}" placeholders.
+#define PLUGIN_LOG(svc, level, maxPerSecond, format, ...)                         \
+    do {                                                                         \
+        static ::PluginAPI::LogSite pluginLogSite_{level, format, maxPerSecond}; \
+        ::PluginAPI::Log(svc, pluginLogSite_ __VA_OPT__(, ) __VA_ARGS__);         \
+    } while (0)
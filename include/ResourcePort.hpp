@@ -0,0 +1,103 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#include "PluginAPI.hpp"
+
+namespace PluginAPI {
+
+    // ================================================================
+    // Resource files - read-only payloads the host maps from disk
+    // ================================================================
+    // A resource file is one kResourceHeaderBytes header followed by the
+    // payload. The header names the payload type (TypeHashOf<T>()) and its
+    // size, so the host can check the file against the port before any
+    // addon sees it. The payload starts 64 bytes into a page-aligned
+    // mapping, so it is cache-line aligned.
+    inline constexpr std::size_t kResourceHeaderBytes = 64;
+    inline constexpr char        kResourceMagic[8]    = {'P', 'L', 'G', 'R', 'E', 'S', '0', '1'};
+
+    struct ResourceFileHeader {
+            char          magic[8]{};
+            std::uint64_t typeHash    = 0;
+            std::uint64_t payloadSize = 0;
+            std::uint64_t reserved[5]{};
+    };
+    static_assert(sizeof(ResourceFileHeader) == kResourceHeaderBytes);
+
+    // Writes `bytes` of payload under a header for `typeHash`; the dataset
+    // tools' side of a resource port
+    inline bool WriteResourceFile(const char *path, std::uint64_t typeHash, const void *payload, std::size_t bytes) {
+        ResourceFileHeader h;
+        std::memcpy(h.magic, kResourceMagic, sizeof(h.magic));
+        h.typeHash    = typeHash;
+        h.payloadSize = bytes;
+
+        std::FILE *f = std::fopen(path, "wb");
+        if (!f)
+            return false;
+        const bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1 &&
+                        (bytes == 0 || std::fwrite(payload, bytes, 1, f) == 1);
+        return std::fclose(f) == 0 && ok;
+    }
+
+    template<class T>
+    bool WriteResourceFile(const char *path, const T &value) {
+        static_assert(std::is_trivially_copyable_v<T>, "resource payloads are mapped as raw bytes");
+        return WriteResourceFile(path, TypeHashOf<T>(), &value, sizeof(T));
+    }
+
+    // ================================================================
+    // AddOnResourcePort<T, Name> - zero-copy const view of a resource file
+    // ================================================================
+    // An input the host binds to a file (PortManager::BindResource()) rather
+    // than to another addon. The host maps each file once, read-only, and
+    // hands every addon bound to it a pointer into the same mapping, so the
+    // data exists once in the page cache however many addons, runners or
+    // host processes use it. The pointer stays valid until the host shuts
+    // down. TypeHash and PayloadSize are checked against the file header.
+    //
+    //   using MapIn = AddOnResourcePort<RoadMap, "RoadMap">;
+    //   if (const RoadMap *m = ports_.get<MapIn>().get()) route(*m);
+    template<class T, fixed_string Name>
+    class AddOnResourcePort {
+        public:
+            static_assert(std::is_trivially_copyable_v<T>, "resource payloads are mapped as raw bytes");
+            static_assert(alignof(T) <= kResourceHeaderBytes, "resource payloads are only 64-byte aligned");
+
+            static constexpr auto                 name         = Name;
+            static constexpr auto                 direction    = PortDirection::Input;
+            static constexpr auto                 type         = PortType::MappedFile;
+            static constexpr auto                 accessPolicy = DataAccessPolicy::Direct;
+            static constexpr StaticPortDescriptor descriptor{
+                name.c_str(), direction, type, accessPolicy, sizeof(T), TypeHashOf<T>()};
+
+            operator PortDescriptor() const {
+                return descriptor;
+            }
+
+            void Bind(IHostServices *svc) {
+                data_ = svc ? static_cast<const T *>(svc->OpenPort(name.c_str()).impl) : nullptr;
+            }
+
+            // The mapped payload, null if the host bound no file to the port
+            const T *get() const {
+                return data_;
+            }
+            const T *operator->() const {
+                return data_;
+            }
+            const T &operator*() const {
+                return *data_;
+            }
+            explicit operator bool() const {
+                return data_ != nullptr;
+            }
+
+        private:
+            const T *data_ = nullptr;
+    };
+
+} // namespace PluginAPI
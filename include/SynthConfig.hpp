@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include "PluginAPI.hpp"
+
+// Configuration of one synthetic load-generator addon (SynthAddon library).
+// The host creates instances through the exported factory
+//   extern "C" PluginAPI::IPlugin *CreateSynthPlugin(const void *config)
+// (config points to a SynthConfig; see AddOnManager::loadInstance)
+// and wires them into large graphs (see HostApp/LoadGenerator).
+struct SynthConfig {
+        enum class Role : std::uint8_t {
+            Producer = 0, // outputs only
+            Filter   = 1, // inputs -> outputs
+            Sink     = 2  // inputs only
+        };
+
+        Role                        role            = Role::Producer;
+        PluginAPI::DataAccessPolicy policy          = PluginAPI::DataAccessPolicy::Buffered;
+        std::uint32_t               inputs          = 0;  // ports "in0".."inN-1" (fan-in)
+        std::uint32_t               outputs         = 1;  // ports "out0".."outN-1"
+        std::uint32_t               payloadBytes    = 64; // per port
+        std::uint32_t               emitEvery       = 1;  // write outputs every Nth run()
+        std::uint32_t               workIterations  = 0;  // CPU cost per run()
+        bool                        join            = false; // inputs aligned by the host (runJoined)
+        PluginAPI::JoinPolicy       joinPolicy      = PluginAPI::JoinPolicy::LatestOfEach;
+        std::uint64_t               joinToleranceNs = 0;
+        std::uint32_t               abortAtTick     = 0; // fault injection: abort() on this run() (0 = never)
+};
+
+// Payload identity shared by all synthetic ports: same size => compatible
+inline std::uint64_t SynthPayloadHash(std::uint32_t payloadBytes) {
+    struct SynthPayloadTag {};
+    return PluginAPI::TypeHashOf<SynthPayloadTag>() ^ payloadBytes;
+}
+
+inline constexpr const char *kSynthFactorySymbol = "CreateSynthPlugin";